@@ -421,6 +421,20 @@ struct d3d11_state
     BOOL predicate_value;
 };
 
+/* Deferred calls are carved out of large chunks instead of being allocated
+ * one by one; the chunks are handed over to the command list as a whole. */
+#define DEFERRED_CHUNK_SIZE 0x10000
+
+struct deferred_chunk
+{
+    struct list entry;
+    SIZE_T size;
+    SIZE_T used;
+};
+
+/* Keep the calls inside a chunk 16 byte aligned. */
+#define DEFERRED_CHUNK_HEADER_SIZE ((sizeof(struct deferred_chunk) + 0xf) & ~(SIZE_T)0xf)
+
 /* ID3D11CommandList - command list */
 struct d3d11_command_list
 {
@@ -429,6 +443,7 @@ struct d3d11_command_list
     LONG refcount;
 
     struct list commands;
+    struct list chunks;
 
     struct wined3d_private_store private_store;
 };
@@ -441,22 +456,66 @@ struct d3d11_deferred_context
     LONG refcount;
 
     struct list commands;
+    struct list chunks;
+
+    /* Most recently recorded call of each state setting command, used to
+     * drop calls which wouldn't change the state. Reset by ClearState and
+     * FinishCommandList. */
+    struct deferred_call *state_calls[DEFERRED_END + 1];
 
     struct wined3d_private_store private_store;
 };
 
 static struct deferred_call *add_deferred_call(struct d3d11_deferred_context *context, size_t extra_size)
 {
+    SIZE_T size = (sizeof(struct deferred_call) + extra_size + 0xf) & ~(SIZE_T)0xf;
+    struct deferred_chunk *chunk = NULL;
     struct deferred_call *call;
 
-    if (!(call = HeapAlloc(GetProcessHeap(), 0, sizeof(*call) + extra_size)))
-        return NULL;
+    if (!list_empty(&context->chunks))
+        chunk = LIST_ENTRY(list_tail(&context->chunks), struct deferred_chunk, entry);
+
+    if (!chunk || chunk->size - chunk->used < size)
+    {
+        SIZE_T chunk_size = max(size, DEFERRED_CHUNK_SIZE);
+
+        if (!(chunk = HeapAlloc(GetProcessHeap(), 0, DEFERRED_CHUNK_HEADER_SIZE + chunk_size)))
+            return NULL;
+        chunk->size = chunk_size;
+        chunk->used = 0;
+
+        /* Oversized calls get a chunk of their own; keep the current chunk
+         * at the tail so that following calls can still use it. */
+        if (size > DEFERRED_CHUNK_SIZE)
+            list_add_head(&context->chunks, &chunk->entry);
+        else
+            list_add_tail(&context->chunks, &chunk->entry);
+    }
+
+    call = (struct deferred_call *)((BYTE *)chunk + DEFERRED_CHUNK_HEADER_SIZE + chunk->used);
+    chunk->used += size;
 
     call->cmd = 0xdeadbeef;
     list_add_tail(&context->commands, &call->entry);
     return call;
 }
 
+static struct deferred_call *get_deferred_state_call(struct d3d11_deferred_context *context,
+        enum deferred_cmd cmd)
+{
+    return context->state_calls[cmd];
+}
+
+static void set_deferred_state_call(struct d3d11_deferred_context *context, struct deferred_call *call)
+{
+    context->state_calls[call->cmd] = call;
+}
+
+static void reset_deferred_state_calls(struct d3d11_deferred_context *context)
+{
+    memset(context->state_calls, 0, sizeof(context->state_calls));
+}
+
 /* for DEFERRED_CSSETSHADERRESOURCES, DEFERRED_DSSETSHADERRESOURCES, DEFERRED_GSSETSHADERRESOURCES,
  * DEFERRED_HSSETSHADERRESOURCES, DEFERRED_PSSETSHADERRESOURCES and DEFERRED_VSSETSHADERRESOURCES */
 static void add_deferred_set_shader_resources(struct d3d11_deferred_context *context, enum deferred_cmd cmd,
@@ -487,6 +546,12 @@ static void add_deferred_set_samplers(struct d3d11_deferred_context *context, en
     struct deferred_call *call;
     int i;
 
+    if ((call = get_deferred_state_call(context, cmd))
+            && call->samplers_info.start_slot == start_slot
+            && call->samplers_info.num_samplers == sampler_count
+            && !memcmp(call->samplers_info.samplers, samplers, sizeof(*samplers) * sampler_count))
+        return;
+
     if (!(call = add_deferred_call(context, sizeof(*samplers) * sampler_count)))
         return;
 
@@ -499,6 +564,7 @@ static void add_deferred_set_samplers(struct d3d11_deferred_context *context, en
         if (samplers[i]) ID3D11SamplerState_AddRef(samplers[i]);
         call->samplers_info.samplers[i] = samplers[i];
     }
+    set_deferred_state_call(context, call);
 }
 
 /* for DEFERRED_CSSETCONSTANTBUFFERS. DEFERRED_DSSETCONSTANTBUFFERS, DEFERRED_GSSETCONSTANTBUFFERS,
@@ -523,12 +589,13 @@ static void add_deferred_set_constant_buffers(struct d3d11_deferred_context *con
     }
 }
 
-static void free_deferred_calls(struct list *commands)
+static void free_deferred_calls(struct list *commands, struct list *chunks)
 {
-    struct deferred_call *call, *call2;
+    struct deferred_chunk *chunk, *chunk2;
+    struct deferred_call *call;
     int i;
 
-    LIST_FOR_EACH_ENTRY_SAFE(call, call2, commands, struct deferred_call, entry)
+    LIST_FOR_EACH_ENTRY(call, commands, struct deferred_call, entry)
     {
         switch (call->cmd)
         {
@@ -840,12 +907,20 @@ static void free_deferred_calls(struct list *commands)
             }
         }
 
-        list_remove(&call->entry);
-        HeapFree(GetProcessHeap(), 0, call);
     }
+    list_init(commands);
+
+    LIST_FOR_EACH_ENTRY_SAFE(chunk, chunk2, chunks, struct deferred_chunk, entry)
+    {
+        HeapFree(GetProcessHeap(), 0, chunk);
+    }
+    list_init(chunks);
 }
 
-static void exec_deferred_calls(ID3D11DeviceContext1 *iface, struct list *commands)
+/* Draws and the most frequently changed state are translated straight into
+ * wined3d calls; the wined3d mutex is held by the caller. */
+static void exec_deferred_calls(ID3D11DeviceContext1 *iface, struct wined3d_device *wined3d_device,
+        struct list *commands)
 {
     struct deferred_call *call;
 
@@ -862,7 +937,12 @@ static void exec_deferred_calls(ID3D11DeviceContext1 *iface, struct list *comman
             }
             case DEFERRED_IASETPRIMITIVETOPOLOGY:
             {
-                ID3D11DeviceContext1_IASetPrimitiveTopology(iface, call->topology_info.topology);
+                enum wined3d_primitive_type primitive_type;
+                unsigned int patch_vertex_count;
+
+                wined3d_primitive_type_from_d3d11_primitive_topology(call->topology_info.topology,
+                        &primitive_type, &patch_vertex_count);
+                wined3d_device_set_primitive_type(wined3d_device, primitive_type, patch_vertex_count);
                 break;
             }
             case DEFERRED_IASETINDEXBUFFER:
@@ -992,7 +1072,9 @@ static void exec_deferred_calls(ID3D11DeviceContext1 *iface, struct list *comman
             }
             case DEFERRED_GSSETSHADER:
             {
-                ID3D11DeviceContext1_GSSetShader(iface, call->gs_info.shader, NULL, 0);
+                struct d3d_geometry_shader *gs = unsafe_impl_from_ID3D11GeometryShader(call->gs_info.shader);
+
+                wined3d_device_set_geometry_shader(wined3d_device, gs ? gs->wined3d_shader : NULL);
                 break;
             }
             case DEFERRED_HSSETSHADER:
@@ -1002,12 +1084,16 @@ static void exec_deferred_calls(ID3D11DeviceContext1 *iface, struct list *comman
             }
             case DEFERRED_PSSETSHADER:
             {
-                ID3D11DeviceContext1_PSSetShader(iface, call->ps_info.shader, NULL, 0);
+                struct d3d_pixel_shader *ps = unsafe_impl_from_ID3D11PixelShader(call->ps_info.shader);
+
+                wined3d_device_set_pixel_shader(wined3d_device, ps ? ps->wined3d_shader : NULL);
                 break;
             }
             case DEFERRED_VSSETSHADER:
             {
-                ID3D11DeviceContext1_VSSetShader(iface, call->vs_info.shader, NULL, 0);
+                struct d3d_vertex_shader *vs = unsafe_impl_from_ID3D11VertexShader(call->vs_info.shader);
+
+                wined3d_device_set_vertex_shader(wined3d_device, vs ? vs->wined3d_shader : NULL);
                 break;
             }
             case DEFERRED_CSSETSHADERRESOURCES:
@@ -1140,20 +1226,22 @@ static void exec_deferred_calls(ID3D11DeviceContext1 *iface, struct list *comman
             }
             case DEFERRED_DRAW:
             {
-                ID3D11DeviceContext1_Draw(iface, call->draw_info.count, call->draw_info.start);
+                wined3d_device_draw_primitive(wined3d_device, call->draw_info.start, call->draw_info.count);
                 break;
             }
             case DEFERRED_DRAWINDEXED:
             {
-                ID3D11DeviceContext1_DrawIndexed(iface, call->draw_indexed_info.count,
-                        call->draw_indexed_info.start_index, call->draw_indexed_info.base_vertex);
+                wined3d_device_set_base_vertex_index(wined3d_device, call->draw_indexed_info.base_vertex);
+                wined3d_device_draw_indexed_primitive(wined3d_device, call->draw_indexed_info.start_index,
+                        call->draw_indexed_info.count);
                 break;
             }
             case DEFERRED_DRAWINDEXEDINSTANCED:
             {
-                ID3D11DeviceContext1_DrawIndexedInstanced(iface, call->draw_indexed_inst_info.count_per_instance,
-                        call->draw_indexed_inst_info.instance_count, call->draw_indexed_inst_info.start_index,
-                        call->draw_indexed_inst_info.base_vertex, call->draw_indexed_inst_info.start_instance);
+                wined3d_device_set_base_vertex_index(wined3d_device, call->draw_indexed_inst_info.base_vertex);
+                wined3d_device_draw_indexed_primitive_instanced(wined3d_device,
+                        call->draw_indexed_inst_info.start_index, call->draw_indexed_inst_info.count_per_instance,
+                        call->draw_indexed_inst_info.start_instance, call->draw_indexed_inst_info.instance_count);
                 break;
             }
             case DEFERRED_DRAWAUTO:
@@ -1163,11 +1251,11 @@ static void exec_deferred_calls(ID3D11DeviceContext1 *iface, struct list *comman
             }
             case DEFERRED_DRAWINSTANCED:
             {
-                ID3D11DeviceContext1_DrawInstanced(iface,
-                        call->draw_instanced_info.instance_vertex_count,
-                        call->draw_instanced_info.instance_count,
+                wined3d_device_draw_primitive_instanced(wined3d_device,
                         call->draw_instanced_info.start_vertex_location,
-                        call->draw_instanced_info.start_instance_location);
+                        call->draw_instanced_info.instance_vertex_count,
+                        call->draw_instanced_info.start_instance_location,
+                        call->draw_instanced_info.instance_count);
                 break;
             }
             case DEFERRED_DRAWINSTANCEDINDIRECT:
@@ -1317,7 +1405,7 @@ static ULONG STDMETHODCALLTYPE d3d11_command_list_Release(ID3D11CommandList *ifa
 
     if (!refcount)
     {
-        free_deferred_calls(&cmdlist->commands);
+        free_deferred_calls(&cmdlist->commands, &cmdlist->chunks);
         wined3d_private_store_cleanup(&cmdlist->private_store);
         ID3D11Device_Release(cmdlist->device);
         HeapFree(GetProcessHeap(), 0, cmdlist);
@@ -2702,6 +2790,7 @@ static void state_apply(ID3D11DeviceContext1 *context, struct d3d11_state *state
 static void STDMETHODCALLTYPE d3d11_immediate_context_ExecuteCommandList(ID3D11DeviceContext1 *iface,
         ID3D11CommandList *command_list, BOOL restore_state)
 {
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
     struct d3d11_command_list *cmdlist = unsafe_impl_from_ID3D11CommandList(command_list);
     struct d3d11_state *stateblock = NULL;
 
@@ -2712,7 +2801,7 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_ExecuteCommandList(ID3D11D
 
     wined3d_mutex_lock();
     if (restore_state) stateblock = state_capture(iface);
-    exec_deferred_calls(iface, &cmdlist->commands);
+    exec_deferred_calls(iface, device->wined3d_device, &cmdlist->commands);
     if (restore_state) state_apply(iface, stateblock);
     else ID3D11DeviceContext1_ClearState(iface);
     wined3d_mutex_unlock();
@@ -4434,7 +4523,7 @@ static ULONG STDMETHODCALLTYPE d3d11_deferred_context_Release(ID3D11DeviceContex
 
     if (!refcount)
     {
-        free_deferred_calls(&context->commands);
+        free_deferred_calls(&context->commands, &context->chunks);
         wined3d_private_store_cleanup(&context->private_store);
         ID3D11Device_Release(context->device);
         HeapFree(GetProcessHeap(), 0, context);
@@ -4514,12 +4603,16 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetShader(ID3D11DeviceCon
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
             iface, shader, class_instances, class_instance_count);
 
+    if ((call = get_deferred_state_call(context, DEFERRED_PSSETSHADER)) && call->ps_info.shader == shader)
+        return;
+
     if (!(call = add_deferred_call(context, 0)))
         return;
 
     call->cmd = DEFERRED_PSSETSHADER;
     if (shader) ID3D11PixelShader_AddRef(shader);
     call->ps_info.shader = shader;
+    set_deferred_state_call(context, call);
 }
 
 static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetSamplers(ID3D11DeviceContext1 *iface,
@@ -4542,12 +4635,16 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetShader(ID3D11DeviceCon
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
             iface, shader, class_instances, class_instance_count);
 
+    if ((call = get_deferred_state_call(context, DEFERRED_VSSETSHADER)) && call->vs_info.shader == shader)
+        return;
+
     if (!(call = add_deferred_call(context, 0)))
         return;
 
     call->cmd = DEFERRED_VSSETSHADER;
     if (shader) ID3D11VertexShader_AddRef(shader);
     call->vs_info.shader = shader;
+    set_deferred_state_call(context, call);
 }
 
 static void STDMETHODCALLTYPE d3d11_deferred_context_DrawIndexed(ID3D11DeviceContext1 *iface,
@@ -4676,12 +4773,17 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_IASetInputLayout(ID3D11Devi
 
     TRACE("iface %p, input_layout %p.\n", iface, input_layout);
 
+    if ((call = get_deferred_state_call(context, DEFERRED_IASETINPUTLAYOUT))
+            && call->input_layout_info.layout == input_layout)
+        return;
+
     if (!(call = add_deferred_call(context, 0)))
         return;
 
     call->cmd = DEFERRED_IASETINPUTLAYOUT;
     if (input_layout) ID3D11InputLayout_AddRef(input_layout);
     call->input_layout_info.layout = input_layout;
+    set_deferred_state_call(context, call);
 }
 
 static void STDMETHODCALLTYPE d3d11_deferred_context_IASetVertexBuffers(ID3D11DeviceContext1 *iface,
@@ -4796,12 +4898,16 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetShader(ID3D11DeviceCon
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
             iface, shader, class_instances, class_instance_count);
 
+    if ((call = get_deferred_state_call(context, DEFERRED_GSSETSHADER)) && call->gs_info.shader == shader)
+        return;
+
     if (!(call = add_deferred_call(context, 0)))
         return;
 
     call->cmd = DEFERRED_GSSETSHADER;
     if (shader) ID3D11GeometryShader_AddRef(shader);
     call->gs_info.shader = shader;
+    set_deferred_state_call(context, call);
 }
 
 static void STDMETHODCALLTYPE d3d11_deferred_context_IASetPrimitiveTopology(ID3D11DeviceContext1 *iface,
@@ -4812,11 +4918,16 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_IASetPrimitiveTopology(ID3D
 
     TRACE("iface %p, topology %u.\n", iface, topology);
 
+    if ((call = get_deferred_state_call(context, DEFERRED_IASETPRIMITIVETOPOLOGY))
+            && call->topology_info.topology == topology)
+        return;
+
     if (!(call = add_deferred_call(context, 0)))
         return;
 
     call->cmd = DEFERRED_IASETPRIMITIVETOPOLOGY;
     call->topology_info.topology = topology;
+    set_deferred_state_call(context, call);
 }
 
 static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetShaderResources(ID3D11DeviceContext1 *iface,
@@ -5011,6 +5122,12 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetBlendState(ID3D11Devic
     if (!blend_factor)
         blend_factor = default_blend_factor;
 
+    if ((call = get_deferred_state_call(context, DEFERRED_OMSETBLENDSTATE))
+            && call->blend_state_info.state == blend_state
+            && !memcmp(call->blend_state_info.factor, blend_factor, sizeof(call->blend_state_info.factor))
+            && call->blend_state_info.mask == sample_mask)
+        return;
+
     if (!(call = add_deferred_call(context, 0)))
         return;
 
@@ -5020,6 +5137,7 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetBlendState(ID3D11Devic
     for (i = 0; i < 4; i++)
         call->blend_state_info.factor[i] = blend_factor[i];
     call->blend_state_info.mask = sample_mask;
+    set_deferred_state_call(context, call);
 }
 
 static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetDepthStencilState(ID3D11DeviceContext1 *iface,
@@ -5031,6 +5149,11 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetDepthStencilState(ID3D
     TRACE("iface %p, depth_stencil_state %p, stencil_ref %u.\n",
             iface, depth_stencil_state, stencil_ref);
 
+    if ((call = get_deferred_state_call(context, DEFERRED_OMSETDEPTHSTENCILSTATE))
+            && call->stencil_state_info.state == depth_stencil_state
+            && call->stencil_state_info.stencil_ref == stencil_ref)
+        return;
+
     if (!(call = add_deferred_call(context, 0)))
         return;
 
@@ -5038,6 +5161,7 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetDepthStencilState(ID3D
     if (depth_stencil_state) ID3D11DepthStencilState_AddRef(depth_stencil_state);
     call->stencil_state_info.state = depth_stencil_state;
     call->stencil_state_info.stencil_ref = stencil_ref;
+    set_deferred_state_call(context, call);
 }
 
 static void STDMETHODCALLTYPE d3d11_deferred_context_SOSetTargets(ID3D11DeviceContext1 *iface,
@@ -5155,12 +5279,17 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetState(ID3D11DeviceCont
 
     TRACE("iface %p, rasterizer_state %p.\n", iface, rasterizer_state);
 
+    if ((call = get_deferred_state_call(context, DEFERRED_RSSETSTATE))
+            && call->rstate_info.state == rasterizer_state)
+        return;
+
     if (!(call = add_deferred_call(context, 0)))
         return;
 
     call->cmd = DEFERRED_RSSETSTATE;
     if (rasterizer_state) ID3D11RasterizerState_AddRef(rasterizer_state);
     call->rstate_info.state = rasterizer_state;
+    set_deferred_state_call(context, call);
 }
 
 static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetViewports(ID3D11DeviceContext1 *iface,
@@ -5171,6 +5300,11 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetViewports(ID3D11Device
 
     TRACE("iface %p, viewport_count %u, viewports %p.\n", iface, viewport_count, viewports);
 
+    if ((call = get_deferred_state_call(context, DEFERRED_RSSETVIEWPORTS))
+            && call->viewport_info.num_viewports == viewport_count
+            && !memcmp(call->viewport_info.viewports, viewports, sizeof(D3D11_VIEWPORT) * viewport_count))
+        return;
+
     if (!(call = add_deferred_call(context, sizeof(D3D11_VIEWPORT) * viewport_count)))
         return;
 
@@ -5178,6 +5312,7 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetViewports(ID3D11Device
     call->viewport_info.num_viewports = viewport_count;
     call->viewport_info.viewports = (void *)(call + 1);
     memcpy(call->viewport_info.viewports, viewports, sizeof(D3D11_VIEWPORT) * viewport_count);
+    set_deferred_state_call(context, call);
 }
 
 static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetScissorRects(ID3D11DeviceContext1 *iface,
@@ -5188,6 +5323,11 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetScissorRects(ID3D11Dev
 
     TRACE("iface %p, rect_count %u, rects %p.\n", iface, rect_count, rects);
 
+    if ((call = get_deferred_state_call(context, DEFERRED_RSSETSCISSORRECTS))
+            && call->rs_set_scissor_rects_info.rect_count == rect_count
+            && !memcmp(call->rs_set_scissor_rects_info.rects, rects, sizeof(D3D11_RECT) * rect_count))
+        return;
+
     if (!(call = add_deferred_call(context, sizeof(D3D11_RECT) * rect_count)))
         return;
 
@@ -5195,6 +5335,7 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetScissorRects(ID3D11Dev
     call->rs_set_scissor_rects_info.rects = (void *)(call + 1);
     call->rs_set_scissor_rects_info.rect_count = rect_count;
     memcpy(call->rs_set_scissor_rects_info.rects, rects, sizeof(D3D11_RECT) * rect_count);
+    set_deferred_state_call(context, call);
 }
 
 static void STDMETHODCALLTYPE d3d11_deferred_context_CopySubresourceRegion(ID3D11DeviceContext1 *iface,
@@ -5502,12 +5643,16 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetShader(ID3D11DeviceCon
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
             iface, shader, class_instances, class_instance_count);
 
+    if ((call = get_deferred_state_call(context, DEFERRED_HSSETSHADER)) && call->hs_info.shader == shader)
+        return;
+
     if (!(call = add_deferred_call(context, 0)))
         return;
 
     call->cmd = DEFERRED_HSSETSHADER;
     if (shader) ID3D11HullShader_AddRef(shader);
     call->hs_info.shader = shader;
+    set_deferred_state_call(context, call);
 }
 
 static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetSamplers(ID3D11DeviceContext1 *iface,
@@ -5552,12 +5697,16 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetShader(ID3D11DeviceCon
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
             iface, shader, class_instances, class_instance_count);
 
+    if ((call = get_deferred_state_call(context, DEFERRED_DSSETSHADER)) && call->ds_info.shader == shader)
+        return;
+
     if (!(call = add_deferred_call(context, 0)))
         return;
 
     call->cmd = DEFERRED_DSSETSHADER;
     if (shader) ID3D11DomainShader_AddRef(shader);
     call->ds_info.shader = shader;
+    set_deferred_state_call(context, call);
 }
 
 static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetSamplers(ID3D11DeviceContext1 *iface,
@@ -5629,12 +5778,16 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetShader(ID3D11DeviceCon
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
             iface, shader, class_instances, class_instance_count);
 
+    if ((call = get_deferred_state_call(context, DEFERRED_CSSETSHADER)) && call->cs_info.shader == shader)
+        return;
+
     if (!(call = add_deferred_call(context, 0)))
         return;
 
     call->cmd = DEFERRED_CSSETSHADER;
     if (shader) ID3D11ComputeShader_AddRef(shader);
     call->cs_info.shader = shader;
+    set_deferred_state_call(context, call);
 }
 
 static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetSamplers(ID3D11DeviceContext1 *iface,
@@ -5931,6 +6084,7 @@ static void STDMETHODCALLTYPE d3d11_deferred_context_ClearState(ID3D11DeviceCont
         return;
 
     call->cmd = DEFERRED_CLEARSTATE;
+    reset_deferred_state_calls(context);
 }
 
 static void STDMETHODCALLTYPE d3d11_deferred_context_Flush(ID3D11DeviceContext1 *iface)
@@ -5972,6 +6126,9 @@ static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_FinishCommandList(ID3D11
 
     list_init(&object->commands);
     list_move_tail(&object->commands, &context->commands);
+    list_init(&object->chunks);
+    list_move_tail(&object->chunks, &context->chunks);
+    reset_deferred_state_calls(context);
 
     ID3D11Device_AddRef(context->device);
     wined3d_private_store_init(&object->private_store);
@@ -6755,6 +6912,7 @@ static HRESULT STDMETHODCALLTYPE d3d11_device_CreateDeferredContext(ID3D11Device
     object->refcount = 1;
 
     list_init(&object->commands);
+    list_init(&object->chunks);
 
     ID3D11Device2_AddRef(iface);
     wined3d_private_store_init(&object->private_store);
@@ -2098,6 +2098,8 @@ static void test_create_device(void)
 
 static void test_draw_deferred_context(void)
 {
+    static const struct vec4 green = {0.0f, 1.0f, 0.0f, 1.0f};
+    static const struct vec4 blue = {0.0f, 0.0f, 1.0f, 1.0f};
     static const struct vec4 red = {1.0f, 0.0f, 0.0f, 1.0f};
     static const float white[] = {1.0f, 1.0f, 1.0f, 1.0f};
     static const float black[] = {0.0f, 0.0f, 0.0f, 0.0f};
@@ -2105,6 +2107,7 @@ static void test_draw_deferred_context(void)
     struct d3d11_test_context test_context;
     ID3D11CommandList *command_list;
     ID3D11Device *device;
+    unsigned int i;
     DWORD color;
     HRESULT hr;
 
@@ -2145,6 +2148,43 @@ static void test_draw_deferred_context(void)
     ok(color == 0xff0000ff, "Got unexpected color 0x%08x.\n", color);
     ID3D11CommandList_Release(command_list);
 
+    /* Many draws with identical state, followed by a ClearState and the
+     * same state again. */
+    ID3D11DeviceContext_OMSetRenderTargets(deferred_context, 1, &test_context.backbuffer_rtv, NULL);
+    for (i = 0; i < 1000; ++i)
+        draw_color_quad_ext(&test_context, &green, NULL, 0, deferred_context);
+    ID3D11DeviceContext_ClearState(deferred_context);
+    ID3D11DeviceContext_OMSetRenderTargets(deferred_context, 1, &test_context.backbuffer_rtv, NULL);
+    draw_color_quad_ext(&test_context, &blue, NULL, 0, deferred_context);
+
+    hr = ID3D11DeviceContext_FinishCommandList(deferred_context, FALSE, &command_list);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    ID3D11DeviceContext_ClearRenderTargetView(context, test_context.backbuffer_rtv, white);
+    ID3D11DeviceContext_ExecuteCommandList(context, command_list, TRUE);
+
+    color = get_texture_color(test_context.backbuffer, 320, 240);
+    ok(color == 0xffff0000, "Got unexpected color 0x%08x.\n", color);
+    ID3D11CommandList_Release(command_list);
+
+    /* Each command list starts from a clean state. */
+    ID3D11DeviceContext_OMSetRenderTargets(deferred_context, 1, &test_context.backbuffer_rtv, NULL);
+    draw_color_quad_ext(&test_context, &green, NULL, 0, deferred_context);
+    hr = ID3D11DeviceContext_FinishCommandList(deferred_context, FALSE, &command_list);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    ID3D11CommandList_Release(command_list);
+
+    ID3D11DeviceContext_OMSetRenderTargets(deferred_context, 1, &test_context.backbuffer_rtv, NULL);
+    draw_color_quad_ext(&test_context, &red, NULL, 0, deferred_context);
+    hr = ID3D11DeviceContext_FinishCommandList(deferred_context, FALSE, &command_list);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    ID3D11DeviceContext_ClearState(context);
+    ID3D11DeviceContext_ClearRenderTargetView(context, test_context.backbuffer_rtv, white);
+    ID3D11DeviceContext_ExecuteCommandList(context, command_list, TRUE);
+
+    color = get_texture_color(test_context.backbuffer, 320, 240);
+    ok(color == 0xff0000ff, "Got unexpected color 0x%08x.\n", color);
+    ID3D11CommandList_Release(command_list);
+
     ID3D11DeviceContext_Release(deferred_context);
     release_test_context(&test_context);
 }
@@ -13356,6 +13396,75 @@ static void test_resource_map(void)
     ok(!refcount, "Device has %u references left.\n", refcount);
 }
 
+static void test_buffer_discard_map(void)
+{
+    static const unsigned int map_count = 256, buffer_size = 0x10000;
+    D3D11_MAPPED_SUBRESOURCE map_desc;
+    ID3D11Buffer *buffer, *dst_buffer;
+    D3D11_BUFFER_DESC buffer_desc;
+    ID3D11DeviceContext *context;
+    struct resource_readback rb;
+    unsigned int i, j;
+    ID3D11Device *device;
+    DWORD *data, value;
+    ULONG refcount;
+    D3D11_BOX box;
+    HRESULT hr;
+
+    if (!(device = create_device(NULL)))
+    {
+        skip("Failed to create device.\n");
+        return;
+    }
+
+    ID3D11Device_GetImmediateContext(device, &context);
+
+    buffer_desc.ByteWidth = buffer_size;
+    buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
+    buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    buffer_desc.MiscFlags = 0;
+    buffer_desc.StructureByteStride = 0;
+    hr = ID3D11Device_CreateBuffer(device, &buffer_desc, NULL, &buffer);
+    ok(SUCCEEDED(hr), "Failed to create a buffer, hr %#x.\n", hr);
+
+    dst_buffer = create_buffer(device, D3D11_BIND_VERTEX_BUFFER, map_count * sizeof(*data), NULL);
+
+    /* Every DISCARD map must see its own data, even when the maps are
+     * queued faster than the GPU consumes them. */
+    for (i = 0; i < map_count; ++i)
+    {
+        hr = ID3D11DeviceContext_Map(context, (ID3D11Resource *)buffer, 0,
+                D3D11_MAP_WRITE_DISCARD, 0, &map_desc);
+        ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+        if (FAILED(hr))
+            break;
+        ok(map_desc.RowPitch == buffer_size, "Got unexpected row pitch %u.\n", map_desc.RowPitch);
+        data = map_desc.pData;
+        for (j = 0; j < buffer_size / sizeof(*data); ++j)
+            data[j] = i << 16 | j;
+        ID3D11DeviceContext_Unmap(context, (ID3D11Resource *)buffer, 0);
+
+        set_box(&box, i * sizeof(*data), 0, 0, (i + 1) * sizeof(*data), 1, 1);
+        ID3D11DeviceContext_CopySubresourceRegion(context, (ID3D11Resource *)dst_buffer, 0,
+                i * sizeof(*data), 0, 0, (ID3D11Resource *)buffer, 0, &box);
+    }
+
+    get_buffer_readback(dst_buffer, &rb);
+    for (i = 0; i < map_count; ++i)
+    {
+        value = get_readback_u32(&rb, i, 0, 0);
+        ok(value == (i << 16 | i), "Got unexpected value %#x at %u.\n", value, i);
+    }
+    release_resource_readback(&rb);
+
+    ID3D11Buffer_Release(dst_buffer);
+    ID3D11Buffer_Release(buffer);
+    ID3D11DeviceContext_Release(context);
+    refcount = ID3D11Device_Release(device);
+    ok(!refcount, "Device has %u references left.\n", refcount);
+}
+
 #define check_resource_cpu_access(a, b, c, d, e) check_resource_cpu_access_(__LINE__, a, b, c, d, e)
 static void check_resource_cpu_access_(unsigned int line, ID3D11DeviceContext *context,
         ID3D11Resource *resource, D3D11_USAGE usage, UINT bind_flags, UINT cpu_access)
@@ -30227,6 +30336,7 @@ START_TEST(d3d11)
     queue_test(test_copy_subresource_region_1d);
     queue_test(test_copy_subresource_region_3d);
     queue_test(test_resource_map);
+    queue_test(test_buffer_discard_map);
     queue_for_each_feature_level(test_resource_access);
     queue_test(test_check_multisample_quality_levels);
     queue_for_each_feature_level(test_swapchain_formats);
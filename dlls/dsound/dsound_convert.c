@@ -100,6 +100,36 @@ static float getieee32(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD chann
 
 const bitsgetfunc getbpp[5] = {get8, get16, get24, get32, getieee32};
 
+/* Bulk versions of the getters above: convert 'count' samples, starting with the
+ * given channel of the frame at 'pos' and taking every 'stride'th one after that.
+ * The caller makes sure they don't run past the end of the buffer. */
+void get16_frames(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, UINT stride, float *dst, UINT count)
+{
+    const SHORT *sbuf = (const SHORT *)(dsb->buffer->memory + pos) + channel;
+    UINT i = 0;
+
+#ifndef WORDS_BIGENDIAN
+    if (stride == 1)
+        i = mix_kernels->convert_s16(dst, sbuf, count);
+#endif
+    for (; i < count; i++)
+        dst[i] = (SHORT)le16(sbuf[i * stride]) / (float)0x8000;
+}
+
+void getieee32_frames(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, UINT stride, float *dst, UINT count)
+{
+    const float *sbuf = (const float *)(dsb->buffer->memory + pos) + channel;
+    UINT i;
+
+    if (stride == 1)
+    {
+        memcpy(dst, sbuf, count * sizeof(float));
+        return;
+    }
+    for (i = 0; i < count; i++)
+        dst[i] = sbuf[i * stride];
+}
+
 float get_mono(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel)
 {
     DWORD channels = dsb->pwfx->nChannels;
@@ -324,9 +354,12 @@ void put_quad2stereo(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel
 
 void mixieee32(float *src, float *dst, unsigned samples)
 {
+    unsigned i;
+
     TRACE("%p - %p %d\n", src, dst, samples);
-    while (samples--)
-        *(dst++) += *(src++);
+    i = mix_kernels->mix(dst, src, samples);
+    for (; i < samples; i++)
+        dst[i] += src[i];
 }
 
 static void norm8(float *src, unsigned char *dst, unsigned samples)
@@ -382,3 +415,40 @@ const normfunc normfunctions[4] = {
     (normfunc)norm24,
     (normfunc)norm32,
 };
+
+static UINT convert_s16_null(float *dst, const SHORT *src, UINT count)
+{
+    return 0;
+}
+
+static UINT scale_null(float *buf, const float *vols, UINT channels, UINT count)
+{
+    return 0;
+}
+
+static UINT mix_null(float *dst, const float *src, UINT count)
+{
+    return 0;
+}
+
+static UINT dot_null(const float *a, const float *b, UINT count, float *sum)
+{
+    return 0;
+}
+
+static const mix_funcs mix_funcs_null =
+{
+    convert_s16_null,
+    scale_null,
+    mix_null,
+    dot_null
+};
+
+const mix_funcs *mix_kernels = &mix_funcs_null;
+
+void init_mix_funcs(void)
+{
+    const mix_funcs *funcs;
+
+    if ((funcs = get_mix_funcs_sse2())) mix_kernels = funcs;
+}
@@ -48,13 +48,30 @@ typedef struct DirectSoundDevice             DirectSoundDevice;
 /* dsound_convert.h */
 typedef float (*bitsgetfunc)(const IDirectSoundBufferImpl *, DWORD, DWORD);
 typedef void (*bitsputfunc)(const IDirectSoundBufferImpl *, DWORD, DWORD, float);
+typedef void (*bitsgetframesfunc)(const IDirectSoundBufferImpl *, DWORD, DWORD, UINT, float *, UINT);
 extern const bitsgetfunc getbpp[5] DECLSPEC_HIDDEN;
+void get16_frames(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, UINT stride, float *dst, UINT count) DECLSPEC_HIDDEN;
+void getieee32_frames(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, UINT stride, float *dst, UINT count) DECLSPEC_HIDDEN;
 void putieee32(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value) DECLSPEC_HIDDEN;
 void putieee32_sum(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value) DECLSPEC_HIDDEN;
 void mixieee32(float *src, float *dst, unsigned samples) DECLSPEC_HIDDEN;
 typedef void (*normfunc)(const void *, void *, unsigned);
 extern const normfunc normfunctions[4] DECLSPEC_HIDDEN;
 
+/* optional vectorized versions of the innermost mixer loops; each returns the number
+ * of leading samples it processed, the caller handles the rest with the scalar code */
+typedef struct mix_funcs
+{
+    UINT (*convert_s16)(float *dst, const SHORT *src, UINT count);
+    UINT (*scale)(float *buf, const float *vols, UINT channels, UINT count);
+    UINT (*mix)(float *dst, const float *src, UINT count);
+    UINT (*dot)(const float *a, const float *b, UINT count, float *sum);
+} mix_funcs;
+
+extern const mix_funcs *mix_kernels DECLSPEC_HIDDEN;
+void init_mix_funcs(void) DECLSPEC_HIDDEN;
+const mix_funcs *get_mix_funcs_sse2(void) DECLSPEC_HIDDEN;
+
 typedef struct _DSVOLUMEPAN
 {
     DWORD	dwTotalAmpFactor[DS_MAX_CHANNELS];
@@ -93,6 +110,8 @@ struct DirectSoundDevice
     int                         lfe_channel;
     float *tmp_buffer, *cp_buffer, *dsp_buffer;
     DWORD                       tmp_buffer_len, cp_buffer_len, dsp_buffer_len;
+    LONGLONG                    mix_time;
+    DWORD                       mix_count, mix_buffers;
 
     DSVOLUMEPAN                 volpan;
 
@@ -170,6 +189,7 @@ struct IDirectSoundBufferImpl
     int                         mix_channels;
     bitsgetfunc get, get_aux;
     bitsputfunc put, put_aux;
+    bitsgetframesfunc           get_frames;
     int                         num_filters;
     DSFilter*                   filters;
 
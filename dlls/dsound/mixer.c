@@ -196,6 +196,16 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb)
 			FIXME("Conversion from %u to %u channels is not implemented, falling back to stereo\n", ichannels, ochannels);
 		dsb->mix_channels = 2;
 	}
+
+	/* Common formats are read in bulk instead of one sample at a time. */
+	dsb->get_frames = NULL;
+	if (dsb->get == dsb->get_aux)
+	{
+		if (ieee && dsb->pwfx->wBitsPerSample == 32)
+			dsb->get_frames = getieee32_frames;
+		else if (!ieee && dsb->pwfx->wBitsPerSample == 16)
+			dsb->get_frames = get16_frames;
+	}
 }
 
 /**
@@ -275,6 +285,20 @@ void DSOUND_CheckEvent(const IDirectSoundBufferImpl *dsb, DWORD playpos, int len
     }
 }
 
+static float getieee32_dsp(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel)
+{
+    const BYTE *buf = (BYTE *)dsb->device->dsp_buffer;
+    const float *fbuf = (const float*)(buf + pos + sizeof(float) * channel);
+    return *fbuf;
+}
+
+static void putieee32_dsp(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value)
+{
+    BYTE *buf = (BYTE *)dsb->device->dsp_buffer;
+    float *fbuf = (float*)(buf + pos + sizeof(float) * channel);
+    *fbuf = value;
+}
+
 static inline float get_current_sample(const IDirectSoundBufferImpl *dsb,
         DWORD mixpos, DWORD channel)
 {
@@ -283,10 +307,89 @@ static inline float get_current_sample(const IDirectSoundBufferImpl *dsb,
     return dsb->get(dsb, mixpos % dsb->buflen, channel);
 }
 
+static inline BOOL can_get_frames(const IDirectSoundBufferImpl *dsb)
+{
+    return dsb->get_frames && !(dsb->sec_mixpos % dsb->pwfx->nBlockAlign);
+}
+
+/**
+ * Bulk version of get_current_sample(). Reads 'frames' frames starting at
+ * mixpos, either of a single channel (channels == 1) or of all the buffer
+ * channels interleaved (channel == 0, channels == nChannels).
+ */
+static void get_current_frames(const IDirectSoundBufferImpl *dsb, DWORD mixpos,
+        DWORD channel, UINT channels, float *dst, UINT frames)
+{
+    UINT istride = dsb->pwfx->nBlockAlign;
+    UINT stride = channels == 1 ? dsb->pwfx->nChannels : 1;
+    UINT run;
+
+    while (frames)
+    {
+        if (mixpos >= dsb->buflen)
+        {
+            if (!(dsb->playflags & DSBPLAY_LOOPING))
+            {
+                memset(dst, 0, frames * channels * sizeof(float));
+                return;
+            }
+            mixpos %= dsb->buflen;
+        }
+
+        run = min(frames, (dsb->buflen - mixpos) / istride);
+        dsb->get_frames(dsb, mixpos, channel, stride, dst, run * channels);
+        dst += run * channels;
+        mixpos += run * istride;
+        frames -= run;
+    }
+}
+
+/* Converts 'frames' input frames into one non-interleaved array per mixed channel. */
+static void get_intermediate(const IDirectSoundBufferImpl *dsb, float *intermediate, UINT frames)
+{
+    UINT istride = dsb->pwfx->nBlockAlign;
+    DWORD channel, i;
+
+    if (can_get_frames(dsb))
+    {
+        for (channel = 0; channel < dsb->mix_channels; channel++)
+            get_current_frames(dsb, dsb->sec_mixpos, channel, 1, intermediate + channel * frames, frames);
+        return;
+    }
+
+    for (channel = 0; channel < dsb->mix_channels; channel++)
+        for (i = 0; i < frames; i++)
+            *(intermediate++) = get_current_sample(dsb,
+                    dsb->sec_mixpos + i * istride, channel);
+}
+
+static float *get_cp_buffer(DirectSoundDevice *device, DWORD len)
+{
+    if (!device->cp_buffer) {
+        device->cp_buffer = HeapAlloc(GetProcessHeap(), 0, len);
+        device->cp_buffer_len = len;
+    } else if (len > device->cp_buffer_len) {
+        device->cp_buffer = HeapReAlloc(GetProcessHeap(), 0, device->cp_buffer, len);
+        device->cp_buffer_len = len;
+    }
+    return device->cp_buffer;
+}
+
 static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, bitsputfunc put, UINT ostride, UINT count)
 {
     UINT istride = dsb->pwfx->nBlockAlign;
     DWORD channel, i;
+
+    /* Same channel layout on both sides, convert straight into the float buffer. */
+    if (can_get_frames(dsb) && dsb->mix_channels == dsb->pwfx->nChannels
+            && ostride == dsb->mix_channels * sizeof(float)
+            && (put == putieee32 || put == putieee32_dsp))
+    {
+        float *dst = put == putieee32 ? dsb->device->tmp_buffer : dsb->device->dsp_buffer;
+        get_current_frames(dsb, dsb->sec_mixpos, 0, dsb->mix_channels, dst, count);
+        return count;
+    }
+
     for (i = 0; i < count; i++)
         for (channel = 0; channel < dsb->mix_channels; channel++)
             put(dsb, i * ostride, channel, get_current_sample(dsb,
@@ -304,29 +407,53 @@ static UINT cp_fields_resample_lq(IDirectSoundBufferImpl *dsb, bitsputfunc put,
     LONG64 freqAcc_start = *freqAccNum;
     LONG64 freqAcc_end = freqAcc_start + count * dsb->freqAdjustNum;
     UINT max_ipos = freqAcc_end / dsb->freqAdjustDen;
+    UINT required_input = max_ipos + 2;
+    float *intermediate;
+
+    if (!can_get_frames(dsb)) {
+        for (i = 0; i < count; ++i) {
+            float cur_freqAcc = (freqAcc_start + i * dsb->freqAdjustNum) / (float)dsb->freqAdjustDen;
+            float cur_freqAcc2;
+            UINT ipos = cur_freqAcc;
+            UINT idx = dsb->sec_mixpos + ipos * istride;
+            cur_freqAcc -= (int)cur_freqAcc;
+            cur_freqAcc2 = 1.0f - cur_freqAcc;
+            for (channel = 0; channel < channels; channel++) {
+                /**
+                 * Generally we cannot cache the result of get_current_sample().
+                 * Consider the case of resampling from 192000 Hz to 44100 Hz -
+                 * none of the values will get reused for the next value of i.
+                 * OTOH, for resampling from 44100 Hz to 192000 Hz both values
+                 * will likely be reused.
+                 *
+                 * So far, this possibility of saving calls to
+                 * get_current_sample() is ignored.
+                 */
+                float s1 = get_current_sample(dsb, idx, channel);
+                float s2 = get_current_sample(dsb, idx + istride, channel);
+                float result = s1 * cur_freqAcc2 + s2 * cur_freqAcc;
+                put(dsb, i * ostride, channel, result);
+            }
+        }
+
+        *freqAccNum = freqAcc_end % dsb->freqAdjustDen;
+        return max_ipos;
+    }
+
+    /* Bulk conversion is cheap enough that converting the whole input span once
+     * beats fetching both neighbours of every output sample. */
+    intermediate = get_cp_buffer(dsb->device, required_input * channels * sizeof(float));
+    get_intermediate(dsb, intermediate, required_input);
 
     for (i = 0; i < count; ++i) {
         float cur_freqAcc = (freqAcc_start + i * dsb->freqAdjustNum) / (float)dsb->freqAdjustDen;
         float cur_freqAcc2;
-        UINT ipos = cur_freqAcc;
-        UINT idx = dsb->sec_mixpos + ipos * istride;
+        UINT ipos = min((UINT)cur_freqAcc, max_ipos);
         cur_freqAcc -= (int)cur_freqAcc;
         cur_freqAcc2 = 1.0f - cur_freqAcc;
         for (channel = 0; channel < channels; channel++) {
-            /**
-             * Generally we cannot cache the result of get_current_sample().
-             * Consider the case of resampling from 192000 Hz to 44100 Hz -
-             * none of the values will get reused for the next value of i.
-             * OTOH, for resampling from 44100 Hz to 192000 Hz both values
-             * will likely be reused.
-             *
-             * So far, this possibility of saving calls to
-             * get_current_sample() is ignored.
-             */
-            float s1 = get_current_sample(dsb, idx, channel);
-            float s2 = get_current_sample(dsb, idx + istride, channel);
-            float result = s1 * cur_freqAcc2 + s2 * cur_freqAcc;
-            put(dsb, i * ostride, channel, result);
+            const float *cache = &intermediate[channel * required_input + ipos];
+            put(dsb, i * ostride, channel, cache[0] * cur_freqAcc2 + cache[1] * cur_freqAcc);
         }
     }
 
@@ -338,7 +465,6 @@ static UINT cp_fields_resample_hq(IDirectSoundBufferImpl *dsb, bitsputfunc put,
                                   UINT ostride, UINT count, LONG64 *freqAccNum)
 {
     UINT i, channel;
-    UINT istride = dsb->pwfx->nBlockAlign;
 
     LONG64 freqAcc_start = *freqAccNum;
     LONG64 freqAcc_end = freqAcc_start + count * dsb->freqAdjustNum;
@@ -348,33 +474,21 @@ static UINT cp_fields_resample_hq(IDirectSoundBufferImpl *dsb, bitsputfunc put,
 
     UINT fir_cachesize = (fir_len + dsbfirstep - 2) / dsbfirstep;
     UINT required_input = max_ipos + fir_cachesize;
-    float *intermediate, *fir_copy, *itmp;
+    float *intermediate, *fir_copy;
 
     DWORD len = required_input * channels;
     len += fir_cachesize;
     len *= sizeof(float);
 
-    if (!dsb->device->cp_buffer) {
-        dsb->device->cp_buffer = HeapAlloc(GetProcessHeap(), 0, len);
-        dsb->device->cp_buffer_len = len;
-    } else if (len > dsb->device->cp_buffer_len) {
-        dsb->device->cp_buffer = HeapReAlloc(GetProcessHeap(), 0, dsb->device->cp_buffer, len);
-        dsb->device->cp_buffer_len = len;
-    }
-
-    fir_copy = dsb->device->cp_buffer;
+    fir_copy = get_cp_buffer(dsb->device, len);
     intermediate = fir_copy + fir_cachesize;
 
 
     /* Important: this buffer MUST be non-interleaved
-     * if you want -msse3 to have any effect.
+     * for the dot product kernel to have any effect.
      * This is good for CPU cache effects, too.
      */
-    itmp = intermediate;
-    for (channel = 0; channel < channels; channel++)
-        for (i = 0; i < required_input; i++)
-            *(itmp++) = get_current_sample(dsb,
-                    dsb->sec_mixpos + i * istride, channel);
+    get_intermediate(dsb, intermediate, required_input);
 
     for(i = 0; i < count; ++i) {
         UINT int_fir_steps = (freqAcc_start + i * dsb->freqAdjustNum) * dsbfirstep / dsb->freqAdjustDen;
@@ -397,7 +511,7 @@ static UINT cp_fields_resample_hq(IDirectSoundBufferImpl *dsb, bitsputfunc put,
             int j;
             float sum = 0.0;
             float* cache = &intermediate[channel * required_input + ipos];
-            for (j = 0; j < fir_used; j++)
+            for (j = mix_kernels->dot(fir_copy, cache, fir_used, &sum); j < fir_used; j++)
                 sum += fir_copy[j] * cache[j];
             put(dsb, i * ostride, channel, sum * dsb->firgain);
         }
@@ -449,20 +563,6 @@ static inline DWORD DSOUND_BufPtrDiff(DWORD buflen, DWORD ptr1, DWORD ptr2)
 	}
 }
 
-static float getieee32_dsp(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel)
-{
-    const BYTE *buf = (BYTE *)dsb->device->dsp_buffer;
-    const float *fbuf = (const float*)(buf + pos + sizeof(float) * channel);
-    return *fbuf;
-}
-
-static void putieee32_dsp(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value)
-{
-    BYTE *buf = (BYTE *)dsb->device->dsp_buffer;
-    float *fbuf = (float*)(buf + pos + sizeof(float) * channel);
-    *fbuf = value;
-}
-
 /**
  * Mix at most the given amount of data into the allocated temporary buffer
  * of the given secondary buffer, starting from the dsb's first currently
@@ -544,7 +644,7 @@ static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, INT frames)
 {
 	INT	i;
 	float vols[DS_MAX_CHANNELS];
-	UINT channels = dsb->device->pwfx->nChannels, chan;
+	UINT channels = dsb->device->pwfx->nChannels;
 
 	TRACE("(%p,%d)\n",dsb,frames);
 	TRACE("left = %x, right = %x\n", dsb->volpan.dwTotalAmpFactor[0],
@@ -564,10 +664,9 @@ static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, INT frames)
 	for (i = 0; i < channels; ++i)
 		vols[i] = dsb->volpan.dwTotalAmpFactor[i] / ((float)0xFFFF);
 
-	for(i = 0; i < frames; ++i){
-		for(chan = 0; chan < channels; ++chan){
-			dsb->device->tmp_buffer[i * channels + chan] *= vols[chan];
-		}
+	i = mix_kernels->scale(dsb->device->tmp_buffer, vols, channels, frames * channels);
+	for(; i < frames * channels; ++i){
+		dsb->device->tmp_buffer[i] *= vols[i % channels];
 	}
 }
 
@@ -737,6 +836,28 @@ static void DSOUND_WaveQueue(DirectSoundDevice *device, LPBYTE pos, DWORD bytes)
 	device->pad += bytes;
 }
 
+/**
+ * Keep track of the time spent mixing, so that the cost of the mixer
+ * with many playing buffers can be followed in the logs.
+ */
+static void DSOUND_UpdateMixStats(DirectSoundDevice *device, const LARGE_INTEGER *start)
+{
+	LARGE_INTEGER end, freq;
+
+	QueryPerformanceCounter(&end);
+	device->mix_time += end.QuadPart - start->QuadPart;
+	device->mix_buffers += device->nrofbuffers;
+
+	if (++device->mix_count == 1000) {
+		QueryPerformanceFrequency(&freq);
+		TRACE("%u mixes of %u buffers on average took %s us each\n", device->mix_count,
+				device->mix_buffers / device->mix_count,
+				wine_dbgstr_longlong(device->mix_time * 1000000 / freq.QuadPart / device->mix_count));
+		device->mix_time = 0;
+		device->mix_count = device->mix_buffers = 0;
+	}
+}
+
 /**
  * Perform mixing for a Direct Sound device. That is, go through all the
  * secondary buffers (the sound bites currently playing) and mix them in
@@ -782,6 +903,7 @@ static void DSOUND_PerformMix(DirectSoundDevice *device)
 
 	if (device->priolevel != DSSCL_WRITEPRIMARY) {
 		BOOL all_stopped = FALSE;
+		LARGE_INTEGER start;
 		int nfiller;
 		void *buffer = NULL;
 
@@ -802,6 +924,8 @@ static void DSOUND_PerformMix(DirectSoundDevice *device)
 
 		memset(buffer, nfiller, frames * block);
 
+		QueryPerformanceCounter(&start);
+
 		if (!device->normfunction)
 			DSOUND_MixToPrimary(device, buffer, frames, &all_stopped);
 		else {
@@ -813,6 +937,9 @@ static void DSOUND_PerformMix(DirectSoundDevice *device)
 			device->normfunction(device->buffer, buffer, frames * device->pwfx->nChannels);
 		}
 
+		if (TRACE_ON(dsound))
+			DSOUND_UpdateMixStats(device, &start);
+
 		hr = IAudioRenderClient_ReleaseBuffer(device->render, frames, 0);
 		if(FAILED(hr))
 			ERR("ReleaseBuffer failed: %08x\n", hr);
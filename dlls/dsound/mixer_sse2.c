@@ -0,0 +1,126 @@
+/* DirectSound SSE2 mixer kernels
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include <stdarg.h>
+
+#include "windef.h"
+#include "winbase.h"
+#include "mmsystem.h"
+#include "wine/debug.h"
+#include "dsound.h"
+#include "dsound_private.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(dsound);
+
+#if (defined(__i386__) || defined(__x86_64__)) && \
+    (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+
+#include <emmintrin.h>
+
+/* Apart from the summation order in dot_sse2, the kernels below give exactly the
+ * same results as the scalar code, which handles whatever is left over. */
+
+#define SSE2 __attribute__((target("sse2")))
+
+static SSE2 UINT convert_s16_sse2(float *dst, const SHORT *src, UINT count)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / 0x8000);
+    __m128i v, lo, hi;
+    UINT i;
+
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        v = _mm_loadu_si128((const __m128i *)(src + i));
+        /* sign extend by moving each sample to the top half and shifting back */
+        lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    return i;
+}
+
+static SSE2 UINT scale_sse2(float *buf, const float *vols, UINT channels, UINT count)
+{
+    __m128 factors;
+    UINT i;
+
+    /* the factors must repeat every four samples */
+    switch (channels)
+    {
+    case 1: factors = _mm_set1_ps(vols[0]); break;
+    case 2: factors = _mm_setr_ps(vols[0], vols[1], vols[0], vols[1]); break;
+    case 4: factors = _mm_setr_ps(vols[0], vols[1], vols[2], vols[3]); break;
+    default: return 0;
+    }
+
+    for (i = 0; i + 4 <= count; i += 4)
+        _mm_storeu_ps(buf + i, _mm_mul_ps(_mm_loadu_ps(buf + i), factors));
+    return i;
+}
+
+static SSE2 UINT mix_sse2(float *dst, const float *src, UINT count)
+{
+    UINT i;
+
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+        _mm_storeu_ps(dst + i + 4, _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_loadu_ps(src + i + 4)));
+    }
+    return i;
+}
+
+static SSE2 UINT dot_sse2(const float *a, const float *b, UINT count, float *sum)
+{
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    float partial[4];
+    UINT i;
+
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    _mm_storeu_ps(partial, _mm_add_ps(acc0, acc1));
+    *sum += partial[0] + partial[1] + partial[2] + partial[3];
+    return i;
+}
+
+static const mix_funcs mix_funcs_sse2 =
+{
+    convert_s16_sse2,
+    scale_sse2,
+    mix_sse2,
+    dot_sse2
+};
+
+const mix_funcs *get_mix_funcs_sse2(void)
+{
+    if (!IsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE)) return NULL;
+    TRACE("using SSE2 mixer kernels\n");
+    return &mix_funcs_sse2;
+}
+
+#else  /* (__i386__ || __x86_64__) && target attribute support */
+
+const mix_funcs *get_mix_funcs_sse2(void)
+{
+    return NULL;
+}
+
+#endif
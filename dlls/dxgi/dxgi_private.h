@@ -173,7 +173,7 @@ struct dxgi_adapter *unsafe_impl_from_IDXGIAdapter(IDXGIAdapter *iface) DECLSPEC
 /* IDXGISwapChain */
 struct d3d11_swapchain
 {
-    IDXGISwapChain1 IDXGISwapChain1_iface;
+    IDXGISwapChain2 IDXGISwapChain2_iface;
     LONG refcount;
     struct wined3d_private_store private_store;
     struct wined3d_swapchain *wined3d_swapchain;
@@ -181,6 +181,10 @@ struct d3d11_swapchain
     IDXGIFactory *factory;
 
     IDXGIOutput *target;
+
+    UINT present_count;
+    HANDLE frame_latency_semaphore;
+    UINT frame_latency;
 };
 
 HRESULT d3d11_swapchain_init(struct d3d11_swapchain *swapchain, struct dxgi_device *device,
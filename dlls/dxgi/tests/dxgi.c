@@ -4792,6 +4792,87 @@ static void test_swapchain_present(IUnknown *device, BOOL is_d3d12)
     ok(refcount == !is_d3d12, "Got unexpected refcount %u.\n", refcount);
 }
 
+static void test_swapchain_frame_statistics(IUnknown *device, BOOL is_d3d12)
+{
+    DXGI_SWAP_CHAIN_DESC swapchain_desc;
+    DXGI_FRAME_STATISTICS stats;
+    IDXGISwapChain *swapchain;
+    IDXGIFactory *factory;
+    LARGE_INTEGER now;
+    UINT present_count;
+    unsigned int i;
+    ULONG refcount;
+    HRESULT hr;
+
+    get_factory(device, is_d3d12, &factory);
+
+    swapchain_desc.BufferDesc.Width = 640;
+    swapchain_desc.BufferDesc.Height = 480;
+    swapchain_desc.BufferDesc.RefreshRate.Numerator = 60;
+    swapchain_desc.BufferDesc.RefreshRate.Denominator = 1;
+    swapchain_desc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    swapchain_desc.BufferDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
+    swapchain_desc.BufferDesc.Scaling = DXGI_MODE_SCALING_UNSPECIFIED;
+    swapchain_desc.SampleDesc.Count = 1;
+    swapchain_desc.SampleDesc.Quality = 0;
+    swapchain_desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    swapchain_desc.BufferCount = is_d3d12 ? 2 : 1;
+    swapchain_desc.OutputWindow = create_window();
+    swapchain_desc.Windowed = TRUE;
+    swapchain_desc.SwapEffect = is_d3d12 ? DXGI_SWAP_EFFECT_FLIP_DISCARD : DXGI_SWAP_EFFECT_DISCARD;
+    swapchain_desc.Flags = 0;
+
+    hr = IDXGIFactory_CreateSwapChain(factory, device, &swapchain_desc, &swapchain);
+    ok(hr == S_OK, "Failed to create swapchain, hr %#x.\n", hr);
+
+    present_count = 0xdeadbeef;
+    hr = IDXGISwapChain_GetLastPresentCount(swapchain, &present_count);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    ok(!present_count, "Got unexpected present count %u.\n", present_count);
+
+    hr = IDXGISwapChain_GetFrameStatistics(swapchain, &stats);
+    ok(hr == DXGI_ERROR_FRAME_STATISTICS_DISJOINT, "Got unexpected hr %#x.\n", hr);
+
+    for (i = 0; i < 5; ++i)
+    {
+        hr = IDXGISwapChain_Present(swapchain, 0, 0);
+        ok(hr == S_OK, "Present %u failed, hr %#x.\n", i, hr);
+    }
+    hr = IDXGISwapChain_Present(swapchain, 0, DXGI_PRESENT_TEST);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+
+    hr = IDXGISwapChain_GetLastPresentCount(swapchain, &present_count);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    ok(present_count == 5, "Got unexpected present count %u.\n", present_count);
+
+    /* Frame statistics are only available once a present reaches the
+     * display, and may be unavailable altogether for windowed swapchains. */
+    for (i = 0; i < 100; ++i)
+    {
+        memset(&stats, 0, sizeof(stats));
+        if ((hr = IDXGISwapChain_GetFrameStatistics(swapchain, &stats)) == S_OK && stats.PresentCount == 5)
+            break;
+        Sleep(10);
+    }
+    ok(hr == S_OK || hr == DXGI_ERROR_FRAME_STATISTICS_DISJOINT, "Got unexpected hr %#x.\n", hr);
+    if (hr == S_OK)
+    {
+        QueryPerformanceCounter(&now);
+        ok(stats.PresentCount && stats.PresentCount <= 5, "Got unexpected present count %u.\n",
+                stats.PresentCount);
+        ok(stats.SyncQPCTime.QuadPart && stats.SyncQPCTime.QuadPart <= now.QuadPart,
+                "Got unexpected sync time %s.\n", wine_dbgstr_longlong(stats.SyncQPCTime.QuadPart));
+        ok(stats.SyncRefreshCount >= stats.PresentRefreshCount, "Got sync refresh count %u, present refresh count %u.\n",
+                stats.SyncRefreshCount, stats.PresentRefreshCount);
+    }
+
+    refcount = IDXGISwapChain_Release(swapchain);
+    ok(!refcount, "Swapchain has %u references left.\n", refcount);
+    DestroyWindow(swapchain_desc.OutputWindow);
+    refcount = IDXGIFactory_Release(factory);
+    ok(refcount == !is_d3d12, "Got unexpected refcount %u.\n", refcount);
+}
+
 static void test_swapchain_backbuffer_index(IUnknown *device, BOOL is_d3d12)
 {
     DXGI_SWAP_CHAIN_DESC swapchain_desc;
@@ -6853,9 +6934,11 @@ START_TEST(dxgi)
     run_on_d3d10(test_swapchain_resize);
     run_on_d3d10(test_swapchain_present);
     run_on_d3d10(test_swapchain_backbuffer_index);
+    run_on_d3d10(test_swapchain_frame_statistics);
     run_on_d3d10(test_swapchain_formats);
     run_on_d3d10(test_output_ownership);
     run_on_d3d10(test_cursor_clipping);
+    run_on_d3d10(test_frame_latency_event);
 
     if (!(d3d12_module = LoadLibraryA("d3d12.dll")))
     {
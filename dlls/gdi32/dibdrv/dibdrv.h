@@ -224,6 +224,20 @@ extern const primitive_funcs funcs_4    DECLSPEC_HIDDEN;
 extern const primitive_funcs funcs_1    DECLSPEC_HIDDEN;
 extern const primitive_funcs funcs_null DECLSPEC_HIDDEN;
 
+/* optional vectorized versions of the innermost row loops; each returns the number
+ * of leading pixels it processed, the caller handles the rest with the scalar code */
+typedef struct row_funcs
+{
+    int                (* blend_argb)(DWORD *dst, const DWORD *src, int len);
+    int          (* blend_argb_alpha)(DWORD *dst, const DWORD *src, int len, DWORD alpha);
+    int (* blend_argb_constant_alpha)(DWORD *dst, const DWORD *src, int len, DWORD alpha);
+    int   (* blend_argb_no_src_alpha)(DWORD *dst, const DWORD *src, int len, DWORD alpha);
+    int       (* convert_555_to_8888)(DWORD *dst, const WORD *src, int len);
+    int       (* convert_8888_to_555)(WORD *dst, const DWORD *src, int len);
+} row_funcs;
+
+extern const row_funcs *get_row_funcs_sse2(void) DECLSPEC_HIDDEN;
+
 struct rop_codes
 {
     DWORD a1, a2, x1, x2;
@@ -27,6 +27,45 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(dib);
 
+static int blend_argb_row_null( DWORD *dst, const DWORD *src, int len )
+{
+    return 0;
+}
+
+static int blend_argb_alpha_row_null( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    return 0;
+}
+
+static int convert_555_to_8888_row_null( DWORD *dst, const WORD *src, int len )
+{
+    return 0;
+}
+
+static int convert_8888_to_555_row_null( WORD *dst, const DWORD *src, int len )
+{
+    return 0;
+}
+
+static const row_funcs row_funcs_null =
+{
+    blend_argb_row_null,
+    blend_argb_alpha_row_null,
+    blend_argb_alpha_row_null,
+    blend_argb_alpha_row_null,
+    convert_555_to_8888_row_null,
+    convert_8888_to_555_row_null
+};
+
+static const row_funcs *row = &row_funcs_null;
+
+void init_dib_row_funcs(void)
+{
+    const row_funcs *funcs;
+
+    if ((funcs = get_row_funcs_sse2())) row = funcs;
+}
+
 /* Bayer matrices for dithering */
 
 static const BYTE bayer_4x4[4][4] =
@@ -2310,9 +2349,10 @@ static void convert_to_8888(dib_info *dst, const dib_info *src, const RECT *src_
         {
             for(y = src_rect->top; y < src_rect->bottom; y++)
             {
-                dst_pixel = dst_start;
-                src_pixel = src_start;
-                for(x = src_rect->left; x < src_rect->right; x++)
+                x = row->convert_555_to_8888(dst_start, src_start, src_rect->right - src_rect->left);
+                dst_pixel = dst_start + x;
+                src_pixel = src_start + x;
+                for(x += src_rect->left; x < src_rect->right; x++)
                 {
                     src_val = *src_pixel++;
                     *dst_pixel++ = ((src_val << 9) & 0xf80000) | ((src_val << 4) & 0x070000) |
@@ -2990,9 +3030,10 @@ static void convert_to_555(dib_info *dst, const dib_info *src, const RECT *src_r
         {
             for(y = src_rect->top; y < src_rect->bottom; y++)
             {
-                dst_pixel = dst_start;
-                src_pixel = src_start;
-                for(x = src_rect->left; x < src_rect->right; x++)
+                x = row->convert_8888_to_555(dst_start, src_start, src_rect->right - src_rect->left);
+                dst_pixel = dst_start + x;
+                src_pixel = src_start + x;
+                for(x += src_rect->left; x < src_rect->right; x++)
                 {
                     src_val = *src_pixel++;
                     *dst_pixel++ = ((src_val >> 9) & 0x7c00) |
@@ -4656,26 +4697,26 @@ static void blend_rect_8888(const dib_info *dst, const RECT *rc,
 {
     DWORD *src_ptr = get_pixel_ptr_32( src, origin->x, origin->y );
     DWORD *dst_ptr = get_pixel_ptr_32( dst, rc->left, rc->top );
-    int x, y;
+    int x, y, len = rc->right - rc->left;
 
     if (blend.AlphaFormat & AC_SRC_ALPHA)
     {
 	if (blend.SourceConstantAlpha == 255)
 	    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-		for (x = 0; x < rc->right - rc->left; x++)
+		for (x = row->blend_argb( dst_ptr, src_ptr, len ); x < len; x++)
 		    dst_ptr[x] = blend_argb( dst_ptr[x], src_ptr[x] );
         else
 	    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-		for (x = 0; x < rc->right - rc->left; x++)
+		for (x = row->blend_argb_alpha( dst_ptr, src_ptr, len, blend.SourceConstantAlpha ); x < len; x++)
 		    dst_ptr[x] = blend_argb_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
     }
     else if (src->compression == BI_RGB)
 	for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-	    for (x = 0; x < rc->right - rc->left; x++)
+	    for (x = row->blend_argb_constant_alpha( dst_ptr, src_ptr, len, blend.SourceConstantAlpha ); x < len; x++)
 		dst_ptr[x] = blend_argb_constant_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
     else
 	for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-	    for (x = 0; x < rc->right - rc->left; x++)
+	    for (x = row->blend_argb_no_src_alpha( dst_ptr, src_ptr, len, blend.SourceConstantAlpha ); x < len; x++)
 		dst_ptr[x] = blend_argb_no_src_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
 }
 
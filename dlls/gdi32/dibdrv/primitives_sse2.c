@@ -0,0 +1,211 @@
+/*
+ * DIB driver SSE2 row primitives.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "gdi_private.h"
+#include "dibdrv.h"
+
+#include "wine/debug.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(dib);
+
+#if (defined(__i386__) || defined(__x86_64__)) && \
+    (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+
+#include <emmintrin.h>
+
+/* The kernels below must give exactly the same results as the scalar code in
+ * primitives.c, which handles whatever is left over at the end of a row. */
+
+#define SSE2 __attribute__((target("sse2")))
+
+/* (x + 127) / 255 for 0 <= x <= 255 * 255 */
+static inline SSE2 __m128i div255_epu16( __m128i x )
+{
+    x = _mm_add_epi16( x, _mm_set1_epi16( 128 ) );
+    return _mm_srli_epi16( _mm_add_epi16( x, _mm_srli_epi16( x, 8 ) ), 8 );
+}
+
+static inline SSE2 __m128i broadcast_alpha_epu16( __m128i x )
+{
+    return _mm_shufflehi_epi16( _mm_shufflelo_epi16( x, 0xff ), 0xff );
+}
+
+/* src + dst * (255 - src alpha) / 255, per channel */
+static inline SSE2 __m128i blend_argb_epu16( __m128i dst, __m128i src )
+{
+    __m128i inv_alpha = _mm_sub_epi16( _mm_set1_epi16( 255 ), broadcast_alpha_epu16( src ) );
+    return _mm_add_epi16( src, div255_epu16( _mm_mullo_epi16( dst, inv_alpha ) ) );
+}
+
+/* Channel sums may reach 510 when the source isn't premultiplied. The scalar
+ * code ORs the channels together, so a carry ends up in the next channel. */
+static inline SSE2 __m128i pack_sum_epu16( __m128i lo, __m128i hi )
+{
+    const __m128i mask = _mm_set1_epi16( 0xff );
+    __m128i bytes = _mm_packus_epi16( _mm_and_si128( lo, mask ), _mm_and_si128( hi, mask ) );
+    __m128i carry = _mm_packus_epi16( _mm_srli_epi16( lo, 8 ), _mm_srli_epi16( hi, 8 ) );
+    return _mm_or_si128( bytes, _mm_slli_epi32( carry, 8 ) );
+}
+
+static SSE2 int blend_argb_sse2( DWORD *dst, const DWORD *src, int len )
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i s, d, lo, hi;
+    int x;
+
+    for (x = 0; x + 4 <= len; x += 4)
+    {
+        s = _mm_loadu_si128( (const __m128i *)(src + x) );
+        d = _mm_loadu_si128( (const __m128i *)(dst + x) );
+        lo = blend_argb_epu16( _mm_unpacklo_epi8( d, zero ), _mm_unpacklo_epi8( s, zero ) );
+        hi = blend_argb_epu16( _mm_unpackhi_epi8( d, zero ), _mm_unpackhi_epi8( s, zero ) );
+        _mm_storeu_si128( (__m128i *)(dst + x), pack_sum_epu16( lo, hi ) );
+    }
+    return x;
+}
+
+static SSE2 int blend_argb_alpha_sse2( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha16 = _mm_set1_epi16( alpha );
+    __m128i s, d, lo, hi;
+    int x;
+
+    for (x = 0; x + 4 <= len; x += 4)
+    {
+        s = _mm_loadu_si128( (const __m128i *)(src + x) );
+        d = _mm_loadu_si128( (const __m128i *)(dst + x) );
+        lo = div255_epu16( _mm_mullo_epi16( _mm_unpacklo_epi8( s, zero ), alpha16 ) );
+        hi = div255_epu16( _mm_mullo_epi16( _mm_unpackhi_epi8( s, zero ), alpha16 ) );
+        lo = blend_argb_epu16( _mm_unpacklo_epi8( d, zero ), lo );
+        hi = blend_argb_epu16( _mm_unpackhi_epi8( d, zero ), hi );
+        _mm_storeu_si128( (__m128i *)(dst + x), pack_sum_epu16( lo, hi ) );
+    }
+    return x;
+}
+
+/* (src * alpha + dst * (255 - alpha) + 127) / 255, per channel */
+static inline SSE2 __m128i blend_constant_epu16( __m128i dst, __m128i src, __m128i alpha, __m128i inv_alpha )
+{
+    return div255_epu16( _mm_add_epi16( _mm_mullo_epi16( src, alpha ), _mm_mullo_epi16( dst, inv_alpha ) ) );
+}
+
+static SSE2 int blend_constant_alpha_rows( DWORD *dst, const DWORD *src, int len, DWORD alpha, DWORD src_or )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha16 = _mm_set1_epi16( alpha );
+    const __m128i inv_alpha16 = _mm_set1_epi16( 255 - alpha );
+    const __m128i or_mask = _mm_set1_epi32( src_or );
+    __m128i s, d, lo, hi;
+    int x;
+
+    for (x = 0; x + 4 <= len; x += 4)
+    {
+        s = _mm_or_si128( _mm_loadu_si128( (const __m128i *)(src + x) ), or_mask );
+        d = _mm_loadu_si128( (const __m128i *)(dst + x) );
+        lo = blend_constant_epu16( _mm_unpacklo_epi8( d, zero ), _mm_unpacklo_epi8( s, zero ),
+                                   alpha16, inv_alpha16 );
+        hi = blend_constant_epu16( _mm_unpackhi_epi8( d, zero ), _mm_unpackhi_epi8( s, zero ),
+                                   alpha16, inv_alpha16 );
+        _mm_storeu_si128( (__m128i *)(dst + x), _mm_packus_epi16( lo, hi ) );
+    }
+    return x;
+}
+
+static SSE2 int blend_argb_constant_alpha_sse2( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    return blend_constant_alpha_rows( dst, src, len, alpha, 0 );
+}
+
+static SSE2 int blend_argb_no_src_alpha_sse2( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    return blend_constant_alpha_rows( dst, src, len, alpha, 0xff000000 );
+}
+
+/* expand 5-bit channels to 8 bits by replicating the top bits */
+static inline SSE2 __m128i expand_5_to_8_epu16( __m128i x )
+{
+    return _mm_or_si128( _mm_slli_epi16( x, 3 ), _mm_srli_epi16( x, 2 ) );
+}
+
+static SSE2 int convert_555_to_8888_sse2( DWORD *dst, const WORD *src, int len )
+{
+    const __m128i mask = _mm_set1_epi16( 0x1f );
+    __m128i v, r, g, b, gb;
+    int x;
+
+    for (x = 0; x + 8 <= len; x += 8)
+    {
+        v = _mm_loadu_si128( (const __m128i *)(src + x) );
+        b = expand_5_to_8_epu16( _mm_and_si128( v, mask ) );
+        g = expand_5_to_8_epu16( _mm_and_si128( _mm_srli_epi16( v, 5 ), mask ) );
+        r = expand_5_to_8_epu16( _mm_and_si128( _mm_srli_epi16( v, 10 ), mask ) );
+        gb = _mm_or_si128( b, _mm_slli_epi16( g, 8 ) );
+        _mm_storeu_si128( (__m128i *)(dst + x), _mm_unpacklo_epi16( gb, r ) );
+        _mm_storeu_si128( (__m128i *)(dst + x + 4), _mm_unpackhi_epi16( gb, r ) );
+    }
+    return x;
+}
+
+static inline SSE2 __m128i pixel_8888_to_555_epi32( __m128i v )
+{
+    return _mm_or_si128( _mm_or_si128( _mm_and_si128( _mm_srli_epi32( v, 9 ), _mm_set1_epi32( 0x7c00 ) ),
+                                       _mm_and_si128( _mm_srli_epi32( v, 6 ), _mm_set1_epi32( 0x03e0 ) ) ),
+                         _mm_and_si128( _mm_srli_epi32( v, 3 ), _mm_set1_epi32( 0x001f ) ) );
+}
+
+static SSE2 int convert_8888_to_555_sse2( WORD *dst, const DWORD *src, int len )
+{
+    __m128i lo, hi;
+    int x;
+
+    for (x = 0; x + 8 <= len; x += 8)
+    {
+        lo = pixel_8888_to_555_epi32( _mm_loadu_si128( (const __m128i *)(src + x) ) );
+        hi = pixel_8888_to_555_epi32( _mm_loadu_si128( (const __m128i *)(src + x + 4) ) );
+        /* values fit in 15 bits, so signed saturation doesn't kick in */
+        _mm_storeu_si128( (__m128i *)(dst + x), _mm_packs_epi32( lo, hi ) );
+    }
+    return x;
+}
+
+static const row_funcs row_funcs_sse2 =
+{
+    blend_argb_sse2,
+    blend_argb_alpha_sse2,
+    blend_argb_constant_alpha_sse2,
+    blend_argb_no_src_alpha_sse2,
+    convert_555_to_8888_sse2,
+    convert_8888_to_555_sse2
+};
+
+const row_funcs *get_row_funcs_sse2(void)
+{
+    if (!IsProcessorFeaturePresent( PF_XMMI64_INSTRUCTIONS_AVAILABLE )) return NULL;
+    TRACE( "using SSE2 row primitives\n" );
+    return &row_funcs_sse2;
+}
+
+#else  /* (__i386__ || __x86_64__) && target attribute support */
+
+const row_funcs *get_row_funcs_sse2(void)
+{
+    return NULL;
+}
+
+#endif
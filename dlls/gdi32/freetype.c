@@ -300,6 +300,8 @@ typedef struct tagFace {
 
 typedef struct tagFamily {
     struct list entry;
+    struct list name_entry;     /* entry in family_name_hash */
+    struct list english_entry;  /* entry in family_english_hash */
     unsigned int refcount;
     WCHAR *FamilyName;
     WCHAR *EnglishName;
@@ -462,6 +464,28 @@ struct enum_charset_list {
 #define GM_BLOCK_SIZE 128
 #define FONT_GM(font,idx) (&(font)->gm[(idx) / GM_BLOCK_SIZE][(idx) % GM_BLOCK_SIZE])
 
+/* Rendered glyph bitmaps, shared by all fonts with the same description so that
+ * they survive the GdiFont being released and recreated. Entries are evicted in
+ * LRU order once glyph_cache_max_size bytes are in use. */
+struct glyph_bitmap
+{
+    struct list entry;       /* entry in glyph_cache_lru */
+    struct list hash_entry;  /* entry in glyph_cache_hash */
+    FONT_DESC font_desc;
+    UINT glyph;
+    UINT format;             /* GGO_* format, including GGO_GLYPH_INDEX and GGO_UNHINTED */
+    GLYPHMETRICS gm;
+    DWORD size;
+    BYTE bits[1];
+};
+
+#define GLYPH_CACHE_HASH_SIZE 4096
+static struct list glyph_cache_lru = LIST_INIT(glyph_cache_lru);
+static struct list glyph_cache_hash[GLYPH_CACHE_HASH_SIZE];
+static SIZE_T glyph_cache_size;
+static SIZE_T glyph_cache_max_size = 4 * 1024 * 1024;
+static ULONGLONG glyph_cache_hits, glyph_cache_misses;
+
 static struct list gdi_font_list = LIST_INIT(gdi_font_list);
 static struct list unused_gdi_font_list = LIST_INIT(unused_gdi_font_list);
 static unsigned int unused_font_count;
@@ -472,6 +496,63 @@ static struct list font_subst_list = LIST_INIT(font_subst_list);
 
 static struct list font_list = LIST_INIT(font_list);
 
+/* families hashed by their (English) name, so that lookups don't have to walk font_list */
+#define FAMILY_HASH_SIZE 1024
+static struct list family_name_hash[FAMILY_HASH_SIZE];
+static struct list family_english_hash[FAMILY_HASH_SIZE];
+
+/* The font index is a snapshot of the font cache stored in a named section, built by the
+ * first process that scans the font directories and mapped by every later one, so that
+ * they don't have to walk the registry cache key by key. Only fixed-size types are used
+ * so that 32-bit and 64-bit processes share the same layout. The name of the current
+ * section is stored in the font cache key, and removed when the cache changes; the next
+ * process that loads the cache then builds a new section. Families are stored in the
+ * order of the registry cache keys. */
+#define FONT_INDEX_MAGIC   0x58444e49  /* "INDX" */
+#define FONT_INDEX_VERSION 2
+
+struct font_index_header
+{
+    DWORD magic;
+    DWORD version;
+    DWORD size;
+    DWORD family_count;
+    DWORD face_count;
+    DWORD families;       /* offset of the font_index_family array */
+    DWORD faces;          /* offset of the font_index_face array */
+};
+
+struct font_index_family
+{
+    DWORD name;           /* string offsets, 0 if not present */
+    DWORD english_name;
+    DWORD first_face;
+    DWORD face_count;
+};
+
+struct font_index_face
+{
+    ULONGLONG dev;
+    ULONGLONG ino;
+    DWORD style_name;
+    DWORD full_name;
+    DWORD file;
+    LONG  face_index;
+    DWORD ntm_flags;
+    LONG  font_version;
+    DWORD flags;
+    FONTSIGNATURE fs;
+    BOOL  scalable;
+    LONG  height;
+    LONG  width;
+    LONG  size;
+    LONG  x_ppem;
+    LONG  y_ppem;
+    LONG  internal_leading;
+};
+
+static HANDLE font_index_mapping;
+
 struct freetype_physdev
 {
     struct gdi_physdev dev;
@@ -576,6 +657,7 @@ static const WCHAR wine_fonts_key[] = {'S','o','f','t','w','a','r','e','\\','W',
                                        'F','o','n','t','s',0};
 static const WCHAR wine_fonts_cache_key[] = {'C','a','c','h','e',0};
 static const WCHAR english_name_value[] = {'E','n','g','l','i','s','h',' ','N','a','m','e',0};
+static const WCHAR font_index_value[] = {'I','n','d','e','x',0};
 static const WCHAR face_index_value[] = {'I','n','d','e','x',0};
 static const WCHAR face_ntmflags_value[] = {'N','t','m','f','l','a','g','s',0};
 static const WCHAR face_version_value[] = {'V','e','r','s','i','o','n',0};
@@ -617,6 +699,7 @@ static CRITICAL_SECTION_DEBUG critsect_debug =
 static CRITICAL_SECTION freetype_cs = { &critsect_debug, -1, 0, 0, 0, 0 };
 
 static const WCHAR font_mutex_nameW[] = {'_','_','W','I','N','E','_','F','O','N','T','_','M','U','T','E','X','_','_','\0'};
+static const WCHAR font_index_nameW[] = {'_','_','W','I','N','E','_','F','O','N','T','_','I','N','D','E','X','_','%','0','8','x','_','_','\0'};
 
 static const WCHAR szDefaultFallbackLink[] = {'M','i','c','r','o','s','o','f','t',' ','S','a','n','s',' ','S','e','r','i','f',0};
 static BOOL use_default_fallback = FALSE;
@@ -1060,32 +1143,69 @@ static Face *find_face_from_filename(const WCHAR *file_name, const WCHAR *face_n
     return NULL;
 }
 
+/* names are compared with strncmpiW( ..., LF_FACESIZE - 1 ), so hash the same prefix */
+static unsigned int hash_family_name( const WCHAR *name )
+{
+    unsigned int i, hash = 0;
+
+    for (i = 0; i < LF_FACESIZE - 1 && name[i]; i++)
+        hash = hash * 31 + tolowerW( name[i] );
+    return hash;
+}
+
+static struct list *get_family_hash_bucket( struct list *table, const WCHAR *name )
+{
+    struct list *bucket = &table[hash_family_name( name ) % FAMILY_HASH_SIZE];
+
+    if (!bucket->next) list_init( bucket );
+    return bucket;
+}
+
+static void add_family_to_hash( Family *family )
+{
+    list_add_tail( get_family_hash_bucket( family_name_hash, family->FamilyName ), &family->name_entry );
+    if (family->EnglishName)
+        list_add_tail( get_family_hash_bucket( family_english_hash, family->EnglishName ), &family->english_entry );
+    else
+        list_init( &family->english_entry );
+}
+
+/* the hash buckets don't keep the font_list order, so check it when several families match */
+static BOOL family_is_before( const Family *family, const Family *other )
+{
+    const struct list *ptr;
+
+    for (ptr = list_next( &font_list, &family->entry ); ptr; ptr = list_next( &font_list, ptr ))
+        if (ptr == &other->entry) return TRUE;
+    return FALSE;
+}
+
 static Family *find_family_from_name(const WCHAR *name)
 {
-    Family *family;
+    Family *family, *ret = NULL;
 
-    LIST_FOR_EACH_ENTRY(family, &font_list, Family, entry)
+    LIST_FOR_EACH_ENTRY(family, get_family_hash_bucket( family_name_hash, name ), Family, name_entry)
     {
-        if(!strncmpiW(family->FamilyName, name, LF_FACESIZE -1))
-            return family;
+        if(!strncmpiW(family->FamilyName, name, LF_FACESIZE -1) &&
+           (!ret || family_is_before( family, ret )))
+            ret = family;
     }
 
-    return NULL;
+    return ret;
 }
 
 static Family *find_family_from_any_name(const WCHAR *name)
 {
-    Family *family;
+    Family *family, *ret = find_family_from_name( name );
 
-    LIST_FOR_EACH_ENTRY(family, &font_list, Family, entry)
+    LIST_FOR_EACH_ENTRY(family, get_family_hash_bucket( family_english_hash, name ), Family, english_entry)
     {
-        if(!strncmpiW(family->FamilyName, name, LF_FACESIZE - 1))
-            return family;
-        if(family->EnglishName && !strncmpiW(family->EnglishName, name, LF_FACESIZE - 1))
-            return family;
+        if(!strncmpiW(family->EnglishName, name, LF_FACESIZE - 1) &&
+           (!ret || (family != ret && family_is_before( family, ret ))))
+            ret = family;
     }
 
-    return NULL;
+    return ret;
 }
 
 static void DumpSubstList(void)
@@ -1495,6 +1615,8 @@ static void release_family( Family *family )
     if (--family->refcount) return;
     assert( list_empty( &family->faces ));
     list_remove( &family->entry );
+    list_remove( &family->name_entry );
+    list_remove( &family->english_entry );
     HeapFree( GetProcessHeap(), 0, family->FamilyName );
     HeapFree( GetProcessHeap(), 0, family->EnglishName );
     HeapFree( GetProcessHeap(), 0, family );
@@ -1600,6 +1722,7 @@ static Family *create_family( WCHAR *name, WCHAR *english_name )
     list_init( &family->faces );
     family->replacement = &family->faces;
     list_add_tail( &font_list, &family->entry );
+    add_family_to_hash( family );
 
     return family;
 }
@@ -1747,6 +1870,16 @@ static void reorder_vertical_fonts(void)
     list_move_tail( &font_list, &vertical_families );
 }
 
+static void add_english_name_subst(const WCHAR *english_name, const WCHAR *name)
+{
+    FontSubst *subst = HeapAlloc(GetProcessHeap(), 0, sizeof(*subst));
+    subst->from.name = strdupW(english_name);
+    subst->from.charset = -1;
+    subst->to.name = strdupW(name);
+    subst->to.charset = -1;
+    add_font_subst(&font_subst_list, subst, 0);
+}
+
 static void load_font_list_from_cache(HKEY hkey_font_cache)
 {
     DWORD size, family_index = 0;
@@ -1770,14 +1903,7 @@ static void load_font_list_from_cache(HKEY hkey_font_cache)
         family = create_family(family_name, english_family);
 
         if(english_family)
-        {
-            FontSubst *subst = HeapAlloc(GetProcessHeap(), 0, sizeof(*subst));
-            subst->from.name = strdupW(english_family);
-            subst->from.charset = -1;
-            subst->to.name = strdupW(family_name);
-            subst->to.charset = -1;
-            add_font_subst(&font_subst_list, subst, 0);
-        }
+            add_english_name_subst(english_family, family_name);
 
         size = sizeof(buffer);
         while (!RegEnumKeyExW(hkey_family, face_index++, buffer, &size, NULL, NULL, NULL, NULL))
@@ -1821,11 +1947,18 @@ static LONG create_font_cache_key(HKEY *hkey, DWORD *disposition)
     return ret;
 }
 
+static void invalidate_font_index(void)
+{
+    RegDeleteValueW( hkey_font_cache, font_index_value );
+}
+
 static void add_face_to_cache(Face *face)
 {
     HKEY hkey_family, hkey_face;
     WCHAR *face_key_name;
 
+    invalidate_font_index();
+
     RegCreateKeyExW(hkey_font_cache, face->family->FamilyName, 0,
                     NULL, REG_OPTION_VOLATILE, KEY_ALL_ACCESS, NULL, &hkey_family, NULL);
     if(face->family->EnglishName)
@@ -1875,6 +2008,8 @@ static void remove_face_from_cache( Face *face )
 {
     HKEY hkey_family;
 
+    invalidate_font_index();
+
     RegOpenKeyExW( hkey_font_cache, face->family->FamilyName, 0, KEY_ALL_ACCESS, &hkey_family );
 
     if (face->scalable)
@@ -1892,6 +2027,303 @@ static void remove_face_from_cache( Face *face )
     RegCloseKey(hkey_family);
 }
 
+static inline DWORD font_index_string_size( const WCHAR *str )
+{
+    return str ? (strlenW( str ) + 1) * sizeof(WCHAR) : 0;
+}
+
+static DWORD font_index_add_string( struct font_index_header *header, DWORD *pos, const WCHAR *str )
+{
+    DWORD offset = *pos, size = font_index_string_size( str );
+
+    if (!size) return 0;
+    memcpy( (char *)header + offset, str, size );
+    *pos += size;
+    return offset;
+}
+
+static inline const WCHAR *font_index_string( const struct font_index_header *header, DWORD offset )
+{
+    return offset ? (const WCHAR *)((const char *)header + offset) : NULL;
+}
+
+static int compare_font_index_families( const void *a, const void *b )
+{
+    const Family *family_a = *(const Family * const *)a, *family_b = *(const Family * const *)b;
+
+    return strcmpiW( family_a->FamilyName, family_b->FamilyName );
+}
+
+/* store the cached faces of font_list in a named section shared with later processes */
+static void create_font_index(void)
+{
+    struct font_index_header *header;
+    struct font_index_family *index_family;
+    struct font_index_face *index_face;
+    DWORD family_count = 0, face_count = 0, strings_size = 0, count, size, pos, id, i;
+    WCHAR name[sizeof(font_index_nameW) / sizeof(WCHAR) + 8];
+    Family **families;
+    HANDLE mapping;
+    Family *family;
+    Face *face;
+
+    LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry )
+    {
+        count = 0;
+        LIST_FOR_EACH_ENTRY( face, &family->faces, Face, entry )
+        {
+            if (!(face->flags & ADDFONT_ADD_TO_CACHE)) continue;
+            strings_size += font_index_string_size( face->StyleName );
+            strings_size += font_index_string_size( face->FullName );
+            strings_size += font_index_string_size( face->file );
+            count++;
+        }
+        if (!count) continue;
+        strings_size += font_index_string_size( family->FamilyName );
+        strings_size += font_index_string_size( family->EnglishName );
+        family_count++;
+        face_count += count;
+    }
+
+    pos = (sizeof(*header) + family_count * sizeof(*index_family) + 7) & ~7;
+    size = pos + face_count * sizeof(*index_face) + strings_size;
+
+    /* the registry returns the family keys sorted, do the same so that
+     * reorder_vertical_fonts() gives the same result on both paths */
+    if (!(families = HeapAlloc( GetProcessHeap(), 0, family_count * sizeof(*families) + 1 ))) return;
+    count = 0;
+    LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry )
+    {
+        LIST_FOR_EACH_ENTRY( face, &family->faces, Face, entry )
+        {
+            if (!(face->flags & ADDFONT_ADD_TO_CACHE)) continue;
+            families[count++] = family;
+            break;
+        }
+    }
+    qsort( families, family_count, sizeof(*families), compare_font_index_families );
+
+    /* sections of stale indexes live on while a process has them open, so use a new name */
+    id = GetTickCount() ^ (GetCurrentProcessId() << 16);
+    for (i = 0; i < 16; i++, id++)
+    {
+        sprintfW( name, font_index_nameW, id );
+        mapping = CreateFileMappingW( INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, size, name );
+        if (!mapping || GetLastError() != ERROR_ALREADY_EXISTS) break;
+        CloseHandle( mapping );
+        mapping = 0;
+    }
+    if (!mapping || !(header = MapViewOfFile( mapping, FILE_MAP_WRITE, 0, 0, 0 )))
+    {
+        if (mapping) CloseHandle( mapping );
+        HeapFree( GetProcessHeap(), 0, families );
+        return;
+    }
+
+    header->magic = FONT_INDEX_MAGIC;
+    header->version = FONT_INDEX_VERSION;
+    header->size = size;
+    header->family_count = family_count;
+    header->face_count = face_count;
+    header->families = sizeof(*header);
+    header->faces = pos;
+
+    index_family = (struct font_index_family *)((char *)header + header->families);
+    index_face = (struct font_index_face *)((char *)header + header->faces);
+    pos += face_count * sizeof(*index_face);
+    face_count = 0;
+
+    for (i = 0; i < family_count; i++)
+    {
+        family = families[i];
+        index_family->first_face = face_count;
+        LIST_FOR_EACH_ENTRY( face, &family->faces, Face, entry )
+        {
+            if (!(face->flags & ADDFONT_ADD_TO_CACHE)) continue;
+            index_face->dev = face->dev;
+            index_face->ino = face->ino;
+            index_face->style_name = font_index_add_string( header, &pos, face->StyleName );
+            index_face->full_name = font_index_add_string( header, &pos, face->FullName );
+            index_face->file = font_index_add_string( header, &pos, face->file );
+            index_face->face_index = face->face_index;
+            index_face->ntm_flags = face->ntmFlags;
+            index_face->font_version = face->font_version;
+            index_face->flags = face->flags;
+            index_face->fs = face->fs;
+            index_face->scalable = face->scalable;
+            index_face->height = face->size.height;
+            index_face->width = face->size.width;
+            index_face->size = face->size.size;
+            index_face->x_ppem = face->size.x_ppem;
+            index_face->y_ppem = face->size.y_ppem;
+            index_face->internal_leading = face->size.internal_leading;
+            index_face++;
+            face_count++;
+        }
+        index_family->face_count = face_count - index_family->first_face;
+        index_family->name = font_index_add_string( header, &pos, family->FamilyName );
+        index_family->english_name = font_index_add_string( header, &pos, family->EnglishName );
+        index_family++;
+    }
+
+    UnmapViewOfFile( header );
+    HeapFree( GetProcessHeap(), 0, families );
+
+    /* keep the section alive for later processes */
+    if (font_index_mapping) CloseHandle( font_index_mapping );
+    font_index_mapping = mapping;
+    RegSetValueExW( hkey_font_cache, font_index_value, 0, REG_DWORD, (BYTE *)&id, sizeof(id) );
+    TRACE( "created font index %s with %u families, %u faces, %u bytes\n",
+           debugstr_w(name), family_count, face_count, size );
+}
+
+static BOOL check_font_index_string( const struct font_index_header *header, DWORD offset, BOOL optional )
+{
+    const WCHAR *str;
+    DWORD i, len;
+
+    if (!offset) return optional;
+    if (offset < sizeof(*header) || offset >= header->size || (offset & 1)) return FALSE;
+    str = (const WCHAR *)((const char *)header + offset);
+    len = (header->size - offset) / sizeof(WCHAR);
+    for (i = 0; i < len; i++) if (!str[i]) return TRUE;
+    return FALSE;
+}
+
+/* the section may have been written by anyone, make sure that it stays within its bounds */
+static BOOL check_font_index( const struct font_index_header *header, SIZE_T view_size )
+{
+    const struct font_index_family *index_family;
+    const struct font_index_face *index_face;
+    DWORD i;
+
+    if (view_size < sizeof(*header)) return FALSE;
+    if (header->magic != FONT_INDEX_MAGIC || header->version != FONT_INDEX_VERSION) return FALSE;
+    if (header->size < sizeof(*header) || header->size > view_size) return FALSE;
+    if (header->families < sizeof(*header) || header->families > header->size || (header->families & 3) ||
+        header->family_count > (header->size - header->families) / sizeof(*index_family))
+        return FALSE;
+    if (header->faces < sizeof(*header) || header->faces > header->size || (header->faces & 7) ||
+        header->face_count > (header->size - header->faces) / sizeof(*index_face))
+        return FALSE;
+
+    index_family = (const struct font_index_family *)((const char *)header + header->families);
+    for (i = 0; i < header->family_count; i++, index_family++)
+    {
+        if (!check_font_index_string( header, index_family->name, FALSE ) ||
+            !check_font_index_string( header, index_family->english_name, TRUE ))
+            return FALSE;
+        if (index_family->first_face > header->face_count ||
+            index_family->face_count > header->face_count - index_family->first_face)
+            return FALSE;
+    }
+
+    index_face = (const struct font_index_face *)((const char *)header + header->faces);
+    for (i = 0; i < header->face_count; i++, index_face++)
+    {
+        if (!check_font_index_string( header, index_face->style_name, FALSE ) ||
+            !check_font_index_string( header, index_face->full_name, TRUE ) ||
+            !check_font_index_string( header, index_face->file, FALSE ))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static void load_face_from_index( const struct font_index_header *header,
+                                  const struct font_index_face *index_face, Family *family )
+{
+    const WCHAR *full_name = font_index_string( header, index_face->full_name );
+    Face *face = HeapAlloc( GetProcessHeap(), 0, sizeof(*face) );
+
+    face->cached_enum_data = NULL;
+    face->family = NULL;
+    face->refcount = 1;
+    face->file = strdupW( font_index_string( header, index_face->file ));
+    face->StyleName = strdupW( font_index_string( header, index_face->style_name ));
+    face->FullName = full_name ? strdupW( full_name ) : NULL;
+    face->dev = index_face->dev;
+    face->ino = index_face->ino;
+    face->font_data_ptr = NULL;
+    face->font_data_size = 0;
+    face->face_index = index_face->face_index;
+    face->ntmFlags = index_face->ntm_flags;
+    face->font_version = index_face->font_version;
+    face->flags = index_face->flags;
+    face->fs = index_face->fs;
+    face->scalable = index_face->scalable;
+    face->size.height = index_face->height;
+    face->size.width = index_face->width;
+    face->size.size = index_face->size;
+    face->size.x_ppem = index_face->x_ppem;
+    face->size.y_ppem = index_face->y_ppem;
+    face->size.internal_leading = index_face->internal_leading;
+
+    if (insert_face_in_family_list( face, family ))
+        TRACE( "Added font %s %s\n", debugstr_w(family->FamilyName), debugstr_w(face->StyleName) );
+
+    release_face( face );
+}
+
+static BOOL load_font_list_from_index(void)
+{
+    const struct font_index_family *index_family;
+    const struct font_index_face *index_face;
+    const struct font_index_header *header;
+    MEMORY_BASIC_INFORMATION info;
+    WCHAR name[sizeof(font_index_nameW) / sizeof(WCHAR) + 8];
+    HANDLE mapping;
+    Family *family;
+    DWORD i, j, id;
+
+    if (reg_load_dword( hkey_font_cache, font_index_value, &id ))
+    {
+        TRACE( "no font index, or out of date\n" );
+        return FALSE;
+    }
+    sprintfW( name, font_index_nameW, id );
+    if (!(mapping = OpenFileMappingW( FILE_MAP_READ, FALSE, name ))) return FALSE;
+    if (!(header = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 )))
+    {
+        CloseHandle( mapping );
+        return FALSE;
+    }
+    if (!VirtualQuery( header, &info, sizeof(info) ) || !check_font_index( header, info.RegionSize ))
+    {
+        WARN( "invalid font index %s\n", debugstr_w(name) );
+        UnmapViewOfFile( header );
+        CloseHandle( mapping );
+        return FALSE;
+    }
+
+    index_family = (const struct font_index_family *)((const char *)header + header->families);
+    index_face = (const struct font_index_face *)((const char *)header + header->faces);
+
+    for (i = 0; i < header->family_count; i++, index_family++)
+    {
+        WCHAR *family_name = strdupW( font_index_string( header, index_family->name ));
+        WCHAR *english_family = NULL;
+
+        if (index_family->english_name)
+            english_family = strdupW( font_index_string( header, index_family->english_name ));
+
+        family = create_family( family_name, english_family );
+        if (english_family)
+            add_english_name_subst( english_family, family_name );
+
+        for (j = 0; j < index_family->face_count; j++)
+            load_face_from_index( header, index_face + index_family->first_face + j, family );
+
+        release_family( family );
+    }
+
+    reorder_vertical_fonts();
+
+    /* everything has been copied, only keep the section alive for later processes */
+    UnmapViewOfFile( header );
+    font_index_mapping = mapping;
+    return TRUE;
+}
+
 static WCHAR *prepend_at(WCHAR *family)
 {
     WCHAR *str;
@@ -2377,6 +2809,7 @@ static BOOL map_font_family(const WCHAR *orig, const WCHAR *repl)
             list_init(&new_family->faces);
             new_family->replacement = &family->faces;
             list_add_tail(&font_list, &new_family->entry);
+            add_family_to_hash(new_family);
             return TRUE;
         }
     }
@@ -3285,6 +3718,23 @@ static void delete_external_font_keys(void)
     if(winnt_key) RegCloseKey(winnt_key);
 }
 
+static void free_glyph_bitmap( struct glyph_bitmap *bitmap )
+{
+    list_remove( &bitmap->entry );
+    list_remove( &bitmap->hash_entry );
+    glyph_cache_size -= FIELD_OFFSET( struct glyph_bitmap, bits[bitmap->size] );
+    HeapFree( GetProcessHeap(), 0, bitmap );
+}
+
+/* font resources changed, so a font description may now map to a different face */
+static void flush_glyph_cache(void)
+{
+    struct glyph_bitmap *bitmap, *next;
+
+    LIST_FOR_EACH_ENTRY_SAFE( bitmap, next, &glyph_cache_lru, struct glyph_bitmap, entry )
+        free_glyph_bitmap( bitmap );
+}
+
 /*************************************************************
  *    WineEngAddFontResourceEx
  *
@@ -3318,6 +3768,7 @@ INT WineEngAddFontResourceEx(LPCWSTR file, DWORD flags, PVOID pdv)
             }
         }
 
+        if (ret) flush_glyph_cache();
         LeaveCriticalSection( &freetype_cs );
     }
     return ret;
@@ -3341,6 +3792,7 @@ HANDLE WineEngAddFontMemResourceEx(PVOID pbFont, DWORD cbFont, PVOID pdv, DWORD
 
         EnterCriticalSection( &freetype_cs );
         *pcFonts = AddFontToList(NULL, pFontCopy, cbFont, ADDFONT_ALLOW_BITMAP | ADDFONT_ADD_RESOURCE);
+        if (*pcFonts) flush_glyph_cache();
         LeaveCriticalSection( &freetype_cs );
 
         if (*pcFonts == 0)
@@ -3392,6 +3844,7 @@ BOOL WineEngRemoveFontResourceEx(LPCWSTR file, DWORD flags, PVOID pdv)
             }
         }
 
+        if (ret) flush_glyph_cache();
         LeaveCriticalSection( &freetype_cs );
     }
     return ret;
@@ -4376,7 +4829,7 @@ static void reorder_font_list(void)
 static DWORD WINAPI freetype_lazy_init(RTL_RUN_ONCE *once, void *param, void **context)
 {
     HKEY hkey;
-    DWORD disposition;
+    DWORD disposition, start;
     HANDLE font_mutex;
 
     if(!init_freetype()) return TRUE;
@@ -4389,8 +4842,9 @@ static DWORD WINAPI freetype_lazy_init(RTL_RUN_ONCE *once, void *param, void **c
     {
         static const WCHAR antialias_fake_bold_or_italic[] = { 'A','n','t','i','a','l','i','a','s','F','a','k','e',
                                                                'B','o','l','d','O','r','I','t','a','l','i','c',0 };
+        static const WCHAR glyph_cache_sizeW[] = { 'G','l','y','p','h','C','a','c','h','e','S','i','z','e',0 };
         static const WCHAR true_options[] = { 'y','Y','t','T','1',0 };
-        DWORD type, size;
+        DWORD type, size, cache_size;
         WCHAR buffer[20];
 
         size = sizeof(buffer);
@@ -4399,6 +4853,12 @@ static DWORD WINAPI freetype_lazy_init(RTL_RUN_ONCE *once, void *param, void **c
         {
             antialias_fakes = (strchrW(true_options, buffer[0]) != NULL);
         }
+        /* glyph bitmap cache budget in KB, 0 disables the cache */
+        if (!reg_load_dword(hkey, glyph_cache_sizeW, &cache_size))
+        {
+            glyph_cache_max_size = (SIZE_T)cache_size * 1024;
+            TRACE("glyph cache size %lu\n", glyph_cache_max_size);
+        }
         RegCloseKey(hkey);
     }
 
@@ -4411,10 +4871,18 @@ static DWORD WINAPI freetype_lazy_init(RTL_RUN_ONCE *once, void *param, void **c
 
     create_font_cache_key(&hkey_font_cache, &disposition);
 
+    start = GetTickCount();
     if(disposition == REG_CREATED_NEW_KEY)
+    {
         init_font_list();
-    else
+        create_font_index();
+    }
+    else if(!load_font_list_from_index())
+    {
         load_font_list_from_cache(hkey_font_cache);
+        create_font_index();
+    }
+    TRACE("font list loaded in %u ms\n", GetTickCount() - start);
 
     reorder_font_list();
 
@@ -8242,6 +8710,113 @@ end:
     return ret;
 }
 
+static inline BOOL is_glyph_bitmap_format( UINT format )
+{
+    switch (format & ~(GGO_GLYPH_INDEX | GGO_UNHINTED))
+    {
+    case GGO_BITMAP:
+    case GGO_GRAY2_BITMAP:
+    case GGO_GRAY4_BITMAP:
+    case GGO_GRAY8_BITMAP:
+    case WINE_GGO_GRAY16_BITMAP:
+    case WINE_GGO_HRGB_BITMAP:
+    case WINE_GGO_HBGR_BITMAP:
+    case WINE_GGO_VRGB_BITMAP:
+    case WINE_GGO_VBGR_BITMAP:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+static struct list *get_glyph_cache_bucket( const FONT_DESC *font_desc, UINT glyph, UINT format )
+{
+    struct list *bucket = &glyph_cache_hash[(font_desc->hash ^ (glyph * 0x9e3779b1) ^ format) % GLYPH_CACHE_HASH_SIZE];
+
+    if (!bucket->next) list_init( bucket );
+    return bucket;
+}
+
+static struct glyph_bitmap *find_glyph_bitmap( GdiFont *font, UINT glyph, UINT format )
+{
+    struct glyph_bitmap *bitmap;
+
+    LIST_FOR_EACH_ENTRY( bitmap, get_glyph_cache_bucket( &font->font_desc, glyph, format ),
+                         struct glyph_bitmap, hash_entry )
+    {
+        if (bitmap->glyph != glyph || bitmap->format != format) continue;
+        if (fontcmp( font, &bitmap->font_desc )) continue;
+        list_remove( &bitmap->entry );
+        list_add_head( &glyph_cache_lru, &bitmap->entry );
+        return bitmap;
+    }
+    return NULL;
+}
+
+static struct glyph_bitmap *add_glyph_bitmap( GdiFont *font, UINT glyph, UINT format, DWORD size )
+{
+    SIZE_T alloc_size = FIELD_OFFSET( struct glyph_bitmap, bits[size] );
+    struct glyph_bitmap *bitmap;
+
+    if (alloc_size > glyph_cache_max_size / 4) return NULL;
+
+    while (glyph_cache_size + alloc_size > glyph_cache_max_size)
+        free_glyph_bitmap( LIST_ENTRY( list_tail( &glyph_cache_lru ), struct glyph_bitmap, entry ));
+
+    if (!(bitmap = HeapAlloc( GetProcessHeap(), 0, alloc_size ))) return NULL;
+    bitmap->font_desc = font->font_desc;
+    bitmap->glyph = glyph;
+    bitmap->format = format;
+    bitmap->size = size;
+    list_add_head( &glyph_cache_lru, &bitmap->entry );
+    list_add_head( get_glyph_cache_bucket( &font->font_desc, glyph, format ), &bitmap->hash_entry );
+    glyph_cache_size += alloc_size;
+    return bitmap;
+}
+
+/* glyph bitmaps are requested twice by the drivers, once for the size and once for the
+ * bits, so render into the cache on the first request and serve both from there */
+static DWORD get_cached_glyph_bitmap( GdiFont *font, UINT glyph, UINT format, LPGLYPHMETRICS lpgm,
+                                      DWORD buflen, LPVOID buf, const MAT2 *lpmat )
+{
+    struct glyph_bitmap *bitmap;
+    GLYPHMETRICS gm;
+    DWORD needed;
+    ABC abc;
+
+    if ((bitmap = find_glyph_bitmap( font, glyph, format )))
+        glyph_cache_hits++;
+    else
+    {
+        glyph_cache_misses++;
+        needed = get_glyph_outline( font, glyph, format, &gm, &abc, 0, NULL, lpmat );
+        if (needed == GDI_ERROR) return GDI_ERROR;
+        if (!(bitmap = add_glyph_bitmap( font, glyph, format, needed )))
+            return get_glyph_outline( font, glyph, format, lpgm, &abc, buflen, buf, lpmat );
+        bitmap->gm = gm;
+        if (needed && get_glyph_outline( font, glyph, format, &bitmap->gm, &abc,
+                                         needed, bitmap->bits, lpmat ) == GDI_ERROR)
+        {
+            free_glyph_bitmap( bitmap );
+            return get_glyph_outline( font, glyph, format, lpgm, &abc, buflen, buf, lpmat );
+        }
+    }
+
+    if (!((glyph_cache_hits + glyph_cache_misses) % 4096))
+        TRACE( "glyph cache: %s hits, %s misses, %lu bytes\n", wine_dbgstr_longlong( glyph_cache_hits ),
+               wine_dbgstr_longlong( glyph_cache_misses ), glyph_cache_size );
+
+    /* same results as get_glyph_outline() for empty glyphs and short buffers */
+    if (buf && buflen)
+    {
+        if (!bitmap->size || bitmap->size > buflen) return GDI_ERROR;
+        memset( buf, 0, buflen );
+        memcpy( buf, bitmap->bits, bitmap->size );
+    }
+    *lpgm = bitmap->gm;
+    return bitmap->size;
+}
+
 /*************************************************************
  * freetype_GetGlyphOutline
  */
@@ -8260,7 +8835,10 @@ static DWORD CDECL freetype_GetGlyphOutline( PHYSDEV dev, UINT glyph, UINT forma
 
     GDI_CheckNotLock();
     EnterCriticalSection( &freetype_cs );
-    ret = get_glyph_outline( physdev->font, glyph, format, lpgm, &abc, buflen, buf, lpmat );
+    if (glyph_cache_max_size && is_glyph_bitmap_format( format ) && is_identity_MAT2( lpmat ))
+        ret = get_cached_glyph_bitmap( physdev->font, glyph, format, lpgm, buflen, buf, lpmat );
+    else
+        ret = get_glyph_outline( physdev->font, glyph, format, lpgm, &abc, buflen, buf, lpmat );
     LeaveCriticalSection( &freetype_cs );
     return ret;
 }
@@ -3845,6 +3845,140 @@ static void test_GdiAlphaBlend(void)
     HeapFree(GetProcessHeap(), 0, bmi);
 }
 
+/* the DIB engine may process the middle of a row with different code than its
+ * end, so blending or converting a whole row must match doing it pixel by pixel */
+static void test_row_consistency(void)
+{
+    static const BLENDFUNCTION blends[] =
+    {
+        { AC_SRC_OVER, 0, 255, AC_SRC_ALPHA },
+        { AC_SRC_OVER, 0, 100, AC_SRC_ALPHA },
+        { AC_SRC_OVER, 0, 100, 0 },
+        { AC_SRC_OVER, 0, 0, 0 },
+    };
+    static const DWORD masks_8888[3] = { 0xff0000, 0x00ff00, 0x0000ff };
+    const int width = 67, height = 3;
+    char bmibuf[FIELD_OFFSET( BITMAPINFO, bmiColors[3] )];
+    BITMAPINFO *bmi = (BITMAPINFO *)bmibuf;
+    HBITMAP src_bmp, src16_bmp, row_bmp, pixel_bmp, row16_bmp, pixel16_bmp;
+    DWORD *src_bits, *row_bits, *pixel_bits, *dst_init;
+    WORD *src16_bits, *row16_bits, *pixel16_bits;
+    HDC src_dc, row_dc, pixel_dc;
+    unsigned int seed = 12345;
+    int i, j, x, y, bad;
+    BOOL ret;
+
+    if (!pGdiAlphaBlend)
+    {
+        win_skip("GdiAlphaBlend() is not implemented\n");
+        return;
+    }
+
+    memset( bmi, 0, sizeof(bmibuf) );
+    bmi->bmiHeader.biSize = sizeof(bmi->bmiHeader);
+    bmi->bmiHeader.biWidth = width;
+    bmi->bmiHeader.biHeight = -height;
+    bmi->bmiHeader.biPlanes = 1;
+    bmi->bmiHeader.biBitCount = 32;
+    bmi->bmiHeader.biCompression = BI_RGB;
+    row_bmp = CreateDIBSection( 0, bmi, DIB_RGB_COLORS, (void **)&row_bits, NULL, 0 );
+    pixel_bmp = CreateDIBSection( 0, bmi, DIB_RGB_COLORS, (void **)&pixel_bits, NULL, 0 );
+    bmi->bmiHeader.biBitCount = 16;
+    row16_bmp = CreateDIBSection( 0, bmi, DIB_RGB_COLORS, (void **)&row16_bits, NULL, 0 );
+    pixel16_bmp = CreateDIBSection( 0, bmi, DIB_RGB_COLORS, (void **)&pixel16_bits, NULL, 0 );
+    src16_bmp = CreateDIBSection( 0, bmi, DIB_RGB_COLORS, (void **)&src16_bits, NULL, 0 );
+    ok( row_bmp && pixel_bmp && row16_bmp && pixel16_bmp && src16_bmp, "failed to create DIBs\n" );
+
+    dst_init = HeapAlloc( GetProcessHeap(), 0, width * height * sizeof(DWORD) );
+    for (i = 0; i < width * height; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        dst_init[i] = seed ^ (seed >> 16);
+    }
+
+    src_dc = CreateCompatibleDC( 0 );
+    row_dc = CreateCompatibleDC( 0 );
+    pixel_dc = CreateCompatibleDC( 0 );
+
+    for (j = 0; j < 2; j++)
+    {
+        /* BI_BITFIELDS sources take a different path for constant alpha blends */
+        bmi->bmiHeader.biBitCount = 32;
+        bmi->bmiHeader.biCompression = j ? BI_BITFIELDS : BI_RGB;
+        memcpy( bmi->bmiColors, masks_8888, sizeof(masks_8888) );
+        src_bmp = CreateDIBSection( 0, bmi, DIB_RGB_COLORS, (void **)&src_bits, NULL, 0 );
+        ok( src_bmp != NULL, "failed to create source DIB\n" );
+        for (i = 0; i < width * height; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            src_bits[i] = seed ^ (seed << 16);
+        }
+        SelectObject( src_dc, src_bmp );
+        SelectObject( row_dc, row_bmp );
+        SelectObject( pixel_dc, pixel_bmp );
+
+        for (i = 0; i < ARRAY_SIZE(blends); i++)
+        {
+            memcpy( row_bits, dst_init, width * height * sizeof(DWORD) );
+            memcpy( pixel_bits, dst_init, width * height * sizeof(DWORD) );
+
+            ret = pGdiAlphaBlend( row_dc, 0, 0, width, height, src_dc, 0, 0, width, height, blends[i] );
+            ok( ret, "%d/%d: GdiAlphaBlend failed\n", j, i );
+            for (y = 0; y < height; y++)
+                for (x = 0; x < width; x++)
+                    pGdiAlphaBlend( pixel_dc, x, y, 1, 1, src_dc, x, y, 1, 1, blends[i] );
+            GdiFlush();
+
+            for (x = bad = 0; x < width * height; x++) if (row_bits[x] != pixel_bits[x]) bad++;
+            ok( !bad, "%d/%d: %d pixels differ, first row pixels %08x / %08x\n",
+                j, i, bad, row_bits[0], pixel_bits[0] );
+        }
+
+        /* 8888 to 555 */
+        memset( row16_bits, 0, width * height * sizeof(WORD) );
+        memset( pixel16_bits, 0, width * height * sizeof(WORD) );
+        SelectObject( row_dc, row16_bmp );
+        SelectObject( pixel_dc, pixel16_bmp );
+        BitBlt( row_dc, 0, 0, width, height, src_dc, 0, 0, SRCCOPY );
+        for (y = 0; y < height; y++)
+            for (x = 0; x < width; x++)
+                BitBlt( pixel_dc, x, y, 1, 1, src_dc, x, y, SRCCOPY );
+        GdiFlush();
+        ok( !memcmp( row16_bits, pixel16_bits, width * height * sizeof(WORD) ), "%d: 555 conversion differs\n", j );
+
+        SelectObject( src_dc, GetStockObject( DEFAULT_BITMAP ));
+        DeleteObject( src_bmp );
+    }
+
+    /* 555 to 8888 */
+    for (i = 0; i < width * height; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        src16_bits[i] = seed >> 16;
+    }
+    memset( row_bits, 0, width * height * sizeof(DWORD) );
+    memset( pixel_bits, 0, width * height * sizeof(DWORD) );
+    SelectObject( src_dc, src16_bmp );
+    SelectObject( row_dc, row_bmp );
+    SelectObject( pixel_dc, pixel_bmp );
+    BitBlt( row_dc, 0, 0, width, height, src_dc, 0, 0, SRCCOPY );
+    for (y = 0; y < height; y++)
+        for (x = 0; x < width; x++)
+            BitBlt( pixel_dc, x, y, 1, 1, src_dc, x, y, SRCCOPY );
+    GdiFlush();
+    ok( !memcmp( row_bits, pixel_bits, width * height * sizeof(DWORD) ), "8888 conversion differs\n" );
+
+    DeleteDC( src_dc );
+    DeleteDC( row_dc );
+    DeleteDC( pixel_dc );
+    DeleteObject( row_bmp );
+    DeleteObject( pixel_bmp );
+    DeleteObject( row16_bmp );
+    DeleteObject( pixel16_bmp );
+    DeleteObject( src16_bmp );
+    HeapFree( GetProcessHeap(), 0, dst_init );
+}
+
 static void test_GdiGradientFill(void)
 {
     HDC hdc;
@@ -5965,6 +6099,7 @@ START_TEST(bitmap)
     test_StretchBlt();
     test_StretchDIBits();
     test_GdiAlphaBlend();
+    test_row_consistency();
     test_GdiGradientFill();
     test_32bit_ddb();
     test_bitmapinfoheadersize();
@@ -28,6 +28,7 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(jscript);
 WINE_DECLARE_DEBUG_CHANNEL(jscript_disas);
+WINE_DECLARE_DEBUG_CHANNEL(jscript_perf);
 
 typedef struct _statement_ctx_t {
     unsigned stack_use;
@@ -101,6 +102,7 @@ static void dump_instr_arg(instr_arg_type_t type, instr_arg_t *arg)
     case ARG_ADDR:
         TRACE_(jscript_disas)("\t%u", arg->uint);
         break;
+    case ARG_CACHE:
     case ARG_FUNC:
     case ARG_NONE:
         break;
@@ -313,6 +315,60 @@ static HRESULT push_instr_bstr_uint(compiler_ctx_t *ctx, jsop_t op, const WCHAR
     return S_OK;
 }
 
+static prop_cache_t *compiler_alloc_prop_cache(compiler_ctx_t *ctx, const WCHAR *name)
+{
+    prop_cache_t *cache;
+
+    cache = compiler_alloc(ctx->code, sizeof(*cache));
+    if(cache)
+        init_prop_cache(cache, name);
+    return cache;
+}
+
+static HRESULT push_instr_member(compiler_ctx_t *ctx, const WCHAR *identifier)
+{
+    prop_cache_t *cache;
+    unsigned instr;
+    WCHAR *str;
+
+    str = compiler_alloc_bstr(ctx, identifier);
+    if(!str)
+        return E_OUTOFMEMORY;
+
+    cache = compiler_alloc_prop_cache(ctx, identifier);
+    if(!cache)
+        return E_OUTOFMEMORY;
+
+    instr = push_instr(ctx, OP_member);
+    if(!instr)
+        return E_OUTOFMEMORY;
+
+    instr_ptr(ctx, instr)->u.arg[0].bstr = str;
+    instr_ptr(ctx, instr)->u.arg[1].cache = cache;
+    return S_OK;
+}
+
+/* identifier is NULL if the name is only known at run time */
+static HRESULT push_instr_memberid(compiler_ctx_t *ctx, unsigned flags, const WCHAR *identifier)
+{
+    prop_cache_t *cache = NULL;
+    unsigned instr;
+
+    if(identifier) {
+        cache = compiler_alloc_prop_cache(ctx, identifier);
+        if(!cache)
+            return E_OUTOFMEMORY;
+    }
+
+    instr = push_instr(ctx, OP_memberid);
+    if(!instr)
+        return E_OUTOFMEMORY;
+
+    instr_ptr(ctx, instr)->u.arg[0].uint = flags;
+    instr_ptr(ctx, instr)->u.arg[1].cache = cache;
+    return S_OK;
+}
+
 static HRESULT push_instr_uint_str(compiler_ctx_t *ctx, jsop_t op, unsigned arg1, const WCHAR *arg2)
 {
     unsigned instr;
@@ -395,7 +451,7 @@ static HRESULT compile_member_expression(compiler_ctx_t *ctx, member_expression_
     if(FAILED(hres))
         return hres;
 
-    return push_instr_bstr(ctx, OP_member, expr->identifier);
+    return push_instr_member(ctx, expr->identifier);
 }
 
 #define LABEL_FLAG 0x80000000
@@ -488,7 +544,7 @@ static HRESULT compile_memberid_expression(compiler_ctx_t *ctx, expression_t *ex
         if(FAILED(hres))
             return hres;
 
-        hres = push_instr_uint(ctx, OP_memberid, flags);
+        hres = push_instr_memberid(ctx, flags, NULL);
         break;
     }
     case EXPR_MEMBER: {
@@ -508,7 +564,7 @@ static HRESULT compile_memberid_expression(compiler_ctx_t *ctx, expression_t *ex
         if(FAILED(hres))
             return hres;
 
-        hres = push_instr_uint(ctx, OP_memberid, flags);
+        hres = push_instr_memberid(ctx, flags, member_expr->identifier);
         break;
     }
     DEFAULT_UNREACHABLE;
@@ -2486,13 +2542,137 @@ static HRESULT compile_arguments(compiler_ctx_t *ctx, const WCHAR *args)
     return parse_arguments(ctx, args, ctx->code->global_code.params, NULL);
 }
 
+/*
+ * Sources that are compiled over and over within a context, that is eval() strings,
+ * Function bodies, procedure text and expressions, are kept in a small per-context LRU
+ * list of compiled bytecode. Regular script text isn't cached: its bytecode is linked
+ * into the context's code lists and is only run once. Since parsing depends on
+ * conditional compilation state, nothing is cached once it's enabled.
+ *
+ * The hit rate and the time spent compiling cacheable sources are reported once per
+ * second on the jscript_perf channel.
+ */
+#define CODE_CACHE_SIZE 32
+
+typedef struct {
+    struct list entry;
+    bytecode_t *code;
+    unsigned hash;
+    BOOL from_eval;
+    WCHAR *delimiter;
+} code_cache_entry_t;
+
+static unsigned source_hash(const WCHAR *str)
+{
+    unsigned h = 0;
+    for(; *str; str++)
+        h = h * 31 + *str;
+    return h;
+}
+
+static void free_code_cache_entry(code_cache_entry_t *entry)
+{
+    list_remove(&entry->entry);
+    release_bytecode(entry->code);
+    heap_free(entry->delimiter);
+    heap_free(entry);
+}
+
+static bytecode_t *lookup_code_cache(script_ctx_t *ctx, unsigned hash, const WCHAR *source, UINT64 source_context,
+        unsigned start_line, const WCHAR *delimiter, BOOL from_eval, named_item_t *named_item)
+{
+    code_cache_entry_t *iter;
+
+    LIST_FOR_EACH_ENTRY(iter, &ctx->code_cache, code_cache_entry_t, entry) {
+        if(iter->hash != hash || iter->from_eval != from_eval || iter->code->named_item != named_item
+           || iter->code->source_context != source_context || iter->code->start_line != start_line)
+            continue;
+        if(iter->delimiter ? !delimiter || wcscmp(iter->delimiter, delimiter) : delimiter != NULL)
+            continue;
+        if(wcscmp(iter->code->source, source))
+            continue;
+
+        list_remove(&iter->entry);
+        list_add_head(&ctx->code_cache, &iter->entry);
+        return bytecode_addref(iter->code);
+    }
+
+    return NULL;
+}
+
+static void cache_code(script_ctx_t *ctx, unsigned hash, const WCHAR *delimiter, BOOL from_eval, bytecode_t *code)
+{
+    code_cache_entry_t *entry;
+
+    if(list_count(&ctx->code_cache) == CODE_CACHE_SIZE)
+        free_code_cache_entry(LIST_ENTRY(list_tail(&ctx->code_cache), code_cache_entry_t, entry));
+
+    entry = heap_alloc(sizeof(*entry));
+    if(!entry)
+        return;
+
+    entry->delimiter = NULL;
+    if(delimiter && !(entry->delimiter = heap_strdupW(delimiter))) {
+        heap_free(entry);
+        return;
+    }
+
+    entry->code = bytecode_addref(code);
+    entry->hash = hash;
+    entry->from_eval = from_eval;
+    list_add_head(&ctx->code_cache, &entry->entry);
+}
+
+static void report_code_cache(script_ctx_t *ctx, BOOL force)
+{
+    LARGE_INTEGER freq;
+    DWORD now;
+
+    if(!TRACE_ON(jscript_perf))
+        return;
+
+    now = GetTickCount();
+    if(!force && now - ctx->code_cache_report_ticks < 1000)
+        return;
+    ctx->code_cache_report_ticks = now;
+
+    QueryPerformanceFrequency(&freq);
+    TRACE_(jscript_perf)("%p code cache: %u hits, %u misses, %s us compiling\n", ctx,
+            ctx->code_cache_hits, ctx->code_cache_misses,
+            wine_dbgstr_longlong(ctx->code_cache_compile_time * 1000000 / freq.QuadPart));
+}
+
+void clear_code_cache(script_ctx_t *ctx)
+{
+    report_code_cache(ctx, TRUE);
+
+    while(!list_empty(&ctx->code_cache))
+        free_code_cache_entry(LIST_ENTRY(list_head(&ctx->code_cache), code_cache_entry_t, entry));
+}
+
 HRESULT compile_script(script_ctx_t *ctx, const WCHAR *code, UINT64 source_context, unsigned start_line,
                        const WCHAR *args, const WCHAR *delimiter, BOOL from_eval, BOOL use_decode,
-                       named_item_t *named_item, bytecode_t **ret)
+                       BOOL use_cache, named_item_t *named_item, bytecode_t **ret)
 {
     compiler_ctx_t compiler = {0};
+    LARGE_INTEGER start, end;
+    unsigned hash = 0;
     HRESULT hres;
 
+    if(use_cache && (!code || args || use_decode || ctx->cc))
+        use_cache = FALSE;
+    if(use_cache) {
+        hash = source_hash(code);
+        if((*ret = lookup_code_cache(ctx, hash, code, source_context, start_line, delimiter, from_eval, named_item))) {
+            TRACE("using cached code %p\n", *ret);
+            ctx->code_cache_hits++;
+            report_code_cache(ctx, FALSE);
+            return S_OK;
+        }
+        ctx->code_cache_misses++;
+        QueryPerformanceCounter(&start);
+    }
+
     hres = init_code(&compiler, code, source_context, start_line);
     if(FAILED(hres))
         return hres;
@@ -2534,6 +2714,14 @@ HRESULT compile_script(script_ctx_t *ctx, const WCHAR *code, UINT64 source_conte
         named_item->ref++;
     }
 
+    if(use_cache && !ctx->cc)
+        cache_code(ctx, hash, delimiter, from_eval, compiler.code);
+    if(use_cache) {
+        QueryPerformanceCounter(&end);
+        ctx->code_cache_compile_time += end.QuadPart - start.QuadPart;
+        report_code_cache(ctx, FALSE);
+    }
+
     *ret = compiler.code;
     return S_OK;
 }
@@ -312,12 +312,12 @@ static HRESULT find_prop_name_prot(jsdisp_t *This, unsigned hash, const WCHAR *n
     return S_OK;
 }
 
-static HRESULT ensure_prop_name(jsdisp_t *This, const WCHAR *name, DWORD create_flags, dispex_prop_t **ret)
+static HRESULT ensure_prop_name(jsdisp_t *This, unsigned hash, const WCHAR *name, DWORD create_flags, dispex_prop_t **ret)
 {
     dispex_prop_t *prop;
     HRESULT hres;
 
-    hres = find_prop_name_prot(This, string_hash(name), name, &prop);
+    hres = find_prop_name_prot(This, hash, name, &prop);
     if(SUCCEEDED(hres) && (!prop || prop->type == PROP_DELETED)) {
         TRACE("creating prop %s flags %x\n", debugstr_w(name), create_flags);
 
@@ -1872,16 +1872,16 @@ jsdisp_t *iface_to_jsdisp(IDispatch *iface)
         : NULL;
 }
 
-HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *id)
+static HRESULT get_id(jsdisp_t *jsdisp, unsigned hash, const WCHAR *name, DWORD flags, DISPID *id)
 {
     dispex_prop_t *prop;
     HRESULT hres;
 
     if(flags & fdexNameEnsure)
-        hres = ensure_prop_name(jsdisp, name, PROPF_ENUMERABLE | PROPF_CONFIGURABLE | PROPF_WRITABLE,
+        hres = ensure_prop_name(jsdisp, hash, name, PROPF_ENUMERABLE | PROPF_CONFIGURABLE | PROPF_WRITABLE,
                                 &prop);
     else
-        hres = find_prop_name_prot(jsdisp, string_hash(name), name, &prop);
+        hres = find_prop_name_prot(jsdisp, hash, name, &prop);
     if(FAILED(hres))
         return hres;
 
@@ -1895,6 +1895,48 @@ HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *
     return DISP_E_UNKNOWNNAME;
 }
 
+HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *id)
+{
+    return get_id(jsdisp, string_hash(name), name, flags, id);
+}
+
+void init_prop_cache(prop_cache_t *cache, const WCHAR *name)
+{
+    unsigned i;
+
+    cache->hash = string_hash(name);
+    cache->next = 0;
+    for(i = 0; i < ARRAY_SIZE(cache->ids); i++)
+        cache->ids[i] = DISPID_UNKNOWN;
+}
+
+/*
+ * Props are never removed from the props array, so a DISPID returned by an earlier lookup
+ * (possibly on another object) is still good if the property at that index has the name
+ * we're looking for and is not deleted. That's the same property lookup would find first.
+ */
+HRESULT jsdisp_get_id_cached(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, prop_cache_t *cache, DISPID *id)
+{
+    dispex_prop_t *prop;
+    unsigned i;
+    HRESULT hres;
+
+    for(i = 0; i < ARRAY_SIZE(cache->ids); i++) {
+        prop = get_prop(jsdisp, cache->ids[i]);
+        if(prop && prop->hash == cache->hash && !wcscmp(prop->name, name)) {
+            *id = cache->ids[i];
+            return S_OK;
+        }
+    }
+
+    hres = get_id(jsdisp, cache->hash, name, flags, id);
+    if(hres == S_OK) {
+        TRACE("caching %s as %d\n", debugstr_w(name), *id);
+        cache->ids[cache->next++ % ARRAY_SIZE(cache->ids)] = *id;
+    }
+    return hres;
+}
+
 HRESULT jsdisp_call_value(jsdisp_t *jsfunc, IDispatch *jsthis, WORD flags, unsigned argc, jsval_t *argv, jsval_t *r)
 {
     HRESULT hres;
@@ -2128,7 +2170,7 @@ HRESULT jsdisp_propput(jsdisp_t *obj, const WCHAR *name, DWORD flags, jsval_t va
     dispex_prop_t *prop;
     HRESULT hres;
 
-    hres = ensure_prop_name(obj, name, flags, &prop);
+    hres = ensure_prop_name(obj, string_hash(name), name, flags, &prop);
     if(FAILED(hres))
         return hres;
 
@@ -430,7 +430,8 @@ void scope_release(scope_chain_t *scope)
     heap_free(scope);
 }
 
-static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name, BSTR name_bstr, DWORD flags, DISPID *id)
+static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name, BSTR name_bstr, DWORD flags,
+        prop_cache_t *cache, DISPID *id)
 {
     IDispatchEx *dispex;
     jsdisp_t *jsdisp;
@@ -439,7 +440,10 @@ static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name
 
     jsdisp = iface_to_jsdisp(disp);
     if(jsdisp) {
-        hres = jsdisp_get_id(jsdisp, name, flags, id);
+        if(cache)
+            hres = jsdisp_get_id_cached(jsdisp, name, flags, cache, id);
+        else
+            hres = jsdisp_get_id(jsdisp, name, flags, id);
         jsdisp_release(jsdisp);
         return hres;
     }
@@ -593,7 +597,7 @@ static BOOL lookup_global_members(script_ctx_t *ctx, BSTR identifier, exprval_t
 
     LIST_FOR_EACH_ENTRY(item, &ctx->named_items, named_item_t, entry) {
         if(item->flags & SCRIPTITEM_GLOBALMEMBERS) {
-            hres = disp_get_id(ctx, item->disp, identifier, identifier, 0, &id);
+            hres = disp_get_id(ctx, item->disp, identifier, identifier, 0, NULL, &id);
             if(SUCCEEDED(hres)) {
                 if(ret)
                     exprval_set_disp_ref(ret, item->disp, id);
@@ -663,7 +667,7 @@ static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, exprval_t *re
             if(scope->jsobj)
                 hres = jsdisp_get_id(scope->jsobj, identifier, fdexNameImplicit, &id);
             else
-                hres = disp_get_id(ctx, scope->obj, identifier, identifier, fdexNameImplicit, &id);
+                hres = disp_get_id(ctx, scope->obj, identifier, identifier, fdexNameImplicit, NULL, &id);
             if(SUCCEEDED(hres)) {
                 exprval_set_disp_ref(ret, scope->obj, id);
                 return S_OK;
@@ -678,7 +682,7 @@ static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, exprval_t *re
                 return S_OK;
             }
             if(!(item->flags & SCRIPTITEM_CODEONLY)) {
-                hres = disp_get_id(ctx, item->disp, identifier, identifier, 0, &id);
+                hres = disp_get_id(ctx, item->disp, identifier, identifier, 0, NULL, &id);
                 if(SUCCEEDED(hres)) {
                     exprval_set_disp_ref(ret, item->disp, id);
                     return S_OK;
@@ -732,6 +736,12 @@ static inline jsstr_t *get_op_str(script_ctx_t *ctx, int i)
     return frame->bytecode->instrs[frame->ip].u.arg[i].str;
 }
 
+static inline prop_cache_t *get_op_cache(script_ctx_t *ctx, int i)
+{
+    call_frame_t *frame = ctx->call_ctx;
+    return frame->bytecode->instrs[frame->ip].u.arg[i].cache;
+}
+
 static inline double get_op_double(script_ctx_t *ctx)
 {
     call_frame_t *frame = ctx->call_ctx;
@@ -1076,7 +1086,7 @@ static HRESULT interp_array(script_ctx_t *ctx)
         return hres;
     }
 
-    hres = disp_get_id(ctx, obj, name, NULL, 0, &id);
+    hres = disp_get_id(ctx, obj, name, NULL, 0, NULL, &id);
     jsstr_release(name_str);
     if(SUCCEEDED(hres)) {
         hres = disp_propget(ctx, obj, id, &v);
@@ -1106,7 +1116,7 @@ static HRESULT interp_member(script_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx, obj, arg, arg, 0, &id);
+    hres = disp_get_id(ctx, obj, arg, arg, 0, get_op_cache(ctx, 1), &id);
     if(SUCCEEDED(hres)) {
         hres = disp_propget(ctx, obj, id, &v);
     }else if(hres == DISP_E_UNKNOWNNAME) {
@@ -1148,7 +1158,7 @@ static HRESULT interp_memberid(script_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx, obj, name, NULL, arg, &id);
+    hres = disp_get_id(ctx, obj, name, NULL, arg, get_op_cache(ctx, 1), &id);
     jsstr_release(name_str);
     if(SUCCEEDED(hres)) {
         ref.type = EXPRVAL_IDREF;
@@ -1720,7 +1730,7 @@ static HRESULT interp_in(script_ctx_t *ctx)
         return hres;
     }
 
-    hres = disp_get_id(ctx, get_object(obj), str, NULL, 0, &id);
+    hres = disp_get_id(ctx, get_object(obj), str, NULL, 0, NULL, &id);
     IDispatch_Release(get_object(obj));
     jsstr_release(jsstr);
     if(SUCCEEDED(hres))
@@ -3075,7 +3085,7 @@ HRESULT exec_source(script_ctx_t *ctx, DWORD flags, bytecode_t *bytecode, functi
             }
 
             if(item && !(item->flags & SCRIPTITEM_CODEONLY)
-                && SUCCEEDED(disp_get_id(ctx, item->disp, function->variables[i].name, function->variables[i].name, 0, &id)))
+                && SUCCEEDED(disp_get_id(ctx, item->disp, function->variables[i].name, function->variables[i].name, 0, NULL, &id)))
                     continue;
 
             if(!item && (flags & EXEC_GLOBAL) && lookup_global_members(ctx, function->variables[i].name, NULL))
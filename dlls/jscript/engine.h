@@ -55,8 +55,8 @@
     X(lshift,     1, 0,0)                  \
     X(lt,         1, 0,0)                  \
     X(lteq,       1, 0,0)                  \
-    X(member,     1, ARG_BSTR,   0)        \
-    X(memberid,   1, ARG_UINT,   0)        \
+    X(member,     1, ARG_BSTR,   ARG_CACHE)\
+    X(memberid,   1, ARG_UINT,   ARG_CACHE)\
     X(minus,      1, 0,0)                  \
     X(mod,        1, 0,0)                  \
     X(mul,        1, 0,0)                  \
@@ -110,12 +110,14 @@ typedef union {
     LONG lng;
     jsstr_t *str;
     unsigned uint;
+    prop_cache_t *cache;
 } instr_arg_t;
 
 typedef enum {
     ARG_NONE = 0,
     ARG_ADDR,
     ARG_BSTR,
+    ARG_CACHE,
     ARG_DBL,
     ARG_FUNC,
     ARG_INT,
@@ -198,8 +200,9 @@ struct _bytecode_t {
     struct list entry;
 };
 
-HRESULT compile_script(script_ctx_t*,const WCHAR*,UINT64,unsigned,const WCHAR*,const WCHAR*,BOOL,BOOL,named_item_t*,bytecode_t**) DECLSPEC_HIDDEN;
+HRESULT compile_script(script_ctx_t*,const WCHAR*,UINT64,unsigned,const WCHAR*,const WCHAR*,BOOL,BOOL,BOOL,named_item_t*,bytecode_t**) DECLSPEC_HIDDEN;
 void release_bytecode(bytecode_t*) DECLSPEC_HIDDEN;
+void clear_code_cache(script_ctx_t*) DECLSPEC_HIDDEN;
 
 static inline bytecode_t *bytecode_addref(bytecode_t *code)
 {
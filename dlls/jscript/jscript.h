@@ -258,6 +258,16 @@ static inline IDispatch *to_disp(jsdisp_t *jsdisp)
     return (IDispatch*)&jsdisp->IDispatchEx_iface;
 }
 
+/*
+ * Per-instruction cache of DISPIDs that member lookups of a constant name resolved to.
+ * A few entries let a site that sees several kinds of objects hit as well.
+ */
+typedef struct {
+    unsigned hash;
+    unsigned next;
+    DISPID ids[4];
+} prop_cache_t;
+
 jsdisp_t *as_jsdisp(IDispatch*) DECLSPEC_HIDDEN;
 jsdisp_t *to_jsdisp(IDispatch*) DECLSPEC_HIDDEN;
 void jsdisp_free(jsdisp_t*) DECLSPEC_HIDDEN;
@@ -307,6 +317,8 @@ HRESULT jsdisp_propput_idx(jsdisp_t*,DWORD,jsval_t) DECLSPEC_HIDDEN;
 HRESULT jsdisp_propget_name(jsdisp_t*,LPCWSTR,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_idx(jsdisp_t*,DWORD,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_id(jsdisp_t*,const WCHAR*,DWORD,DISPID*) DECLSPEC_HIDDEN;
+HRESULT jsdisp_get_id_cached(jsdisp_t*,const WCHAR*,DWORD,prop_cache_t*,DISPID*) DECLSPEC_HIDDEN;
+void init_prop_cache(prop_cache_t*,const WCHAR*) DECLSPEC_HIDDEN;
 HRESULT disp_delete(IDispatch*,DISPID,BOOL*) DECLSPEC_HIDDEN;
 HRESULT disp_delete_name(script_ctx_t*,IDispatch*,jsstr_t*,BOOL*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_delete_idx(jsdisp_t*,DWORD) DECLSPEC_HIDDEN;
@@ -424,6 +436,12 @@ struct _script_ctx_t {
 
     heap_pool_t tmp_heap;
 
+    struct list code_cache;
+    unsigned code_cache_hits;
+    unsigned code_cache_misses;
+    LONGLONG code_cache_compile_time;
+    DWORD code_cache_report_ticks;
+
     jsval_t *stack;
     unsigned stack_size;
     unsigned stack_top;
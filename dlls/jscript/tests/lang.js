@@ -1910,6 +1910,64 @@ ok(Object === 1, "Object = " + Object);
 Array = 1;
 ok(Array === 1, "Array = " + Array);
 
+function testMemberCache() {
+    var objs = [{x: 1}, {y: 0, x: 2}, {z: 0, y: 0, x: 3}, {w: 0, z: 0, y: 0, x: 4}, {v: 0, x: 5}];
+    var i, r = "", proto = {x: "p"}, o;
+
+    function get(o) { return o.x; }
+
+    for(i = 0; i < objs.length * 2; i++)
+        r += get(objs[i % objs.length]);
+    ok(r === "1234512345", "r = " + r);
+
+    o = objs[1];
+    delete o.x;
+    ok(get(o) === undefined, "get(o) = " + get(o));
+    o.x = 6;
+    ok(get(o) === 6, "get(o) = " + get(o));
+
+    function C() {}
+    C.prototype = proto;
+    o = new C();
+    ok(get(o) === "p", "get(o) = " + get(o));
+    o.x = 7;
+    ok(get(o) === 7, "get(o) = " + get(o));
+    delete o.x;
+    ok(get(o) === "p", "get(o) = " + get(o));
+    proto.x = "q";
+    ok(get(o) === "q", "get(o) = " + get(o));
+    delete proto.x;
+    ok(get(o) === undefined, "get(o) = " + get(o));
+
+    for(i = 0; i < objs.length; i++)
+        objs[i].x = i;
+    r = "";
+    for(i = 0; i < objs.length; i++)
+        r += get(objs[i]);
+    ok(r === "01234", "r = " + r);
+}
+testMemberCache();
+
+function testRepeatedEval() {
+    var i, r = "", f, g;
+
+    for(i = 0; i < 3; i++)
+        r += eval("var x = i * 2; x;");
+    ok(r === "024", "r = " + r);
+
+    function inner(v) { return eval("v + 1"); }
+    ok(inner(1) === 2, "inner(1) = " + inner(1));
+    ok(inner("a") === "a1", "inner('a') = " + inner("a"));
+
+    f = new Function("a", "return a + 1;");
+    g = new Function("a", "return a + 1;");
+    ok(f !== g, "f === g");
+    ok(f(1) === 2 && g(2) === 3, "f(1) = " + f(1) + " g(2) = " + g(2));
+    f.prop = true;
+    ok(g.prop === undefined, "g.prop = " + g.prop);
+}
+testRepeatedEval();
+
 Date = 1;
 ok(Date === 1, "Date = " + Date);
 
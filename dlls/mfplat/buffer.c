@@ -21,6 +21,7 @@
 #include "mfplat_private.h"
 
 #include "wine/debug.h"
+#include "wine/list.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(mfplat);
 
@@ -72,6 +73,145 @@ struct sample
     LONGLONG timestamp;
 };
 
+/* Video pipelines create and destroy buffers of the same few sizes at a high rate. Released
+   data blocks are kept around and handed out again for the same size and alignment. */
+
+#define BUFFER_POOL_MIN_SIZE  4096
+#define BUFFER_POOL_MAX_SIZE  (64 * 1024 * 1024)
+#define BUFFER_POOL_MAX_COUNT 32
+
+struct buffer_block
+{
+    struct list entry;
+    void *base;
+    SIZE_T size;
+    DWORD alignment;
+};
+
+static struct
+{
+    struct list blocks;
+    SIZE_T size;
+    unsigned int count;
+    unsigned int hits;
+    unsigned int misses;
+}
+buffer_pool = { LIST_INIT(buffer_pool.blocks) };
+
+static CRITICAL_SECTION buffer_pool_cs;
+static CRITICAL_SECTION_DEBUG buffer_pool_cs_debug =
+{
+    0, 0, &buffer_pool_cs,
+    { &buffer_pool_cs_debug.ProcessLocksList, &buffer_pool_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": buffer_pool_cs") }
+};
+static CRITICAL_SECTION buffer_pool_cs = { &buffer_pool_cs_debug, -1, 0, 0, 0, 0 };
+
+static inline struct buffer_block *buffer_block_from_data(BYTE *data)
+{
+    return (struct buffer_block *)data - 1;
+}
+
+static void buffer_pool_evict(void)
+{
+    struct buffer_block *block;
+
+    while (buffer_pool.size > BUFFER_POOL_MAX_SIZE || buffer_pool.count > BUFFER_POOL_MAX_COUNT)
+    {
+        block = LIST_ENTRY(list_tail(&buffer_pool.blocks), struct buffer_block, entry);
+        list_remove(&block->entry);
+        buffer_pool.size -= block->size;
+        buffer_pool.count--;
+        heap_free(block->base);
+    }
+}
+
+/* Returns zeroed memory aligned to 'alignment' + 1 bytes. */
+static BYTE *alloc_buffer_data(SIZE_T size, DWORD alignment)
+{
+    struct buffer_block *block;
+    void *base;
+    BYTE *data;
+
+    alignment |= MEMORY_ALLOCATION_ALIGNMENT - 1;
+
+    if (size >= BUFFER_POOL_MIN_SIZE)
+    {
+        EnterCriticalSection(&buffer_pool_cs);
+
+        LIST_FOR_EACH_ENTRY(block, &buffer_pool.blocks, struct buffer_block, entry)
+        {
+            if (block->size != size || block->alignment != alignment)
+                continue;
+
+            list_remove(&block->entry);
+            buffer_pool.size -= size;
+            buffer_pool.count--;
+            buffer_pool.hits++;
+            LeaveCriticalSection(&buffer_pool_cs);
+
+            /* Don't hand out contents of a previous buffer. */
+            data = (BYTE *)(block + 1);
+            memset(data, 0, size);
+            return data;
+        }
+
+        if (!(++buffer_pool.misses % 256))
+            TRACE("%u buffers recycled, %u allocated.\n", buffer_pool.hits, buffer_pool.misses);
+
+        LeaveCriticalSection(&buffer_pool_cs);
+    }
+
+    if (!(base = heap_alloc_zero(size + alignment + sizeof(*block))))
+        return NULL;
+
+    data = (BYTE *)(((UINT_PTR)base + sizeof(*block) + alignment) & ~(UINT_PTR)alignment);
+    block = buffer_block_from_data(data);
+    block->base = base;
+    block->size = size;
+    block->alignment = alignment;
+
+    return data;
+}
+
+static void free_buffer_data(BYTE *data)
+{
+    struct buffer_block *block;
+
+    if (!data)
+        return;
+
+    block = buffer_block_from_data(data);
+
+    if (block->size < BUFFER_POOL_MIN_SIZE || block->size > BUFFER_POOL_MAX_SIZE / 4)
+    {
+        heap_free(block->base);
+        return;
+    }
+
+    EnterCriticalSection(&buffer_pool_cs);
+    list_add_head(&buffer_pool.blocks, &block->entry);
+    buffer_pool.size += block->size;
+    buffer_pool.count++;
+    buffer_pool_evict();
+    LeaveCriticalSection(&buffer_pool_cs);
+}
+
+void flush_buffer_pool(void)
+{
+    struct buffer_block *block, *next;
+
+    EnterCriticalSection(&buffer_pool_cs);
+    LIST_FOR_EACH_ENTRY_SAFE(block, next, &buffer_pool.blocks, struct buffer_block, entry)
+    {
+        list_remove(&block->entry);
+        heap_free(block->base);
+    }
+    buffer_pool.size = 0;
+    buffer_pool.count = 0;
+    LeaveCriticalSection(&buffer_pool_cs);
+}
+
 static inline struct memory_buffer *impl_from_IMFMediaBuffer(IMFMediaBuffer *iface)
 {
     return CONTAINING_RECORD(iface, struct memory_buffer, IMFMediaBuffer_iface);
@@ -126,8 +266,9 @@ static ULONG WINAPI memory_buffer_Release(IMFMediaBuffer *iface)
     if (!refcount)
     {
         DeleteCriticalSection(&buffer->cs);
-        heap_free(buffer->_2d.linear_buffer);
-        heap_free(buffer->data);
+        if (buffer->_2d.linear_buffer != buffer->data)
+            free_buffer_data(buffer->_2d.linear_buffer);
+        free_buffer_data(buffer->data);
         heap_free(buffer);
     }
 
@@ -240,6 +381,13 @@ static HRESULT WINAPI memory_1d_2d_buffer_QueryInterface(IMFMediaBuffer *iface,
     return S_OK;
 }
 
+/* Rows directly follow each other, so the buffer already has the linear layout. */
+static BOOL memory_2d_buffer_is_contiguous(const struct memory_buffer *buffer)
+{
+    return buffer->_2d.pitch > 0 && buffer->_2d.pitch == (int)buffer->_2d.width
+            && buffer->_2d.plane_size <= buffer->max_length;
+}
+
 static HRESULT WINAPI memory_1d_2d_buffer_Lock(IMFMediaBuffer *iface, BYTE **data, DWORD *max_length, DWORD *current_length)
 {
     struct memory_buffer *buffer = impl_from_IMFMediaBuffer(iface);
@@ -251,7 +399,8 @@ static HRESULT WINAPI memory_1d_2d_buffer_Lock(IMFMediaBuffer *iface, BYTE **dat
         return E_POINTER;
 
     /* Allocate linear buffer and return it as a copy of current content. Maximum and current length are
-       unrelated to 2D buffer maximum allocate length, or maintained current length. */
+       unrelated to 2D buffer maximum allocate length, or maintained current length. Contiguous buffers
+       are returned directly. */
 
     EnterCriticalSection(&buffer->cs);
 
@@ -259,7 +408,9 @@ static HRESULT WINAPI memory_1d_2d_buffer_Lock(IMFMediaBuffer *iface, BYTE **dat
         hr = MF_E_INVALIDREQUEST;
     else if (!buffer->_2d.linear_buffer)
     {
-        if (!(buffer->_2d.linear_buffer = heap_alloc(ALIGN_SIZE(buffer->_2d.plane_size, MF_64_BYTE_ALIGNMENT))))
+        if (memory_2d_buffer_is_contiguous(buffer))
+            buffer->_2d.linear_buffer = buffer->data;
+        else if (!(buffer->_2d.linear_buffer = alloc_buffer_data(buffer->_2d.plane_size, MF_64_BYTE_ALIGNMENT)))
             hr = E_OUTOFMEMORY;
     }
 
@@ -288,10 +439,13 @@ static HRESULT WINAPI memory_1d_2d_buffer_Unlock(IMFMediaBuffer *iface)
 
     if (buffer->_2d.linear_buffer && !--buffer->_2d.locks)
     {
-        MFCopyImage(buffer->data, buffer->_2d.pitch, buffer->_2d.linear_buffer, buffer->_2d.width,
-                buffer->_2d.width, buffer->_2d.height);
+        if (buffer->_2d.linear_buffer != buffer->data)
+        {
+            MFCopyImage(buffer->data, buffer->_2d.pitch, buffer->_2d.linear_buffer, buffer->_2d.width,
+                    buffer->_2d.width, buffer->_2d.height);
 
-        heap_free(buffer->_2d.linear_buffer);
+            free_buffer_data(buffer->_2d.linear_buffer);
+        }
         buffer->_2d.linear_buffer = NULL;
     }
 
@@ -419,12 +573,14 @@ static HRESULT WINAPI memory_2d_buffer_GetScanline0AndPitch(IMF2DBuffer2 *iface,
 
 static HRESULT WINAPI memory_2d_buffer_IsContiguousFormat(IMF2DBuffer2 *iface, BOOL *is_contiguous)
 {
+    struct memory_buffer *buffer = impl_from_IMF2DBuffer2(iface);
+
     TRACE("%p, %p.\n", iface, is_contiguous);
 
     if (!is_contiguous)
         return E_POINTER;
 
-    *is_contiguous = FALSE;
+    *is_contiguous = memory_2d_buffer_is_contiguous(buffer);
 
     return S_OK;
 }
@@ -503,7 +659,7 @@ static const IMF2DBuffer2Vtbl memory_2d_buffer_vtbl =
 static HRESULT memory_buffer_init(struct memory_buffer *buffer, DWORD max_length, DWORD alignment,
         const IMFMediaBufferVtbl *vtbl)
 {
-    buffer->data = heap_alloc_zero(ALIGN_SIZE(max_length, alignment));
+    buffer->data = alloc_buffer_data(ALIGN_SIZE(max_length, alignment), alignment);
     if (!buffer->data)
         return E_OUTOFMEMORY;
 
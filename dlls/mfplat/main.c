@@ -1500,6 +1500,7 @@ HRESULT WINAPI MFShutdown(void)
     TRACE("\n");
 
     RtwqShutdown();
+    flush_buffer_pool();
 
     return S_OK;
 }
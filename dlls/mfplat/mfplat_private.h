@@ -116,6 +116,7 @@ static inline BOOL mf_array_reserve(void **elements, size_t *capacity, size_t co
 }
 
 extern unsigned int mf_format_get_stride(const GUID *subtype, unsigned int width, BOOL *is_yuv) DECLSPEC_HIDDEN;
+extern void flush_buffer_pool(void) DECLSPEC_HIDDEN;
 
 static inline const char *debugstr_propvar(const PROPVARIANT *v)
 {
@@ -5043,6 +5043,40 @@ static void test_MFCreate2DMediaBuffer(void)
 
         IMFMediaBuffer_Release(buffer);
     }
+
+    /* Rows are already contiguous, linear lock does not need a copy. */
+    hr = pMFCreate2DMediaBuffer(64, 4, D3DFMT_A8R8G8B8, FALSE, &buffer);
+    ok(hr == S_OK, "Failed to create a buffer, hr %#x.\n", hr);
+
+    hr = IMFMediaBuffer_QueryInterface(buffer, &IID_IMF2DBuffer, (void **)&_2dbuffer);
+    ok(hr == S_OK, "Failed to get interface, hr %#x.\n", hr);
+
+    ret = FALSE;
+    hr = IMF2DBuffer_IsContiguousFormat(_2dbuffer, &ret);
+    ok(hr == S_OK, "Failed to get format flag, hr %#x.\n", hr);
+    ok(ret, "Unexpected format flag %d.\n", ret);
+
+    hr = IMF2DBuffer_Lock2D(_2dbuffer, &data2, &pitch);
+    ok(hr == S_OK, "Failed to lock buffer, hr %#x.\n", hr);
+    ok(pitch == 256, "Unexpected pitch %d.\n", pitch);
+    memset(data2, 0xcc, 256 * 4);
+
+    hr = IMF2DBuffer_Unlock2D(_2dbuffer);
+    ok(hr == S_OK, "Failed to unlock buffer, hr %#x.\n", hr);
+
+    hr = IMFMediaBuffer_Lock(buffer, &data, &length, NULL);
+    ok(hr == S_OK, "Failed to lock buffer, hr %#x.\n", hr);
+    ok(length == 256 * 4, "Unexpected length %u.\n", length);
+    ok(data[0] == 0xcc && data[length - 1] == 0xcc, "Unexpected buffer contents.\n");
+
+    hr = IMF2DBuffer_Lock2D(_2dbuffer, &data2, &pitch);
+    ok(hr == MF_E_UNEXPECTED, "Unexpected hr %#x.\n", hr);
+
+    hr = IMFMediaBuffer_Unlock(buffer);
+    ok(hr == S_OK, "Failed to unlock buffer, hr %#x.\n", hr);
+
+    IMF2DBuffer_Release(_2dbuffer);
+    IMFMediaBuffer_Release(buffer);
 }
 
 static void test_MFCreateMediaBufferFromMediaType(void)
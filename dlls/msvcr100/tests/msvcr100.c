@@ -230,6 +230,7 @@ static Scheduler* (__cdecl *p_Scheduler_Create)(SchedulerPolicy*);
 static Scheduler* (__cdecl *p_CurrentScheduler_Get)(void);
 static void (__cdecl *p_CurrentScheduler_Detach)(void);
 static unsigned int (__cdecl *p_CurrentScheduler_Id)(void);
+static void (__cdecl *p_CurrentScheduler_ScheduleTask)(void (__cdecl*)(void*), void*);
 
 static int (__cdecl *p__memicmp)(const char*, const char*, size_t);
 static int (__cdecl *p__memicmp_l)(const char*, const char*, size_t,_locale_t);
@@ -318,6 +319,7 @@ static BOOL init(void)
         SET(p_SchedulerPolicy_dtor, "??1SchedulerPolicy@Concurrency@@QEAA@XZ");
         SET(p_Scheduler_Create, "?Create@Scheduler@Concurrency@@SAPEAV12@AEBVSchedulerPolicy@2@@Z");
         SET(p_CurrentScheduler_Get, "?Get@CurrentScheduler@Concurrency@@SAPEAVScheduler@2@XZ");
+        SET(p_CurrentScheduler_ScheduleTask, "?ScheduleTask@CurrentScheduler@Concurrency@@SAXP6AXPEAX@Z0@Z");
     } else {
         SET(pSpinWait_ctor_yield, "??0?$_SpinWait@$00@details@Concurrency@@QAE@P6AXXZ@Z");
         SET(pSpinWait_dtor, "??_F?$_SpinWait@$00@details@Concurrency@@QAEXXZ");
@@ -359,6 +361,7 @@ static BOOL init(void)
         SET(p_SchedulerPolicy_dtor, "??1SchedulerPolicy@Concurrency@@QAE@XZ");
         SET(p_Scheduler_Create, "?Create@Scheduler@Concurrency@@SAPAV12@ABVSchedulerPolicy@2@@Z");
         SET(p_CurrentScheduler_Get, "?Get@CurrentScheduler@Concurrency@@SAPAVScheduler@2@XZ");
+        SET(p_CurrentScheduler_ScheduleTask, "?ScheduleTask@CurrentScheduler@Concurrency@@SAXP6AXPAX@Z0@Z");
     }
 
     init_thiscall_thunk();
@@ -960,6 +963,7 @@ static void test_Scheduler(void)
 {
     Scheduler *scheduler, *current_scheduler;
     SchedulerPolicy policy;
+    SYSTEM_INFO si;
     unsigned int i;
 
     call_func1(p_SchedulerPolicy_ctor, &policy);
@@ -986,9 +990,44 @@ static void test_Scheduler(void)
     i = call_func1(scheduler->vtable->GetNumberOfVirtualProcessors, scheduler);
     ok(i == 1, "Scheduler::GetNumberOfVirtualProcessors() = %u\n", i);
     call_func1(scheduler->vtable->Release, scheduler);
+
+    /* MaxExecutionResources */
+    GetSystemInfo(&si);
+    call_func3(p_SchedulerPolicy_SetConcurrencyLimits, &policy, -1, -1);
+    scheduler = p_Scheduler_Create(&policy);
+    ok(scheduler != NULL, "Scheduler::Create() = NULL\n");
+
+    i = call_func1(scheduler->vtable->GetNumberOfVirtualProcessors, scheduler);
+    ok(i == si.dwNumberOfProcessors, "Scheduler::GetNumberOfVirtualProcessors() = %u, expected %u\n",
+            i, si.dwNumberOfProcessors);
+    call_func1(scheduler->vtable->Release, scheduler);
     call_func1(p_SchedulerPolicy_dtor, &policy);
 }
 
+static LONG scheduled_tasks;
+
+static void __cdecl scheduled_task(void *event)
+{
+    if (InterlockedIncrement(&scheduled_tasks) == 16)
+        SetEvent(event);
+}
+
+static void test_ScheduleTask(void)
+{
+    HANDLE event;
+    DWORD ret;
+    int i;
+
+    event = CreateEventW(NULL, TRUE, FALSE, NULL);
+    for (i = 0; i < 16; i++)
+        p_CurrentScheduler_ScheduleTask(scheduled_task, event);
+
+    ret = WaitForSingleObject(event, 5000);
+    ok(ret == WAIT_OBJECT_0, "WaitForSingleObject returned %u\n", ret);
+    ok(scheduled_tasks == 16, "%d tasks run\n", scheduled_tasks);
+    CloseHandle(event);
+}
+
 static void test__memicmp(void)
 {
     static const char *s1 = "abc";
@@ -1113,6 +1152,7 @@ START_TEST(msvcr100)
 
     test_ExternalContextBase();
     test_Scheduler();
+    test_ScheduleTask();
     test_wmemcpy_s();
     test_wmemmove_s();
     test_fread_s();
@@ -38,6 +38,8 @@
 #include <sys/types.h>
 #include <limits.h>
 
+#include "ntstatus.h"
+#define WIN32_NO_STATUS
 #include "windef.h"
 #include "winbase.h"
 #include "winternl.h"
@@ -115,12 +117,25 @@ ioinfo * MSVCRT___pioinfo[MSVCRT_MAX_FILES/MSVCRT_FD_BLOCK_SIZE] = { 0 };
  */
 ioinfo MSVCRT___badioinfo = { INVALID_HANDLE_VALUE, WX_TEXT };
 
+/* Streams are biased towards the first thread locking them, which then
+ * locks and unlocks them by updating a plain counter. Another thread revokes
+ * the bias once while holding the stream lock: it suspends the owner, which
+ * makes the owner's counter and stream updates visible, until the counter is
+ * zero. From then on every thread takes the stream lock. */
+typedef struct {
+    LONG owner;
+    LONG revoked;
+    LONG depth;
+} stream_bias;
+
 typedef struct {
     MSVCRT_FILE file;
     CRITICAL_SECTION crit;
+    stream_bias bias;
 } file_crit;
 
 MSVCRT_FILE MSVCRT__iob[_IOB_ENTRIES] = { { 0 } };
+static stream_bias MSVCRT_iob_bias[_IOB_ENTRIES];
 static file_crit* MSVCRT_fstream[MSVCRT_MAX_FILES/MSVCRT_FD_BLOCK_SIZE];
 static int MSVCRT_max_streams = 512, MSVCRT_stream_idx;
 
@@ -1309,15 +1324,84 @@ LONG CDECL MSVCRT__lseek(int fd, LONG offset, int whence)
     return MSVCRT__lseeki64(fd, offset, whence);
 }
 
+/* Keeps the compiler from moving stream accesses across bias updates. The
+ * hardware ordering is taken care of by suspending the owner. */
+#ifdef __GNUC__
+#define stream_bias_barrier() __asm__ __volatile__("" ::: "memory")
+#else
+#define stream_bias_barrier() MemoryBarrier()
+#endif
+
+static inline stream_bias* msvcrt_get_stream_bias(MSVCRT_FILE *file)
+{
+    if(file>=MSVCRT__iob && file<MSVCRT__iob+_IOB_ENTRIES)
+        return &MSVCRT_iob_bias[file-MSVCRT__iob];
+    return &((file_crit*)file)->bias;
+}
+
+/* INTERNAL: Revoke the bias of a stream, the stream lock must be held */
+static void msvcrt_revoke_stream_bias(stream_bias *bias)
+{
+    CONTEXT context;
+    HANDLE thread;
+    LONG depth;
+
+    TRACE("revoking bias towards thread %04x\n", bias->owner);
+
+    /* the owner sees this once it has been suspended */
+    InterlockedExchange(&bias->revoked, TRUE);
+
+    /* if the owner has exited, it doesn't hold the stream either */
+    if(!(thread = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT, FALSE, bias->owner)))
+        return;
+
+    for(;;)
+    {
+        if(SuspendThread(thread) == ~0u)
+            break;
+        /* returns once the thread is actually suspended */
+        context.ContextFlags = CONTEXT_CONTROL;
+        GetThreadContext(thread, &context);
+        depth = *(volatile LONG*)&bias->depth;
+        ResumeThread(thread);
+        if(!depth)
+            break;
+        Sleep(1);
+    }
+    CloseHandle(thread);
+}
+
 /*********************************************************************
  *              _lock_file (MSVCRT.@)
  */
 void CDECL MSVCRT__lock_file(MSVCRT_FILE *file)
 {
+    stream_bias *bias = msvcrt_get_stream_bias(file);
+    LONG tid = GetCurrentThreadId();
+
+    if(bias->owner == tid || (!bias->owner && !InterlockedCompareExchange(&bias->owner, tid, 0)))
+    {
+        /* nested locks keep the stream held, even if revoked meanwhile */
+        if(*(volatile LONG*)&bias->depth)
+        {
+            bias->depth++;
+            return;
+        }
+
+        *(volatile LONG*)&bias->depth = 1;
+        stream_bias_barrier();
+        if(!*(volatile LONG*)&bias->revoked)
+            return;
+        *(volatile LONG*)&bias->depth = 0;
+    }
+
     if(file>=MSVCRT__iob && file<MSVCRT__iob+_IOB_ENTRIES)
         _lock(_STREAM_LOCKS+(file-MSVCRT__iob));
     else
         EnterCriticalSection(&((file_crit*)file)->crit);
+
+    if(bias->owner != tid && !bias->revoked)
+        msvcrt_revoke_stream_bias(bias);
 }
 
 /*********************************************************************
@@ -1325,6 +1409,15 @@ void CDECL MSVCRT__lock_file(MSVCRT_FILE *file)
  */
 void CDECL MSVCRT__unlock_file(MSVCRT_FILE *file)
 {
+    stream_bias *bias = msvcrt_get_stream_bias(file);
+
+    if(bias->owner == GetCurrentThreadId() && bias->depth)
+    {
+        stream_bias_barrier();
+        *(volatile LONG*)&bias->depth = bias->depth - 1;
+        return;
+    }
+
     if(file>=MSVCRT__iob && file<MSVCRT__iob+_IOB_ENTRIES)
         _unlock(_STREAM_LOCKS+(file-MSVCRT__iob));
     else
@@ -2927,6 +3020,53 @@ int CDECL MSVCRT__read(int fd, void *buf, unsigned int count)
     return num_read;
 }
 
+/* INTERNAL: Read a large block of binary data without going through read_i */
+static int msvcrt_read_direct(int fd, void *buf, unsigned int count)
+{
+    IO_STATUS_BLOCK io;
+    NTSTATUS status;
+    ioinfo *info;
+    int ret;
+
+    if(fd == MSVCRT_NO_CONSOLE_FD)
+        return MSVCRT__read(fd, buf, count);
+
+    /* consoles, text mode and pending lookahead need the full read_i handling */
+    info = get_ioinfo(fd);
+    if(info->handle == INVALID_HANDLE_VALUE || (info->wxflag & (WX_ATEOF | WX_TTY | WX_TEXT))
+            || (info->exflag & (EF_UTF8 | EF_UTF16)) || info->lookahead[0] != '\n')
+    {
+        ret = read_i(fd, info, buf, count);
+        release_ioinfo(info);
+        return ret;
+    }
+
+    status = NtReadFile(info->handle, NULL, NULL, NULL, &io, buf, count, NULL, NULL);
+    if(status == STATUS_PENDING)
+    {
+        NtWaitForSingleObject(info->handle, FALSE, NULL);
+        status = io.Status;
+    }
+
+    if(status == STATUS_END_OF_FILE || status == STATUS_PIPE_BROKEN
+            || (status == STATUS_SUCCESS && !io.Information))
+    {
+        TRACE(":EOF\n");
+        info->wxflag |= WX_ATEOF;
+        ret = 0;
+    }
+    else if(status == STATUS_SUCCESS)
+        ret = io.Information;
+    else
+    {
+        TRACE(":failed-status (%08x)\n", status);
+        msvcrt_set_errno(RtlNtStatusToDosError(status));
+        ret = -1;
+    }
+    release_ioinfo(info);
+    return ret;
+}
+
 /*********************************************************************
  *		_setmode (MSVCRT.@)
  */
@@ -3616,6 +3756,42 @@ int CDECL MSVCRT__write(int fd, const void* buf, unsigned int count)
     return -1;
 }
 
+/* INTERNAL: Write a large block of binary data without going through _write */
+static int msvcrt_write_direct(int fd, const void *buf, unsigned int count)
+{
+    IO_STATUS_BLOCK io;
+    NTSTATUS status;
+    ioinfo *info;
+
+    if(fd == MSVCRT_NO_CONSOLE_FD)
+        return MSVCRT__write(fd, buf, count);
+
+    /* consoles, text mode and appending need the full _write handling */
+    info = get_ioinfo(fd);
+    if(info->handle == INVALID_HANDLE_VALUE || (info->wxflag & (WX_APPEND | WX_TTY | WX_TEXT))
+            || (info->exflag & (EF_UTF8 | EF_UTF16)))
+    {
+        release_ioinfo(info);
+        return MSVCRT__write(fd, buf, count);
+    }
+
+    status = NtWriteFile(info->handle, NULL, NULL, NULL, &io, buf, count, NULL, NULL);
+    if(status == STATUS_PENDING)
+    {
+        NtWaitForSingleObject(info->handle, FALSE, NULL);
+        status = io.Status;
+    }
+    release_ioinfo(info);
+
+    if(status != STATUS_SUCCESS || io.Information != count)
+    {
+        TRACE(":failed-status (%08x)\n", status);
+        msvcrt_set_errno(RtlNtStatusToDosError(status));
+        return -1;
+    }
+    return count;
+}
+
 /*********************************************************************
  *		_putw (MSVCRT.@)
  */
@@ -4058,7 +4234,7 @@ MSVCRT_size_t CDECL MSVCRT__fwrite_nolock(const void *ptr, MSVCRT_size_t size, M
             if(msvcrt_flush_buffer(file) == MSVCRT_EOF)
                 break;
 
-            if(MSVCRT__write(file->_file, ptr, pcnt) <= 0) {
+            if(msvcrt_write_direct(file->_file, ptr, pcnt) <= 0) {
                 file->_flag |= MSVCRT__IOERR;
                 break;
             }
@@ -4353,11 +4529,11 @@ MSVCRT_size_t CDECL MSVCRT__fread_nolock(void *ptr, MSVCRT_size_t size, MSVCRT_s
         file->_ptr += i;
       }
     } else if (rcnt > INT_MAX) {
-      i = MSVCRT__read(file->_file, ptr, INT_MAX);
+      i = msvcrt_read_direct(file->_file, ptr, INT_MAX);
     } else if (rcnt < (file->_bufsiz ? file->_bufsiz : MSVCRT_INTERNAL_BUFSIZ)) {
       i = MSVCRT__read(file->_file, ptr, rcnt);
     } else {
-      i = MSVCRT__read(file->_file, ptr, rcnt - rcnt % (file->_bufsiz ? file->_bufsiz : MSVCRT_INTERNAL_BUFSIZ));
+      i = msvcrt_read_direct(file->_file, ptr, rcnt - rcnt % (file->_bufsiz ? file->_bufsiz : MSVCRT_INTERNAL_BUFSIZ));
     }
     pread += i;
     rcnt -= i;
@@ -53,6 +53,315 @@ static unsigned int MSVCRT_amblksiz = 16;
 /* FIXME - According to documentation it should be 480 bytes, at runtime default is 0 */
 static MSVCRT_size_t MSVCRT_sbh_threshold = 0;
 
+static void* msvcrt_heap_alloc(DWORD flags, MSVCRT_size_t size);
+
+/* Thread caching allocator for blocks of up to SBH_MAX_SIZE bytes.
+ *
+ * Small blocks are carved out of spans in a single reserved region, so a
+ * pointer can be recognized with a range check. Each span holds blocks of a
+ * single size class and belongs to the thread cache that carved it. The owner
+ * allocates and frees without locking; other threads push freed blocks to the
+ * owner's remote list, which it drains when it runs out of blocks. Caches of
+ * exited threads are kept and handed over to new threads. The span header
+ * records the requested size of each block for _msize and _heapwalk. */
+
+#define SBH_MAX_SIZE    1024
+#define SBH_CLASS_COUNT 20
+#define SBH_SPAN_SIZE   0x4000
+#ifdef _WIN64
+#define SBH_REGION_SIZE 0x40000000
+#else
+#define SBH_REGION_SIZE 0x2000000
+#endif
+
+struct sbh_block
+{
+    struct sbh_block *next;
+};
+
+struct sbh_cache
+{
+    struct sbh_block *free[SBH_CLASS_COUNT];
+    struct sbh_span *span[SBH_CLASS_COUNT];
+    struct sbh_block * volatile remote;
+    struct sbh_cache *next_orphan;
+};
+
+struct sbh_span
+{
+    struct sbh_cache *owner;
+    unsigned int size_class;
+    unsigned int block_size;
+    char *blocks;
+    char *next;
+    char *end;
+    unsigned short sizes[1];    /* requested size + 1, 0 for free blocks */
+};
+
+static const unsigned short sbh_class_size[SBH_CLASS_COUNT] =
+{
+    16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256, 320, 384, 448, 512,
+    640, 768, 896, 1024
+};
+
+static unsigned char sbh_size_class[SBH_MAX_SIZE / 16 + 1];
+static char *sbh_base;
+static LONG sbh_span_count;
+static DWORD sbh_tls_index = TLS_OUT_OF_INDEXES;
+static struct sbh_cache *sbh_orphans;
+
+static CRITICAL_SECTION sbh_cs;
+static CRITICAL_SECTION_DEBUG sbh_cs_debug =
+{
+    0, 0, &sbh_cs,
+    { &sbh_cs_debug.ProcessLocksList, &sbh_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": sbh_cs") }
+};
+static CRITICAL_SECTION sbh_cs = { &sbh_cs_debug, -1, 0, 0, 0, 0 };
+
+static inline BOOL sbh_is_block(const void *ptr)
+{
+    return sbh_base && (ULONG_PTR)((const char *)ptr - sbh_base) < SBH_REGION_SIZE;
+}
+
+static inline struct sbh_span *sbh_get_span(const void *ptr)
+{
+    return (struct sbh_span *)((ULONG_PTR)ptr & ~(ULONG_PTR)(SBH_SPAN_SIZE - 1));
+}
+
+static inline unsigned short *sbh_block_size(struct sbh_span *span, const void *ptr)
+{
+    return &span->sizes[((const char *)ptr - span->blocks) / span->block_size];
+}
+
+/* like msvcrt_get_thread_data, heap functions must preserve the last error */
+static inline struct sbh_cache *sbh_current_cache(void)
+{
+    DWORD err = GetLastError();
+    struct sbh_cache *cache = TlsGetValue(sbh_tls_index);
+    SetLastError(err);
+    return cache;
+}
+
+static struct sbh_cache *sbh_get_cache(void)
+{
+    struct sbh_cache *cache;
+    char *base;
+
+    if (sbh_tls_index == TLS_OUT_OF_INDEXES) return NULL;
+    if ((cache = sbh_current_cache())) return cache;
+
+    if (!sbh_base)
+    {
+        /* the region is only reserved by the first thread needing it,
+         * address space is scarce for 32-bit processes */
+        if (!(base = VirtualAlloc(NULL, SBH_REGION_SIZE, MEM_RESERVE, PAGE_READWRITE)))
+            return NULL;
+        if (InterlockedCompareExchangePointer((void **)&sbh_base, base, NULL))
+            VirtualFree(base, 0, MEM_RELEASE);
+    }
+
+    EnterCriticalSection(&sbh_cs);
+    if ((cache = sbh_orphans))
+        sbh_orphans = cache->next_orphan;
+    LeaveCriticalSection(&sbh_cs);
+
+    if (!cache && !(cache = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*cache))))
+        return NULL;
+    cache->next_orphan = NULL;
+    TlsSetValue(sbh_tls_index, cache);
+    return cache;
+}
+
+static struct sbh_span *sbh_new_span(struct sbh_cache *cache, unsigned int size_class)
+{
+    struct sbh_span *span;
+    unsigned int blocks;
+    LONG count;
+
+    count = InterlockedIncrement(&sbh_span_count);
+    if (count > SBH_REGION_SIZE / SBH_SPAN_SIZE)
+    {
+        InterlockedDecrement(&sbh_span_count);
+        return NULL;
+    }
+
+    span = (struct sbh_span *)(sbh_base + (count - 1) * SBH_SPAN_SIZE);
+    if (!VirtualAlloc(span, SBH_SPAN_SIZE, MEM_COMMIT, PAGE_READWRITE))
+        return NULL;
+
+    span->owner = cache;
+    span->size_class = size_class;
+    span->block_size = sbh_class_size[size_class];
+    /* leave room for the sizes array and the alignment of the first block */
+    blocks = (SBH_SPAN_SIZE - FIELD_OFFSET(struct sbh_span, sizes) - SB_HEAP_ALIGN + 1) /
+            (span->block_size + sizeof(span->sizes[0]));
+    span->blocks = (char *)(((ULONG_PTR)&span->sizes[blocks] + SB_HEAP_ALIGN - 1) & ~(ULONG_PTR)(SB_HEAP_ALIGN - 1));
+    span->next = span->blocks;
+    span->end = span->blocks + blocks * span->block_size;
+    TRACE("span %p for %u byte blocks, %d spans in use\n", span, span->block_size, count);
+    return span;
+}
+
+static void *sbh_alloc_slow(struct sbh_cache *cache, unsigned int size_class)
+{
+    struct sbh_block *block, *next;
+    struct sbh_span *span;
+
+    if ((block = InterlockedExchangePointer((void **)&cache->remote, NULL)))
+    {
+        for (; block; block = next)
+        {
+            next = block->next;
+            span = sbh_get_span(block);
+            block->next = cache->free[span->size_class];
+            cache->free[span->size_class] = block;
+        }
+        if ((block = cache->free[size_class]))
+        {
+            cache->free[size_class] = block->next;
+            return block;
+        }
+    }
+
+    span = cache->span[size_class];
+    if (!span || span->next + span->block_size > span->end)
+    {
+        if (!(span = sbh_new_span(cache, size_class))) return NULL;
+        cache->span[size_class] = span;
+    }
+    block = (struct sbh_block *)span->next;
+    span->next += span->block_size;
+    return block;
+}
+
+static void *sbh_alloc(DWORD flags, MSVCRT_size_t size)
+{
+    unsigned int size_class = sbh_size_class[(size + 15) / 16];
+    struct sbh_cache *cache;
+    struct sbh_block *block;
+
+    if (!(cache = sbh_get_cache())) return NULL;
+
+    if ((block = cache->free[size_class]))
+        cache->free[size_class] = block->next;
+    else if (!(block = sbh_alloc_slow(cache, size_class)))
+        return NULL;
+
+    *sbh_block_size(sbh_get_span(block), block) = size + 1;
+    if (flags & HEAP_ZERO_MEMORY) memset(block, 0, size);
+    return block;
+}
+
+static void sbh_free(void *ptr)
+{
+    struct sbh_span *span = sbh_get_span(ptr);
+    struct sbh_cache *owner = span->owner;
+    struct sbh_block *block = ptr, *head;
+
+    *sbh_block_size(span, ptr) = 0;
+    if (owner == sbh_current_cache())
+    {
+        block->next = owner->free[span->size_class];
+        owner->free[span->size_class] = block;
+        return;
+    }
+
+    do
+    {
+        head = owner->remote;
+        block->next = head;
+    } while (InterlockedCompareExchangePointer((void **)&owner->remote, block, head) != head);
+}
+
+static void *sbh_realloc(DWORD flags, void *ptr, MSVCRT_size_t size)
+{
+    struct sbh_span *span = sbh_get_span(ptr);
+    unsigned short *block_size = sbh_block_size(span, ptr);
+    MSVCRT_size_t old_size = *block_size - 1;
+    void *ret;
+
+    if (size <= span->block_size && (size > span->block_size / 2 || (flags & HEAP_REALLOC_IN_PLACE_ONLY)))
+    {
+        if ((flags & HEAP_ZERO_MEMORY) && size > old_size)
+            memset((char *)ptr + old_size, 0, size - old_size);
+        *block_size = size + 1;
+        return ptr;
+    }
+    if (flags & HEAP_REALLOC_IN_PLACE_ONLY)
+        return NULL;
+
+    if (!(ret = msvcrt_heap_alloc(flags & HEAP_ZERO_MEMORY, size))) return NULL;
+    memcpy(ret, ptr, min(size, old_size));
+    sbh_free(ptr);
+    return ret;
+}
+
+/* Returns the small block following prev, or the first one if prev is NULL.
+ * Free blocks are reported past their free list link. */
+static int sbh_walk(struct MSVCRT__heapinfo *next, const void *prev)
+{
+    MEMORY_BASIC_INFORMATION info;
+    struct sbh_span *span;
+    unsigned int i = 0;
+    LONG count;
+    char *block;
+
+    if (!sbh_base) return MSVCRT__HEAPEND;
+
+    count = sbh_span_count;
+    span = (struct sbh_span *)sbh_base;
+    if (prev)
+    {
+        span = sbh_get_span(prev);
+        i = sbh_block_size(span, prev) - span->sizes + 1;
+    }
+
+    for (; (char *)span < sbh_base + min(count, SBH_REGION_SIZE / SBH_SPAN_SIZE) * SBH_SPAN_SIZE;
+         span = (struct sbh_span *)((char *)span + SBH_SPAN_SIZE), i = 0)
+    {
+        /* a span may have failed to commit */
+        if (!VirtualQuery(span, &info, sizeof(info)) || info.State != MEM_COMMIT)
+            continue;
+        block = span->blocks + i * span->block_size;
+        if (block >= span->next)
+            continue;
+
+        if (span->sizes[i])
+        {
+            next->_pentry = (int *)block;
+            next->_size = span->sizes[i] - 1;
+            next->_useflag = MSVCRT__USEDENTRY;
+        }
+        else
+        {
+            next->_pentry = (int *)(block + sizeof(struct sbh_block));
+            next->_size = span->block_size - sizeof(struct sbh_block);
+            next->_useflag = MSVCRT__FREEENTRY;
+        }
+        return MSVCRT__HEAPOK;
+    }
+
+    return MSVCRT__HEAPEND;
+}
+
+/* Called on thread exit, the cache is kept for the next thread as other
+ * threads may still free blocks from its spans. */
+void msvcrt_free_heap_thread(void)
+{
+    struct sbh_cache *cache;
+
+    if (sbh_tls_index == TLS_OUT_OF_INDEXES || !(cache = sbh_current_cache()))
+        return;
+    TlsSetValue(sbh_tls_index, NULL);
+
+    EnterCriticalSection(&sbh_cs);
+    cache->next_orphan = sbh_orphans;
+    sbh_orphans = cache;
+    LeaveCriticalSection(&sbh_cs);
+}
+
 static void* msvcrt_heap_alloc(DWORD flags, MSVCRT_size_t size)
 {
     if(size < MSVCRT_sbh_threshold)
@@ -68,11 +377,20 @@ static void* msvcrt_heap_alloc(DWORD flags, MSVCRT_size_t size)
         return memblock;
     }
 
+    if(size <= SBH_MAX_SIZE)
+    {
+        void *memblock = sbh_alloc(flags, size);
+        if(memblock) return memblock;
+    }
+
     return HeapAlloc(heap, flags, size);
 }
 
 static void* msvcrt_heap_realloc(DWORD flags, void *ptr, MSVCRT_size_t size)
 {
+    if(sbh_is_block(ptr))
+        return sbh_realloc(flags, ptr, size);
+
     if(sb_heap && ptr && !HeapValidate(heap, 0, ptr))
     {
         /* TODO: move data to normal heap if it exceeds sbh_threshold limit */
@@ -105,6 +423,12 @@ static void* msvcrt_heap_realloc(DWORD flags, void *ptr, MSVCRT_size_t size)
 
 static BOOL msvcrt_heap_free(void *ptr)
 {
+    if(sbh_is_block(ptr))
+    {
+        sbh_free(ptr);
+        return TRUE;
+    }
+
     if(sb_heap && ptr && !HeapValidate(heap, 0, ptr))
     {
         void **saved = SAVED_PTR(ptr);
@@ -116,6 +440,9 @@ static BOOL msvcrt_heap_free(void *ptr)
 
 static MSVCRT_size_t msvcrt_heap_size(void *ptr)
 {
+    if(sbh_is_block(ptr))
+        return *sbh_block_size(sbh_get_span(ptr), ptr) - 1;
+
     if(sb_heap && ptr && !HeapValidate(heap, 0, ptr))
     {
         void **saved = SAVED_PTR(ptr);
@@ -278,6 +605,13 @@ int CDECL _heapwalk(struct MSVCRT__heapinfo* next)
       FIXME("small blocks heap not supported\n");
 
   LOCK_HEAP;
+  if (sbh_is_block(next->_pentry))
+  {
+    int ret = sbh_walk(next, next->_pentry);
+    UNLOCK_HEAP;
+    return ret;
+  }
+
   phe.lpData = next->_pentry;
   phe.cbData = next->_size;
   phe.wFlags = next->_useflag == MSVCRT__USEDENTRY ? PROCESS_HEAP_ENTRY_BUSY : 0;
@@ -294,9 +628,14 @@ int CDECL _heapwalk(struct MSVCRT__heapinfo* next)
   {
     if (!HeapWalk( heap, &phe ))
     {
-      UNLOCK_HEAP;
       if (GetLastError() == ERROR_NO_MORE_ITEMS)
-         return MSVCRT__HEAPEND;
+      {
+        /* continue with the small blocks */
+        int ret = sbh_walk(next, NULL);
+        UNLOCK_HEAP;
+        return ret;
+      }
+      UNLOCK_HEAP;
       msvcrt_set_errno(GetLastError());
       if (!phe.lpData)
         return MSVCRT__HEAPBADBEGIN;
@@ -867,13 +1206,27 @@ int CDECL MSVCRT_strncpy_s(char *dest, MSVCRT_size_t numberOfElements,
 
 BOOL msvcrt_init_heap(void)
 {
+    unsigned int i, size_class = 0;
+
     heap = HeapCreate(0, 0, 0);
-    return heap != NULL;
+    if(!heap) return FALSE;
+
+    for(i = 0; i <= SBH_MAX_SIZE / 16; i++)
+    {
+        if(i * 16 > sbh_class_size[size_class]) size_class++;
+        sbh_size_class[i] = size_class;
+    }
+    sbh_tls_index = TlsAlloc();
+    return TRUE;
 }
 
 void msvcrt_destroy_heap(void)
 {
     HeapDestroy(heap);
+    if(sbh_tls_index != TLS_OUT_OF_INDEXES)
+        TlsFree(sbh_tls_index);
+    if(sbh_base)
+        VirtualFree(sbh_base, 0, MEM_RELEASE);
     if(sb_heap)
         HeapDestroy(sb_heap);
 }
@@ -672,7 +672,8 @@ int FUNC_NAME(pf_printf)(FUNC_NAME(puts_clbk) pf_puts, void *puts_ctx, const API
                     for(i=0; tmp[i]; i++)
                         tmp[i] = MSVCRT__toupper_l(tmp[i], NULL);
             } else {
-                sprintf(tmp, float_fmt, val);
+                if(!format_double(tmp, val, flags.Format, flags.Precision, flags.Alternate))
+                    sprintf(tmp, float_fmt, val);
                 if(MSVCRT__toupper_l(flags.Format, NULL)=='E' || MSVCRT__toupper_l(flags.Format, NULL)=='G')
                     FUNC_NAME(pf_fixup_exponent)(tmp, three_digit_exp);
             }
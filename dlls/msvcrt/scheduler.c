@@ -89,6 +89,12 @@ typedef struct {
     struct scheduler_list scheduler;
     unsigned int id;
     union allocator_cache_entry *allocator_cache[8];
+    /* set on the worker threads of a scheduler */
+    struct scheduler_pool *pool;
+    int vproc;
+    /* Block/Unblock */
+    LONG blocked;
+    HANDLE blocked_event;
 } ExternalContextBase;
 extern const vtable_ptr MSVCRT_ExternalContextBase_vtable;
 static void ExternalContextBase_ctor(ExternalContextBase*);
@@ -130,9 +136,48 @@ typedef struct {
     int shutdown_size;
     HANDLE *shutdown_events;
     CRITICAL_SECTION cs;
+    struct scheduler_pool *pool;
 } ThreadScheduler;
 extern const vtable_ptr MSVCRT_ThreadScheduler_vtable;
 
+/* Every scheduled task keeps a reference to its scheduler. */
+struct scheduled_task {
+    void (__cdecl *proc)(void*);
+    void *data;
+    ThreadScheduler *scheduler;
+};
+
+/* Each virtual processor has its own queue. Its worker takes the newest task
+ * from it and steals the oldest ones from the other queues. */
+struct task_queue {
+    CRITICAL_SECTION cs;
+    struct scheduled_task *tasks;
+    unsigned int head;
+    unsigned int count;
+    unsigned int size;
+    BOOL owned;
+};
+
+/* idle worker threads exit after this many milliseconds */
+#define WORKER_IDLE_TIMEOUT 2000
+
+/* Worker threads state. It's referenced by the scheduler and by every worker
+ * thread, since the last task of a scheduler may release it from a worker. */
+struct scheduler_pool {
+    LONG ref;
+    CRITICAL_SECTION cs;
+    CONDITION_VARIABLE cv;
+    BOOL shutdown;
+    LONG pending;
+    LONG idle;
+    LONG next_queue;
+    LONG threads;
+    LONG max_threads;
+    int priority;
+    unsigned int queue_count;
+    struct task_queue queues[1];
+};
+
 typedef struct {
     Scheduler *scheduler;
 } _Scheduler;
@@ -230,23 +275,59 @@ unsigned int __cdecl Context_Id(void)
     return ctx ? call_Context_GetId(ctx) : -1;
 }
 
+static void scheduler_pool_oversubscribe(struct scheduler_pool*, BOOL);
+
+static ExternalContextBase* get_current_external_context(void)
+{
+    ExternalContextBase *context = (ExternalContextBase*)get_current_context();
+
+    if (context->context.vtable != &MSVCRT_ExternalContextBase_vtable) {
+        ERR("unknown context set\n");
+        return NULL;
+    }
+    return context;
+}
+
 /* ?Block@Context@Concurrency@@SAXXZ */
 void __cdecl Context_Block(void)
 {
-    FIXME("()\n");
+    ExternalContextBase *context = get_current_external_context();
+    HANDLE event;
+
+    TRACE("()\n");
+
+    if (!context || InterlockedDecrement(&context->blocked) >= 0)
+        return;
+
+    if (!context->blocked_event) {
+        if (!(event = CreateEventW(NULL, FALSE, FALSE, NULL)))
+            throw_exception(EXCEPTION_SCHEDULER_RESOURCE_ALLOCATION_ERROR,
+                    HRESULT_FROM_WIN32(GetLastError()), NULL);
+        if (InterlockedCompareExchangePointer(&context->blocked_event, event, NULL))
+            CloseHandle(event);
+    }
+
+    /* let another worker use the virtual processor while we're blocked */
+    if (context->pool)
+        scheduler_pool_oversubscribe(context->pool, TRUE);
+    WaitForSingleObject(context->blocked_event, INFINITE);
+    if (context->pool)
+        scheduler_pool_oversubscribe(context->pool, FALSE);
 }
 
 /* ?Yield@Context@Concurrency@@SAXXZ */
 /* ?_Yield@_Context@details@Concurrency@@SAXXZ */
 void __cdecl Context_Yield(void)
 {
-    FIXME("()\n");
+    TRACE("()\n");
+    SwitchToThread();
 }
 
 /* ?_SpinYield@Context@Concurrency@@SAXXZ */
 void __cdecl Context__SpinYield(void)
 {
-    FIXME("()\n");
+    TRACE("()\n");
+    SwitchToThread();
 }
 
 /* ?IsCurrentTaskCollectionCanceling@Context@Concurrency@@SA_NXZ */
@@ -259,7 +340,12 @@ MSVCRT_bool __cdecl Context_IsCurrentTaskCollectionCanceling(void)
 /* ?Oversubscribe@Context@Concurrency@@SAX_N@Z */
 void __cdecl Context_Oversubscribe(MSVCRT_bool begin)
 {
-    FIXME("(%x)\n", begin);
+    ExternalContextBase *context = get_current_external_context();
+
+    TRACE("(%x)\n", begin);
+
+    if (context && context->pool)
+        scheduler_pool_oversubscribe(context->pool, begin);
 }
 
 /* ?ScheduleGroupId@Context@Concurrency@@SAIXZ */
@@ -288,8 +374,8 @@ unsigned int __thiscall ExternalContextBase_GetId(const ExternalContextBase *thi
 DEFINE_THISCALL_WRAPPER(ExternalContextBase_GetVirtualProcessorId, 4)
 unsigned int __thiscall ExternalContextBase_GetVirtualProcessorId(const ExternalContextBase *this)
 {
-    FIXME("(%p)->() stub\n", this);
-    return -1;
+    TRACE("(%p)->()\n", this);
+    return this->vproc;
 }
 
 DEFINE_THISCALL_WRAPPER(ExternalContextBase_GetScheduleGroupId, 4)
@@ -302,14 +388,24 @@ unsigned int __thiscall ExternalContextBase_GetScheduleGroupId(const ExternalCon
 DEFINE_THISCALL_WRAPPER(ExternalContextBase_Unblock, 4)
 void __thiscall ExternalContextBase_Unblock(ExternalContextBase *this)
 {
-    FIXME("(%p)->() stub\n", this);
+    HANDLE event;
+
+    TRACE("(%p)->()\n", this);
+
+    if (InterlockedIncrement(&this->blocked) > 0)
+        return;
+
+    /* Block() may not have created the event yet */
+    while (!(event = *(HANDLE volatile *)&this->blocked_event))
+        SwitchToThread();
+    SetEvent(event);
 }
 
 DEFINE_THISCALL_WRAPPER(ExternalContextBase_IsSynchronouslyBlocked, 4)
 MSVCRT_bool __thiscall ExternalContextBase_IsSynchronouslyBlocked(const ExternalContextBase *this)
 {
-    FIXME("(%p)->() stub\n", this);
-    return FALSE;
+    TRACE("(%p)->()\n", this);
+    return this->blocked < 0;
 }
 
 static void ExternalContextBase_dtor(ExternalContextBase *this)
@@ -326,6 +422,9 @@ static void ExternalContextBase_dtor(ExternalContextBase *this)
         }
     }
 
+    if (this->blocked_event)
+        CloseHandle(this->blocked_event);
+
     if (this->scheduler.scheduler) {
         call_Scheduler_Release(this->scheduler.scheduler);
 
@@ -364,6 +463,7 @@ static void ExternalContextBase_ctor(ExternalContextBase *this)
     memset(this, 0, sizeof(*this));
     this->context.vtable = &MSVCRT_ExternalContextBase_vtable;
     this->id = InterlockedIncrement(&context_id);
+    this->vproc = -1;
 
     create_default_scheduler();
     this->scheduler.scheduler = &default_scheduler->scheduler;
@@ -598,12 +698,247 @@ void __thiscall SchedulerPolicy_dtor(SchedulerPolicy *this)
     MSVCRT_operator_delete(this->policy_container);
 }
 
+static BOOL task_queue_push(struct task_queue *queue, const struct scheduled_task *task)
+{
+    struct scheduled_task *tasks;
+    unsigned int i;
+
+    EnterCriticalSection(&queue->cs);
+    if (queue->count == queue->size) {
+        unsigned int size = queue->size ? queue->size * 2 : 64;
+
+        if (!(tasks = MSVCRT_malloc(size * sizeof(*tasks)))) {
+            LeaveCriticalSection(&queue->cs);
+            return FALSE;
+        }
+        for (i = 0; i < queue->count; i++)
+            tasks[i] = queue->tasks[(queue->head + i) & (queue->size - 1)];
+        MSVCRT_free(queue->tasks);
+        queue->tasks = tasks;
+        queue->head = 0;
+        queue->size = size;
+    }
+    queue->tasks[(queue->head + queue->count++) & (queue->size - 1)] = *task;
+    LeaveCriticalSection(&queue->cs);
+    return TRUE;
+}
+
+static BOOL task_queue_pop(struct task_queue *queue, struct scheduled_task *task, BOOL newest)
+{
+    BOOL ret = FALSE;
+
+    EnterCriticalSection(&queue->cs);
+    if (queue->count) {
+        if (newest) {
+            *task = queue->tasks[(queue->head + queue->count - 1) & (queue->size - 1)];
+        } else {
+            *task = queue->tasks[queue->head];
+            queue->head = (queue->head + 1) & (queue->size - 1);
+        }
+        queue->count--;
+        ret = TRUE;
+    }
+    LeaveCriticalSection(&queue->cs);
+    return ret;
+}
+
+static struct scheduler_pool* scheduler_pool_create(unsigned int queue_count,
+        unsigned int max_threads, int priority)
+{
+    struct scheduler_pool *pool;
+    unsigned int i;
+
+    pool = MSVCRT_operator_new(FIELD_OFFSET(struct scheduler_pool, queues[queue_count]));
+    memset(pool, 0, FIELD_OFFSET(struct scheduler_pool, queues[queue_count]));
+    pool->ref = 1;
+    pool->max_threads = max_threads;
+    pool->priority = priority;
+    pool->queue_count = queue_count;
+    InitializeConditionVariable(&pool->cv);
+    InitializeCriticalSection(&pool->cs);
+    pool->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": scheduler_pool");
+    for (i = 0; i < queue_count; i++) {
+        InitializeCriticalSection(&pool->queues[i].cs);
+        pool->queues[i].cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": task_queue");
+    }
+    return pool;
+}
+
+static void scheduler_pool_release(struct scheduler_pool *pool)
+{
+    unsigned int i;
+
+    if (InterlockedDecrement(&pool->ref))
+        return;
+
+    for (i = 0; i < pool->queue_count; i++) {
+        pool->queues[i].cs.DebugInfo->Spare[0] = 0;
+        DeleteCriticalSection(&pool->queues[i].cs);
+        MSVCRT_free(pool->queues[i].tasks);
+    }
+    pool->cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection(&pool->cs);
+    MSVCRT_operator_delete(pool);
+}
+
+static BOOL scheduler_pool_get_task(struct scheduler_pool *pool, int vproc, struct scheduled_task *task)
+{
+    unsigned int i, start;
+
+    if (!*(LONG volatile *)&pool->pending)
+        return FALSE;
+
+    if (vproc >= 0 && task_queue_pop(&pool->queues[vproc], task, TRUE))
+        goto done;
+
+    start = vproc >= 0 ? vproc + 1 : 0;
+    for (i = 0; i < pool->queue_count; i++) {
+        if (task_queue_pop(&pool->queues[(start + i) % pool->queue_count], task, FALSE))
+            goto done;
+    }
+    return FALSE;
+
+done:
+    InterlockedDecrement(&pool->pending);
+    return TRUE;
+}
+
+static DWORD WINAPI scheduler_worker_proc(void *arg)
+{
+    struct scheduler_pool *pool = arg;
+    ExternalContextBase *context = get_current_external_context();
+    struct scheduled_task task;
+    Scheduler *scheduler = NULL;
+    BOOL timed_out;
+    HMODULE module;
+    int vproc = -1;
+    unsigned int i;
+
+    /* take over the queue of a virtual processor whose worker has exited */
+    EnterCriticalSection(&pool->cs);
+    for (i = 0; i < pool->queue_count; i++) {
+        if (!pool->queues[i].owned) {
+            pool->queues[i].owned = TRUE;
+            vproc = i;
+            break;
+        }
+    }
+    LeaveCriticalSection(&pool->cs);
+    TRACE("starting worker thread for %p, virtual processor %d\n", pool, vproc);
+
+    if (context) {
+        context->pool = pool;
+        context->vproc = vproc;
+    }
+
+    for (;;) {
+        if (scheduler_pool_get_task(pool, vproc, &task)) {
+            if (context) {
+                scheduler = context->scheduler.scheduler;
+                context->scheduler.scheduler = &task.scheduler->scheduler;
+            }
+            task.proc(task.data);
+            if (context)
+                context->scheduler.scheduler = scheduler;
+            call_Scheduler_Release(&task.scheduler->scheduler);
+            continue;
+        }
+
+        /* Whoever queues a task after we checked sees us idle and wakes us up. */
+        EnterCriticalSection(&pool->cs);
+        InterlockedIncrement(&pool->idle);
+        timed_out = FALSE;
+        while (!pool->shutdown && !timed_out && !*(LONG volatile *)&pool->pending)
+            timed_out = !SleepConditionVariableCS(&pool->cv, &pool->cs, WORKER_IDLE_TIMEOUT);
+        InterlockedDecrement(&pool->idle);
+
+        /* the default scheduler is never shut down, so idle workers exit
+         * to let the module go */
+        if ((pool->shutdown || timed_out) && !*(LONG volatile *)&pool->pending) {
+            pool->threads--;
+            if (vproc >= 0)
+                pool->queues[vproc].owned = FALSE;
+            LeaveCriticalSection(&pool->cs);
+            break;
+        }
+        LeaveCriticalSection(&pool->cs);
+    }
+
+    TRACE("terminating worker thread for %p\n", pool);
+
+    if (context) {
+        context->pool = NULL;
+        context->vproc = -1;
+    }
+    scheduler_pool_release(pool);
+
+    GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+            (const WCHAR*)scheduler_worker_proc, &module);
+    FreeLibraryAndExitThread(module, 0);
+    return 0;
+}
+
+/* Called with the pool lock held. */
+static void scheduler_pool_start_thread(struct scheduler_pool *pool)
+{
+    HMODULE module;
+    HANDLE thread;
+
+    InterlockedIncrement(&pool->ref);
+    GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS,
+            (const WCHAR*)scheduler_worker_proc, &module);
+    thread = CreateThread(NULL, 0, scheduler_worker_proc, pool, 0, NULL);
+    if (!thread) {
+        ERR("failed to create worker thread\n");
+        FreeLibrary(module);
+        InterlockedDecrement(&pool->ref);
+        return;
+    }
+
+    if (pool->priority != INHERIT_THREAD_PRIORITY)
+        SetThreadPriority(thread, pool->priority);
+    CloseHandle(thread);
+    pool->threads++;
+}
+
+static void scheduler_pool_wake(struct scheduler_pool *pool)
+{
+    EnterCriticalSection(&pool->cs);
+    if (pool->idle)
+        WakeConditionVariable(&pool->cv);
+    else if (pool->threads < pool->max_threads)
+        scheduler_pool_start_thread(pool);
+    LeaveCriticalSection(&pool->cs);
+}
+
+static void scheduler_pool_oversubscribe(struct scheduler_pool *pool, BOOL begin)
+{
+    if (!begin) {
+        InterlockedDecrement(&pool->max_threads);
+        return;
+    }
+
+    InterlockedIncrement(&pool->max_threads);
+    if (*(LONG volatile *)&pool->pending)
+        scheduler_pool_wake(pool);
+}
+
+static void scheduler_pool_shutdown(struct scheduler_pool *pool)
+{
+    EnterCriticalSection(&pool->cs);
+    pool->shutdown = TRUE;
+    WakeAllConditionVariable(&pool->cv);
+    LeaveCriticalSection(&pool->cs);
+    scheduler_pool_release(pool);
+}
+
 static void ThreadScheduler_dtor(ThreadScheduler *this)
 {
     int i;
 
     if(this->ref != 0) WARN("ref = %d\n", this->ref);
     SchedulerPolicy_dtor(&this->policy);
+    scheduler_pool_shutdown(this->pool);
 
     for(i=0; i<this->shutdown_count; i++)
         SetEvent(this->shutdown_events[i]);
@@ -717,18 +1052,50 @@ DEFINE_THISCALL_WRAPPER(ThreadScheduler_CreateScheduleGroup, 4)
     return NULL;
 }
 
+static void schedule_task(ThreadScheduler *this, void (__cdecl *proc)(void*), void *data)
+{
+    ExternalContextBase *context = (ExternalContextBase*)try_get_current_context();
+    struct scheduler_pool *pool = this->pool;
+    struct scheduled_task task;
+    unsigned int queue;
+
+    task.proc = proc;
+    task.data = data;
+    task.scheduler = this;
+
+    /* tasks scheduled from a worker go to its own queue */
+    if (context && context->context.vtable == &MSVCRT_ExternalContextBase_vtable &&
+            context->pool == pool && context->vproc >= 0)
+        queue = context->vproc;
+    else
+        queue = (unsigned int)InterlockedIncrement(&pool->next_queue) % pool->queue_count;
+
+    ThreadScheduler_Reference(this);
+    if (!task_queue_push(&pool->queues[queue], &task)) {
+        ThreadScheduler_Release(this);
+        throw_exception(EXCEPTION_SCHEDULER_RESOURCE_ALLOCATION_ERROR, E_OUTOFMEMORY, NULL);
+    }
+    InterlockedIncrement(&pool->pending);
+    scheduler_pool_wake(pool);
+}
+
 DEFINE_THISCALL_WRAPPER(ThreadScheduler_ScheduleTask_loc, 16)
 void __thiscall ThreadScheduler_ScheduleTask_loc(ThreadScheduler *this,
         void (__cdecl *proc)(void*), void* data, /*location*/void *placement)
 {
-    FIXME("(%p %p %p %p) stub\n", this, proc, data, placement);
+    static int once;
+
+    TRACE("(%p %p %p %p)\n", this, proc, data, placement);
+    if (!once++) FIXME("placement ignored\n");
+    schedule_task(this, proc, data);
 }
 
 DEFINE_THISCALL_WRAPPER(ThreadScheduler_ScheduleTask, 12)
 void __thiscall ThreadScheduler_ScheduleTask(ThreadScheduler *this,
         void (__cdecl *proc)(void*), void* data)
 {
-    FIXME("(%p %p %p) stub\n", this, proc, data);
+    TRACE("(%p %p %p)\n", this, proc, data);
+    schedule_task(this, proc, data);
 }
 
 DEFINE_THISCALL_WRAPPER(ThreadScheduler_IsAvailableLocation, 8)
@@ -762,6 +1129,7 @@ Scheduler* __thiscall ThreadScheduler_vector_dtor(ThreadScheduler *this, unsigne
 static ThreadScheduler* ThreadScheduler_ctor(ThreadScheduler *this,
         const SchedulerPolicy *policy)
 {
+    unsigned int min_concurrency, max_concurrency;
     SYSTEM_INFO si;
 
     TRACE("(%p)->()\n", this);
@@ -772,13 +1140,28 @@ static ThreadScheduler* ThreadScheduler_ctor(ThreadScheduler *this,
     SchedulerPolicy_copy_ctor(&this->policy, policy);
 
     GetSystemInfo(&si);
-    this->virt_proc_no = SchedulerPolicy_GetPolicyValue(&this->policy, MaxConcurrency);
+    /* MaxExecutionResources (-1) stands for the number of processors */
+    min_concurrency = SchedulerPolicy_GetPolicyValue(&this->policy, MinConcurrency);
+    if(min_concurrency == -1)
+        min_concurrency = si.dwNumberOfProcessors;
+    max_concurrency = SchedulerPolicy_GetPolicyValue(&this->policy, MaxConcurrency);
+    if(max_concurrency == -1)
+        max_concurrency = si.dwNumberOfProcessors;
+
+    this->virt_proc_no = max_concurrency;
     if(this->virt_proc_no > si.dwNumberOfProcessors)
         this->virt_proc_no = si.dwNumberOfProcessors;
+    if(this->virt_proc_no < min_concurrency)
+        this->virt_proc_no = min_concurrency;
 
     this->shutdown_count = this->shutdown_size = 0;
     this->shutdown_events = NULL;
 
+    /* worker threads are only started when tasks are scheduled, workers
+     * beyond the processor count share the queues of the others */
+    this->pool = scheduler_pool_create(min(this->virt_proc_no, si.dwNumberOfProcessors),
+            this->virt_proc_no, SchedulerPolicy_GetPolicyValue(&this->policy, ContextPriority));
+
     InitializeCriticalSection(&this->cs);
     this->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": ThreadScheduler");
     return this;
@@ -681,6 +681,199 @@ static inline void bnum_mult(struct bnum *b, int mult)
     }
 }
 
+/* Truncated 128-bit approximations of powers of five, normalized so that the
+ * top bit is set. Used by the fast path for decimal numbers with exponents
+ * in the range below. */
+#define POW5_MIN_EXP -64
+#define POW5_MAX_EXP 64
+static const ULONGLONG pow5_128[][2] =
+{
+    { 0xa87fea27a539e9a5, 0x3f2398d747b36224 }, /* 5^-64 */
+    { 0xd29fe4b18e88640e, 0x8eec7f0d19a03aad }, /* 5^-63 */
+    { 0x83a3eeeef9153e89, 0x1953cf68300424ac }, /* 5^-62 */
+    { 0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7 }, /* 5^-61 */
+    { 0xcdb02555653131b6, 0x3792f412cb06794d }, /* 5^-60 */
+    { 0x808e17555f3ebf11, 0xe2bbd88bbee40bd0 }, /* 5^-59 */
+    { 0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4 }, /* 5^-58 */
+    { 0xc8de047564d20a8b, 0xf245825a5a445275 }, /* 5^-57 */
+    { 0xfb158592be068d2e, 0xeed6e2f0f0d56712 }, /* 5^-56 */
+    { 0x9ced737bb6c4183d, 0x55464dd69685606b }, /* 5^-55 */
+    { 0xc428d05aa4751e4c, 0xaa97e14c3c26b886 }, /* 5^-54 */
+    { 0xf53304714d9265df, 0xd53dd99f4b3066a8 }, /* 5^-53 */
+    { 0x993fe2c6d07b7fab, 0xe546a8038efe4029 }, /* 5^-52 */
+    { 0xbf8fdb78849a5f96, 0xde98520472bdd033 }, /* 5^-51 */
+    { 0xef73d256a5c0f77c, 0x963e66858f6d4440 }, /* 5^-50 */
+    { 0x95a8637627989aad, 0xdde7001379a44aa8 }, /* 5^-49 */
+    { 0xbb127c53b17ec159, 0x5560c018580d5d52 }, /* 5^-48 */
+    { 0xe9d71b689dde71af, 0xaab8f01e6e10b4a6 }, /* 5^-47 */
+    { 0x9226712162ab070d, 0xcab3961304ca70e8 }, /* 5^-46 */
+    { 0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22 }, /* 5^-45 */
+    { 0xe45c10c42a2b3b05, 0x8cb89a7db77c506a }, /* 5^-44 */
+    { 0x8eb98a7a9a5b04e3, 0x77f3608e92adb242 }, /* 5^-43 */
+    { 0xb267ed1940f1c61c, 0x55f038b237591ed3 }, /* 5^-42 */
+    { 0xdf01e85f912e37a3, 0x6b6c46dec52f6688 }, /* 5^-41 */
+    { 0x8b61313bbabce2c6, 0x2323ac4b3b3da015 }, /* 5^-40 */
+    { 0xae397d8aa96c1b77, 0xabec975e0a0d081a }, /* 5^-39 */
+    { 0xd9c7dced53c72255, 0x96e7bd358c904a21 }, /* 5^-38 */
+    { 0x881cea14545c7575, 0x7e50d64177da2e54 }, /* 5^-37 */
+    { 0xaa242499697392d2, 0xdde50bd1d5d0b9e9 }, /* 5^-36 */
+    { 0xd4ad2dbfc3d07787, 0x955e4ec64b44e864 }, /* 5^-35 */
+    { 0x84ec3c97da624ab4, 0xbd5af13bef0b113e }, /* 5^-34 */
+    { 0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e }, /* 5^-33 */
+    { 0xcfb11ead453994ba, 0x67de18eda5814af2 }, /* 5^-32 */
+    { 0x81ceb32c4b43fcf4, 0x80eacf948770ced7 }, /* 5^-31 */
+    { 0xa2425ff75e14fc31, 0xa1258379a94d028d }, /* 5^-30 */
+    { 0xcad2f7f5359a3b3e, 0x096ee45813a04330 }, /* 5^-29 */
+    { 0xfd87b5f28300ca0d, 0x8bca9d6e188853fc }, /* 5^-28 */
+    { 0x9e74d1b791e07e48, 0x775ea264cf55347e }, /* 5^-27 */
+    { 0xc612062576589dda, 0x95364afe032a819e }, /* 5^-26 */
+    { 0xf79687aed3eec551, 0x3a83ddbd83f52205 }, /* 5^-25 */
+    { 0x9abe14cd44753b52, 0xc4926a9672793543 }, /* 5^-24 */
+    { 0xc16d9a0095928a27, 0x75b7053c0f178294 }, /* 5^-23 */
+    { 0xf1c90080baf72cb1, 0x5324c68b12dd6339 }, /* 5^-22 */
+    { 0x971da05074da7bee, 0xd3f6fc16ebca5e04 }, /* 5^-21 */
+    { 0xbce5086492111aea, 0x88f4bb1ca6bcf585 }, /* 5^-20 */
+    { 0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6 }, /* 5^-19 */
+    { 0x9392ee8e921d5d07, 0x3aff322e62439fd0 }, /* 5^-18 */
+    { 0xb877aa3236a4b449, 0x09befeb9fad487c3 }, /* 5^-17 */
+    { 0xe69594bec44de15b, 0x4c2ebe687989a9b4 }, /* 5^-16 */
+    { 0x901d7cf73ab0acd9, 0x0f9d37014bf60a11 }, /* 5^-15 */
+    { 0xb424dc35095cd80f, 0x538484c19ef38c95 }, /* 5^-14 */
+    { 0xe12e13424bb40e13, 0x2865a5f206b06fba }, /* 5^-13 */
+    { 0x8cbccc096f5088cb, 0xf93f87b7442e45d4 }, /* 5^-12 */
+    { 0xafebff0bcb24aafe, 0xf78f69a51539d749 }, /* 5^-11 */
+    { 0xdbe6fecebdedd5be, 0xb573440e5a884d1c }, /* 5^-10 */
+    { 0x89705f4136b4a597, 0x31680a88f8953031 }, /* 5^-9 */
+    { 0xabcc77118461cefc, 0xfdc20d2b36ba7c3e }, /* 5^-8 */
+    { 0xd6bf94d5e57a42bc, 0x3d32907604691b4d }, /* 5^-7 */
+    { 0x8637bd05af6c69b5, 0xa63f9a49c2c1b110 }, /* 5^-6 */
+    { 0xa7c5ac471b478423, 0x0fcf80dc33721d54 }, /* 5^-5 */
+    { 0xd1b71758e219652b, 0xd3c36113404ea4a9 }, /* 5^-4 */
+    { 0x83126e978d4fdf3b, 0x645a1cac083126ea }, /* 5^-3 */
+    { 0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4 }, /* 5^-2 */
+    { 0xcccccccccccccccc, 0xcccccccccccccccd }, /* 5^-1 */
+    { 0x8000000000000000, 0x0000000000000000 }, /* 5^0 */
+    { 0xa000000000000000, 0x0000000000000000 }, /* 5^1 */
+    { 0xc800000000000000, 0x0000000000000000 }, /* 5^2 */
+    { 0xfa00000000000000, 0x0000000000000000 }, /* 5^3 */
+    { 0x9c40000000000000, 0x0000000000000000 }, /* 5^4 */
+    { 0xc350000000000000, 0x0000000000000000 }, /* 5^5 */
+    { 0xf424000000000000, 0x0000000000000000 }, /* 5^6 */
+    { 0x9896800000000000, 0x0000000000000000 }, /* 5^7 */
+    { 0xbebc200000000000, 0x0000000000000000 }, /* 5^8 */
+    { 0xee6b280000000000, 0x0000000000000000 }, /* 5^9 */
+    { 0x9502f90000000000, 0x0000000000000000 }, /* 5^10 */
+    { 0xba43b74000000000, 0x0000000000000000 }, /* 5^11 */
+    { 0xe8d4a51000000000, 0x0000000000000000 }, /* 5^12 */
+    { 0x9184e72a00000000, 0x0000000000000000 }, /* 5^13 */
+    { 0xb5e620f480000000, 0x0000000000000000 }, /* 5^14 */
+    { 0xe35fa931a0000000, 0x0000000000000000 }, /* 5^15 */
+    { 0x8e1bc9bf04000000, 0x0000000000000000 }, /* 5^16 */
+    { 0xb1a2bc2ec5000000, 0x0000000000000000 }, /* 5^17 */
+    { 0xde0b6b3a76400000, 0x0000000000000000 }, /* 5^18 */
+    { 0x8ac7230489e80000, 0x0000000000000000 }, /* 5^19 */
+    { 0xad78ebc5ac620000, 0x0000000000000000 }, /* 5^20 */
+    { 0xd8d726b7177a8000, 0x0000000000000000 }, /* 5^21 */
+    { 0x878678326eac9000, 0x0000000000000000 }, /* 5^22 */
+    { 0xa968163f0a57b400, 0x0000000000000000 }, /* 5^23 */
+    { 0xd3c21bcecceda100, 0x0000000000000000 }, /* 5^24 */
+    { 0x84595161401484a0, 0x0000000000000000 }, /* 5^25 */
+    { 0xa56fa5b99019a5c8, 0x0000000000000000 }, /* 5^26 */
+    { 0xcecb8f27f4200f3a, 0x0000000000000000 }, /* 5^27 */
+    { 0x813f3978f8940984, 0x4000000000000000 }, /* 5^28 */
+    { 0xa18f07d736b90be5, 0x5000000000000000 }, /* 5^29 */
+    { 0xc9f2c9cd04674ede, 0xa400000000000000 }, /* 5^30 */
+    { 0xfc6f7c4045812296, 0x4d00000000000000 }, /* 5^31 */
+    { 0x9dc5ada82b70b59d, 0xf020000000000000 }, /* 5^32 */
+    { 0xc5371912364ce305, 0x6c28000000000000 }, /* 5^33 */
+    { 0xf684df56c3e01bc6, 0xc732000000000000 }, /* 5^34 */
+    { 0x9a130b963a6c115c, 0x3c7f400000000000 }, /* 5^35 */
+    { 0xc097ce7bc90715b3, 0x4b9f100000000000 }, /* 5^36 */
+    { 0xf0bdc21abb48db20, 0x1e86d40000000000 }, /* 5^37 */
+    { 0x96769950b50d88f4, 0x1314448000000000 }, /* 5^38 */
+    { 0xbc143fa4e250eb31, 0x17d955a000000000 }, /* 5^39 */
+    { 0xeb194f8e1ae525fd, 0x5dcfab0800000000 }, /* 5^40 */
+    { 0x92efd1b8d0cf37be, 0x5aa1cae500000000 }, /* 5^41 */
+    { 0xb7abc627050305ad, 0xf14a3d9e40000000 }, /* 5^42 */
+    { 0xe596b7b0c643c719, 0x6d9ccd05d0000000 }, /* 5^43 */
+    { 0x8f7e32ce7bea5c6f, 0xe4820023a2000000 }, /* 5^44 */
+    { 0xb35dbf821ae4f38b, 0xdda2802c8a800000 }, /* 5^45 */
+    { 0xe0352f62a19e306e, 0xd50b2037ad200000 }, /* 5^46 */
+    { 0x8c213d9da502de45, 0x4526f422cc340000 }, /* 5^47 */
+    { 0xaf298d050e4395d6, 0x9670b12b7f410000 }, /* 5^48 */
+    { 0xdaf3f04651d47b4c, 0x3c0cdd765f114000 }, /* 5^49 */
+    { 0x88d8762bf324cd0f, 0xa5880a69fb6ac800 }, /* 5^50 */
+    { 0xab0e93b6efee0053, 0x8eea0d047a457a00 }, /* 5^51 */
+    { 0xd5d238a4abe98068, 0x72a4904598d6d880 }, /* 5^52 */
+    { 0x85a36366eb71f041, 0x47a6da2b7f864750 }, /* 5^53 */
+    { 0xa70c3c40a64e6c51, 0x999090b65f67d924 }, /* 5^54 */
+    { 0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d }, /* 5^55 */
+    { 0x82818f1281ed449f, 0xbff8f10e7a8921a4 }, /* 5^56 */
+    { 0xa321f2d7226895c7, 0xaff72d52192b6a0d }, /* 5^57 */
+    { 0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490 }, /* 5^58 */
+    { 0xfee50b7025c36a08, 0x02f236d04753d5b4 }, /* 5^59 */
+    { 0x9f4f2726179a2245, 0x01d762422c946590 }, /* 5^60 */
+    { 0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5 }, /* 5^61 */
+    { 0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2 }, /* 5^62 */
+    { 0x9b934c3b330c8577, 0x63cc55f49f88eb2f }, /* 5^63 */
+    { 0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb }  /* 5^64 */
+};
+
+/* Returns low 64 bits of a*b, stores high bits in hi */
+static inline ULONGLONG umul128(ULONGLONG a, ULONGLONG b, ULONGLONG *hi)
+{
+    ULONGLONG a_lo = (DWORD)a, a_hi = a >> 32, b_lo = (DWORD)b, b_hi = b >> 32;
+    ULONGLONG lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    ULONGLONG cross = (lo_lo >> 32) + (DWORD)hi_lo + lo_hi;
+
+    *hi = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    return (cross << 32) | (DWORD)lo_lo;
+}
+
+/* Converts w*10^q to double using the Eisel-Lemire algorithm. Returns FALSE
+ * if the result can't be determined this way, e.g. on ties, subnormals or
+ * overflow, in which case the caller has to use the slow path. */
+static BOOL fast_make_double(int sign, ULONGLONG w, int q, double *ret)
+{
+    ULONGLONG hi, lo, hi2, m, bits;
+    int lz = 0, upper, exp;
+
+    if(!w || q < POW5_MIN_EXP || q > POW5_MAX_EXP) return FALSE;
+
+    while(!(w >> 63)) {
+        w <<= 1;
+        lz++;
+    }
+
+    lo = umul128(w, pow5_128[q - POW5_MIN_EXP][0], &hi);
+    if((hi & 0x1ff) == 0x1ff) {
+        umul128(w, pow5_128[q - POW5_MIN_EXP][1], &hi2);
+        lo += hi2;
+        if(lo < hi2) hi++;
+        if((hi & 0x1ff) == 0x1ff && lo == ~(ULONGLONG)0) return FALSE;
+    }
+
+    upper = hi >> 63;
+    m = hi >> (upper + 9);
+    /* floor(q*log2(10)) + 63 is the binary exponent of the product */
+    exp = ((217706 * q) >> 16) + 63 + upper - lz + 1023;
+    if(lo <= 1 && (m & 3) == 1 && (m << (upper + 9)) == hi) return FALSE;
+    if(exp <= 0) return FALSE;
+
+    m += m & 1;
+    m >>= 1;
+    if(m >= (ULONGLONG)1 << 53) {
+        m = (ULONGLONG)1 << 52;
+        exp++;
+    }
+    if(exp >= 0x7ff) return FALSE;
+
+    bits = (m & (((ULONGLONG)1 << 52) - 1)) | (ULONGLONG)exp << 52;
+    if(sign == -1) bits |= (ULONGLONG)1 << 63;
+    *ret = *(double*)&bits;
+    return TRUE;
+}
+
 double parse_double(MSVCRT_wchar_t (*get)(void *ctx), void (*unget)(void *ctx),
         void *ctx, MSVCRT_pthreadlocinfo locinfo, int *err)
 {
@@ -695,8 +888,11 @@ double parse_double(MSVCRT_wchar_t (*get)(void *ctx), void (*unget)(void *ctx),
     BOOL found_digit = FALSE, found_dp = FALSE, found_sign = FALSE;
     int e2 = 0, dp=0, sign=1, off, limb_digits = 0, i;
     enum round round = ROUND_ZERO;
+    ULONGLONG w = 0; /* first 19 significant digits */
+    int w_digits = 0;
     MSVCRT_wchar_t nch;
     struct bnum b;
+    double d;
 
     nch = get(ctx);
     if(nch == '-') {
@@ -765,6 +961,7 @@ double parse_double(MSVCRT_wchar_t (*get)(void *ctx), void (*unget)(void *ctx),
 
         b.data[BNUM_IDX(b.b)] = b.data[BNUM_IDX(b.b)] * 10 + nch - '0';
         limb_digits++;
+        if(w_digits++ < 19) w = w * 10 + nch - '0';
         nch = get(ctx);
         dp++;
     }
@@ -801,6 +998,7 @@ double parse_double(MSVCRT_wchar_t (*get)(void *ctx), void (*unget)(void *ctx),
 
         b.data[BNUM_IDX(b.b)] = b.data[BNUM_IDX(b.b)] * 10 + nch - '0';
         limb_digits++;
+        if(w_digits++ < 19) w = w * 10 + nch - '0';
         nch = get(ctx);
     }
     while(nch>='0' && nch<='9') {
@@ -855,6 +1053,9 @@ double parse_double(MSVCRT_wchar_t (*get)(void *ctx), void (*unget)(void *ctx),
 
     if(!b.data[BNUM_IDX(b.e-1)]) return make_double(sign, 0, 0, ROUND_ZERO, err);
 
+    if(w_digits <= 19 && dp > INT_MIN + 19 && fast_make_double(sign, w, dp - w_digits, &d))
+        return d;
+
     /* Fill last limb with 0 if needed */
     if(b.b+1 != b.e) {
         for(; limb_digits != LIMB_DIGITS; limb_digits++)
@@ -903,6 +1104,215 @@ double parse_double(MSVCRT_wchar_t (*get)(void *ctx), void (*unget)(void *ctx),
     return make_double(sign, e2, bnum_to_mant(&b), round, err);
 }
 
+static const ULONGLONG pow10_64[] =
+{
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    1000000000, 10000000000, 100000000000, 1000000000000, 10000000000000,
+    100000000000000, 1000000000000000, 10000000000000000, 100000000000000000,
+    1000000000000000000, 10000000000000000000u
+};
+
+/* Returns how the bits of hi:lo below bit n compare to one half of bit n */
+static inline enum round round_bits(ULONGLONG hi, ULONGLONG lo, int n)
+{
+    BOOL half, rest;
+
+    if(n >= 128) return hi || lo ? ROUND_DOWN : ROUND_ZERO;
+    if(n > 64) {
+        half = (hi >> (n - 65)) & 1;
+        rest = lo || (hi & (((ULONGLONG)1 << (n - 65)) - 1));
+    } else {
+        half = (lo >> (n - 1)) & 1;
+        rest = n > 1 && (lo & (((ULONGLONG)1 << (n - 1)) - 1));
+    }
+    if(half) return rest ? ROUND_UP : ROUND_EVEN;
+    return rest ? ROUND_DOWN : ROUND_ZERO;
+}
+
+/* Computes floor(m * 2^e * 10^f) for m < 2^53 and |f| <= 19, and how the
+ * dropped part compares to one half. Returns FALSE if it doesn't fit. */
+static BOOL scale_pow10(ULONGLONG m, int e, int f, ULONGLONG *q, enum round *round)
+{
+    ULONGLONG hi, lo, d, r, frac = 0;
+    int k = -e;
+
+    if(f >= 0) {
+        lo = umul128(m, pow10_64[f], &hi);
+        if(e >= 0) {
+            if(hi || e >= 64 || (e && lo >> (64 - e))) return FALSE;
+            *q = lo << e;
+            *round = ROUND_ZERO;
+            return TRUE;
+        }
+
+        if(k >= 128) *q = 0;
+        else if(k >= 64) *q = hi >> (k - 64);
+        else if(hi >> k) return FALSE;
+        else *q = (hi << (64 - k)) | (lo >> k);
+        *round = round_bits(hi, lo, k);
+        return TRUE;
+    }
+
+    if(e >= 0) {
+        if(e >= 64 || (e && m >> (64 - e))) return FALSE;
+        m <<= e;
+    } else if(k < 64) {
+        frac = m & (((ULONGLONG)1 << k) - 1);
+        m >>= k;
+    } else {
+        frac = m;
+        m = 0;
+    }
+
+    d = pow10_64[-f];
+    *q = m / d;
+    r = m % d;
+    if(r > d / 2 || (r == d / 2 && frac)) *round = ROUND_UP;
+    else if(r == d / 2) *round = ROUND_EVEN;
+    else *round = r || frac ? ROUND_DOWN : ROUND_ZERO;
+    return TRUE;
+}
+
+static char *put_digits(char *p, ULONGLONG v, int count)
+{
+    char *end = p + count;
+
+    while(end > p) {
+        *--end = '0' + v % 10;
+        v /= 10;
+    }
+    return p + count;
+}
+
+static char *put_exponent(char *p, char format, int exp)
+{
+    *p++ = format;
+    *p++ = exp < 0 ? '-' : '+';
+    if(exp < 0) exp = -exp;
+    return put_digits(p, exp, exp >= 100 ? 3 : 2);
+}
+
+/* Removes trailing zeros of the fraction and the decimal point if it's left
+ * alone, like %g does */
+static char *strip_zeros(char *start, char *end)
+{
+    if(!memchr(start, '.', end - start)) return end;
+    while(end[-1] == '0') end--;
+    if(end[-1] == '.') end--;
+    return end;
+}
+
+/* Formats a non-negative finite number the way the host sprintf does with
+ * the %e, %f and %g formats, for precisions that only need 64-bit integer
+ * arithmetic. Returns FALSE if the number has to be formatted by sprintf. */
+BOOL format_double(char *buf, double val, char format, int prec, BOOL alternate)
+{
+    ULONGLONG bits = *(ULONGLONG*)&val, m, q, ip;
+    int e, exp, i, digits;
+    enum round round;
+    char *p = buf;
+
+    if(!format || !strchr("eEfFgG", format)) return FALSE;
+    if(bits >> 63 || (bits >> 52) == 0x7ff) return FALSE;
+    /* sprintf honours the rounding mode */
+    if((_control87(0, 0) & MSVCRT__MCW_RC) != MSVCRT__RC_NEAR) return FALSE;
+
+    m = bits & (((ULONGLONG)1 << 52) - 1);
+    e = bits >> 52;
+    if(e) m |= (ULONGLONG)1 << 52;
+    else e = 1;
+    e -= 1075;
+
+    if(prec < 0) prec = 6;
+
+    if(format == 'f' || format == 'F') {
+        if(prec > 19) return FALSE;
+
+        if(e >= 0) {
+            if(e > 11) return FALSE;
+            ip = m << e;
+            q = 0;
+            round = ROUND_ZERO;
+        } else {
+            ip = -e < 64 ? m >> -e : 0;
+            if(-e < 64) m &= ((ULONGLONG)1 << -e) - 1;
+            if(!scale_pow10(m, e, prec, &q, &round)) return FALSE;
+        }
+
+        if(round == ROUND_UP || (round == ROUND_EVEN && ((prec ? q : ip) & 1))) {
+            if(!prec) ip++;
+            else if(++q == pow10_64[prec]) {
+                q = 0;
+                ip++;
+            }
+        }
+
+        for(digits = 1; digits < 20 && ip >= pow10_64[digits]; digits++);
+        p = put_digits(p, ip, digits);
+        if(prec || alternate) *p++ = '.';
+        p = put_digits(p, q, prec);
+        *p = 0;
+        return TRUE;
+    }
+
+    if(format == 'g' || format == 'G') {
+        if(!prec) prec = 1;
+        digits = prec;
+    } else {
+        digits = prec + 1;
+    }
+    if(digits > 17) return FALSE;
+
+    if(!m) {
+        q = 0;
+        exp = 0;
+    } else {
+        /* start with floor(log10(2^n)), n being the position of the top bit */
+        for(i = 52; !(m >> i); i--);
+        exp = ((e + i) * 78913) >> 18;
+        for(i = 0; ; i++) {
+            if(i == 4 || digits - 1 - exp < -19 || digits - 1 - exp > 19) return FALSE;
+            if(!scale_pow10(m, e, digits - 1 - exp, &q, &round)) return FALSE;
+            if(q >= pow10_64[digits]) exp++;
+            else if(q < pow10_64[digits - 1]) exp--;
+            else break;
+        }
+
+        if(round == ROUND_UP || (round == ROUND_EVEN && (q & 1))) {
+            if(++q == pow10_64[digits]) {
+                /* glibc drops digits from %#g output in this case */
+                if(alternate && (format == 'g' || format == 'G')) return FALSE;
+                q = pow10_64[digits - 1];
+                exp++;
+            }
+        }
+    }
+
+    if((format == 'g' || format == 'G') && exp >= -4 && exp < digits) {
+        if(exp >= 0) {
+            p = put_digits(p, q / pow10_64[digits - 1 - exp], exp + 1);
+            if(digits - 1 - exp || alternate) *p++ = '.';
+            p = put_digits(p, q % pow10_64[digits - 1 - exp], digits - 1 - exp);
+        } else {
+            *p++ = '0';
+            *p++ = '.';
+            for(i = exp + 1; i < 0; i++) *p++ = '0';
+            p = put_digits(p, q, digits);
+        }
+        if(!alternate) p = strip_zeros(buf, p);
+        *p = 0;
+        return TRUE;
+    }
+
+    *p++ = '0' + q / pow10_64[digits - 1];
+    if(digits > 1 || alternate) *p++ = '.';
+    p = put_digits(p, q % pow10_64[digits - 1], digits - 1);
+    if((format == 'g' || format == 'G') && !alternate) p = strip_zeros(buf, p);
+    p = put_exponent(p, format == 'g' ? 'e' : format == 'G' ? 'E' : format, exp);
+    *p = 0;
+    return TRUE;
+}
+
 static MSVCRT_wchar_t strtod_str_get(void *ctx)
 {
     const char **p = ctx;
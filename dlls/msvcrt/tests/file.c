@@ -52,6 +52,8 @@ static int (__cdecl *p_fopen_s)(FILE**, const char*, const char*);
 static int (__cdecl *p__wfopen_s)(FILE**, const wchar_t*, const wchar_t*);
 static errno_t (__cdecl *p__get_fmode)(int*);
 static errno_t (__cdecl *p__set_fmode)(int);
+static void (__cdecl *p__lock_file)(FILE*);
+static void (__cdecl *p__unlock_file)(FILE*);
 
 static const char* get_base_name(const char *path)
 {
@@ -76,6 +78,8 @@ static void init(void)
     __pioinfo = (void*)GetProcAddress(hmod, "__pioinfo");
     p__get_fmode = (void*)GetProcAddress(hmod, "_get_fmode");
     p__set_fmode = (void*)GetProcAddress(hmod, "_set_fmode");
+    p__lock_file = (void*)GetProcAddress(hmod, "_lock_file");
+    p__unlock_file = (void*)GetProcAddress(hmod, "_unlock_file");
 }
 
 static void test_filbuf( void )
@@ -2608,6 +2612,62 @@ static void test_lseek(void)
     DeleteFileA("_creat.tst");
 }
 
+static FILE *threads_file;
+
+static DWORD WINAPI fputc_thread(void *arg)
+{
+    int i;
+
+    for (i = 0; i < 1000; i++)
+        fputc('a' + (INT_PTR)arg, threads_file);
+    return 0;
+}
+
+static void test_fputc_threads(void)
+{
+    HANDLE threads[4];
+    int i, c, count[5] = {0};
+
+    if (!p__lock_file)
+    {
+        win_skip("_lock_file not available\n");
+        return;
+    }
+
+    threads_file = fopen("fputc_threads.tst", "wb");
+    ok(threads_file != NULL, "fopen failed\n");
+
+    /* the thread that used the stream first keeps writing while others start */
+    fputc('a' + 4, threads_file);
+    for (i = 1; i < ARRAY_SIZE(threads); i++)
+        threads[i] = CreateThread(NULL, 0, fputc_thread, (void *)(INT_PTR)i, 0, NULL);
+    for (i = 1; i < 1000; i++)
+        fputc('a' + 4, threads_file);
+    ok(WaitForMultipleObjects(ARRAY_SIZE(threads) - 1, threads + 1, TRUE, 5000) == WAIT_OBJECT_0,
+       "threads didn't finish\n");
+
+    /* a thread started while the stream is locked must wait for it */
+    p__lock_file(threads_file);
+    threads[0] = CreateThread(NULL, 0, fputc_thread, (void *)0, 0, NULL);
+    ok(WaitForSingleObject(threads[0], 100) == WAIT_TIMEOUT, "thread didn't wait for the stream\n");
+    p__unlock_file(threads_file);
+    ok(WaitForSingleObject(threads[0], 5000) == WAIT_OBJECT_0, "thread didn't finish\n");
+    for (i = 0; i < ARRAY_SIZE(threads); i++) CloseHandle(threads[i]);
+    fclose(threads_file);
+
+    threads_file = fopen("fputc_threads.tst", "rb");
+    ok(threads_file != NULL, "fopen failed\n");
+    while ((c = fgetc(threads_file)) != EOF)
+    {
+        ok(c >= 'a' && c < 'a' + ARRAY_SIZE(count), "unexpected char %d\n", c);
+        if (c >= 'a' && c < 'a' + ARRAY_SIZE(count)) count[c - 'a']++;
+    }
+    for (i = 0; i < ARRAY_SIZE(count); i++)
+        ok(count[i] == 1000, "got %d chars from thread %d\n", count[i], i);
+    fclose(threads_file);
+    DeleteFileA("fputc_threads.tst");
+}
+
 START_TEST(file)
 {
     int arg_c;
@@ -2656,6 +2716,7 @@ START_TEST(file)
     test_readboundary();
     test_fgetc();
     test_fputc();
+    test_fputc_threads();
     test_flsbuf();
     test_fflush();
     test_fgetwc();
@@ -456,6 +456,78 @@ static void test_sbheap(void)
     free(mem);
 }
 
+static DWORD WINAPI small_blocks_thread(void *arg)
+{
+    void **blocks = arg;
+    int i;
+
+    for (i = 0; i < 64; i++)
+    {
+        blocks[i] = malloc(i * 16 + 1);
+        memset(blocks[i], i, i * 16 + 1);
+    }
+    return 0;
+}
+
+static void test_small_blocks(void)
+{
+    void *blocks[64];
+    unsigned char *mem;
+    _HEAPINFO info;
+    HANDLE thread;
+    size_t size;
+    int i, j;
+
+    mem = malloc(24);
+    ok(mem != NULL, "malloc failed\n");
+    memset(mem, 0x55, 24);
+    size = _msize(mem);
+    ok(size == 24, "_msize returned %lu\n", (unsigned long)size);
+    ok(_expand(mem, 20) == mem, "_expand failed\n");
+    ok(_msize(mem) == 20, "_msize returned %lu\n", (unsigned long)_msize(mem));
+
+    memset(&info, 0, sizeof(info));
+    while ((i = _heapwalk(&info)) == _HEAPOK)
+        if ((unsigned char *)info._pentry == mem) break;
+    ok(i == _HEAPOK, "block not found, _heapwalk returned %d\n", i);
+    ok(info._useflag == _USEDENTRY, "got flags %d\n", info._useflag);
+    ok(info._size == 20, "got size %lu\n", (unsigned long)info._size);
+
+    mem = realloc(mem, 2000);
+    ok(mem != NULL, "realloc failed\n");
+    for (i = 0; i < 20; i++)
+        if (mem[i] != 0x55) break;
+    ok(i == 20, "data not preserved at %d\n", i);
+    mem = realloc(mem, 8);
+    ok(mem != NULL, "realloc failed\n");
+    ok(mem[0] == 0x55 && mem[7] == 0x55, "data not preserved\n");
+    free(mem);
+
+    /* blocks freed by another thread */
+    thread = CreateThread(NULL, 0, small_blocks_thread, blocks, 0, NULL);
+    ok(WaitForSingleObject(thread, 5000) == WAIT_OBJECT_0, "thread didn't finish\n");
+    CloseHandle(thread);
+    for (i = 0; i < 64; i++)
+    {
+        ok(blocks[i] != NULL, "block %d not allocated\n", i);
+        ok(_msize(blocks[i]) == i * 16 + 1, "_msize(%d) returned %lu\n", i, (unsigned long)_msize(blocks[i]));
+        for (j = 0; j < i * 16 + 1; j++)
+            if (((unsigned char *)blocks[i])[j] != i) break;
+        ok(j == i * 16 + 1, "block %d corrupted at %d\n", i, j);
+        free(blocks[i]);
+    }
+
+    for (i = 0; i < 64; i++)
+    {
+        blocks[i] = calloc(1, i * 16 + 1);
+        ok(blocks[i] != NULL, "calloc failed\n");
+        for (j = 0; j < i * 16 + 1; j++)
+            if (((unsigned char *)blocks[i])[j]) break;
+        ok(j == i * 16 + 1, "block %d not zeroed at %d\n", i, j);
+    }
+    for (i = 0; i < 64; i++) free(blocks[i]);
+}
+
 static void test_calloc(void)
 {
     /* use function pointer to bypass gcc builtin */
@@ -508,4 +580,5 @@ START_TEST(heap)
     test_aligned();
     test_sbheap();
     test_calloc();
+    test_small_blocks();
 }
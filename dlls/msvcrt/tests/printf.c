@@ -209,6 +209,7 @@ static void test_sprintf( void )
         { "% 2.4e", "-8.6000e+000", 0, DOUBLE_ARG, 0, 0, -8.6 },
         { "%+2.4e", "+8.6000e+000", 0, DOUBLE_ARG, 0, 0, 8.6 },
         { "%2.4g", "8.6", 0, DOUBLE_ARG, 0, 0, 8.6 },
+        { "%.1a", "0x1.0p+0", 0, DOUBLE_ARG, 0, 0, 1.0 },
         { "%-i", "-1", 0, INT_ARG, -1 },
         { "%-i", "1", 0, INT_ARG, 1 },
         { "%+i", "+1", 0, INT_ARG, 1 },
@@ -253,6 +254,29 @@ static void test_sprintf( void )
         { "%.0f", "2", 0, DOUBLE_ARG, 0, 0, 1.5 },
         { "%.30f", "0.333333333333333310000000000000", 0, TODO_FLAG | DOUBLE_ARG, 0, 0, 1.0/3.0 },
         { "%.30lf", "1.414213562373095100000000000000", 0, TODO_FLAG | DOUBLE_ARG, 0, 0, sqrt(2) },
+        { "%.0f", "3", 0, TODO_FLAG | DOUBLE_ARG, 0, 0, 2.5 },
+        { "%.1f", "0.3", 0, TODO_FLAG | DOUBLE_ARG, 0, 0, 0.25 },
+        { "%.2e", "1.13e+000", 0, TODO_FLAG | DOUBLE_ARG, 0, 0, 1.125 },
+        { "%.2e", "1.38e+000", 0, DOUBLE_ARG, 0, 0, 1.375 },
+        { "%.0e", "3e+000", 0, TODO_FLAG | DOUBLE_ARG, 0, 0, 2.5 },
+        { "%.2f", "9.99", 0, DOUBLE_ARG, 0, 0, 9.995 },
+        { "%.2f", "10.00", 0, DOUBLE_ARG, 0, 0, 9.999 },
+        { "%.2e", "1.00e+001", 0, DOUBLE_ARG, 0, 0, 9.999 },
+        { "%g", "999999", 0, DOUBLE_ARG, 0, 0, 999999.4 },
+        { "%g", "1e+006", 0, DOUBLE_ARG, 0, 0, 999999.7 },
+        { "%#g", "1.00000e+006", 0, TODO_FLAG | DOUBLE_ARG, 0, 0, 999999.7 },
+        { "%#g", "1.00000", 0, DOUBLE_ARG, 0, 0, 1.0 },
+        { "%#g", "0.000100000", 0, DOUBLE_ARG, 0, 0, 0.0001 },
+        { "%g", "0.0001", 0, DOUBLE_ARG, 0, 0, 0.0001 },
+        { "%#.3g", "100.", 0, DOUBLE_ARG, 0, 0, 100.0 },
+        { "%#.0f", "1.", 0, DOUBLE_ARG, 0, 0, 1.0 },
+        { "%g", "4.94066e-324", 0, DOUBLE_ARG, 0, 0, 4.9406564584124654e-324 },
+        { "%.3e", "2.225e-308", 0, DOUBLE_ARG, 0, 0, 2.2250738585072009e-308 },
+        { "%.0f", "100000000000000000000", 0, DOUBLE_ARG, 0, 0, 1e20 },
+        { "%.0f", "18446744073709552000", 0, TODO_FLAG | DOUBLE_ARG, 0, 0, 18446744073709551616.0 },
+        { "%.16e", "3.3333333333333331e-001", 0, DOUBLE_ARG, 0, 0, 1.0/3.0 },
+        { "%.17e", "3.33333333333333310e-001", 0, TODO_FLAG | DOUBLE_ARG, 0, 0, 1.0/3.0 },
+        { "%.17g", "0.10000000000000001", 0, DOUBLE_ARG, 0, 0, 0.1 },
     };
 
     char buffer[100];
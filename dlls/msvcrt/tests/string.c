@@ -1961,6 +1961,10 @@ static void test__strtod(void)
         { ".00", 3, 0 },
         { "-0.", 3, 0 },
         { "0e13", 4, 0 },
+        { "123456789012345678", 18, 123456789012345678.0 },
+        { "0.000001", 8, 0.000001 },
+        { "1e23", 4, 1e23 },
+        { "-7.2057594037927933e16", 22, -7.2057594037927933e16 },
     };
     const char overflow[] = "1d9999999999999999999";
 
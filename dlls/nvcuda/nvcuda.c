@@ -49,13 +49,6 @@ WINE_DEFAULT_DEBUG_CHANNEL(nvcuda);
 
 struct stream_callback_entry
 {
-    struct list entry;
-    enum
-    {
-        STREAM_CALLBACK_ABANDONED,
-        STREAM_CALLBACK_PENDING,
-        STREAM_CALLBACK_EXECUTED
-    } status;
     void (WINAPI *callback)(CUstream hStream, CUresult status, void *userData);
     struct
     {
@@ -63,13 +56,34 @@ struct stream_callback_entry
         CUresult status;
         void *userdata;
     } args;
+#ifdef HAVE_CLOCK_GETTIME
+    struct timespec queued;
+#endif
+};
+
+/* Stream callbacks are invoked on native CUDA threads and have to run on Wine
+ * threads. The driver doesn't run the next callback of a stream before the
+ * previous one returned, so per-stream ordering is preserved as long as the
+ * native thread waits; callbacks of different streams are dispatched to
+ * different workers and may run concurrently. */
+#define MAX_STREAM_CALLBACK_WORKERS 8
+
+struct stream_callback_worker
+{
+    LONG busy;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    struct stream_callback_entry *entry;    /* callback to run, NULL when done */
 };
 
-static struct list stream_callbacks            = LIST_INIT( stream_callbacks );
+static struct stream_callback_worker stream_callback_workers[MAX_STREAM_CALLBACK_WORKERS];
+static LONG num_stream_callback_workers;
+static LONG num_stream_callbacks;
+
+/* only used when all workers are busy */
 static pthread_mutex_t stream_callback_mutex   = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t  stream_callback_request = PTHREAD_COND_INITIALIZER;
-static pthread_cond_t  stream_callback_reply   = PTHREAD_COND_INITIALIZER;
-LONG num_stream_callbacks;
+static pthread_cond_t  stream_callback_idle    = PTHREAD_COND_INITIALIZER;
+static LONG num_stream_callback_waiters;
 
 static CUresult (*pcuArray3DCreate)(CUarray *pHandle, const CUDA_ARRAY3D_DESCRIPTOR *pAllocateArray);
 static CUresult (*pcuArray3DCreate_v2)(CUarray *pHandle, const CUDA_ARRAY3D_DESCRIPTOR *pAllocateArray);
@@ -2016,67 +2030,140 @@ CUresult WINAPI wine_cuPointerSetAttribute(const void *value, CUpointer_attribut
 
 static DWORD WINAPI stream_callback_worker_thread(LPVOID parameter)
 {
+    struct stream_callback_worker *worker = parameter;
     struct stream_callback_entry *wrapper;
-    struct list *ptr;
-    pthread_mutex_lock(&stream_callback_mutex);
 
+    pthread_mutex_lock(&worker->mutex);
     for (;;)
     {
-        while ((ptr = list_head(&stream_callbacks)))
+        while (!(wrapper = worker->entry))
+            pthread_cond_wait(&worker->cond, &worker->mutex);
+        pthread_mutex_unlock(&worker->mutex);
+
+        if (TRACE_ON(nvcuda))
         {
-            wrapper = LIST_ENTRY(ptr, struct stream_callback_entry, entry);
-            list_remove(&wrapper->entry);
-
-            switch (wrapper->status)
-            {
-                case STREAM_CALLBACK_ABANDONED:
-                    free(wrapper);
-                    break;
-
-                case STREAM_CALLBACK_PENDING:
-                    pthread_mutex_unlock(&stream_callback_mutex);
-
-                    TRACE("calling stream callback %p(%p, %d, %p)\n", wrapper->callback,
-                          wrapper->args.stream, wrapper->args.status, wrapper->args.userdata);
-                    wrapper->callback(wrapper->args.stream, wrapper->args.status, wrapper->args.userdata);
-                    TRACE("stream callback %p returned\n", wrapper->callback);
-
-                    wrapper->status = STREAM_CALLBACK_EXECUTED;
-                    pthread_cond_broadcast(&stream_callback_reply);
-                    pthread_mutex_lock(&stream_callback_mutex);
-                    break;
-
-                default:
-                    assert(0); /* never reached */
-            }
-
-            if (!--num_stream_callbacks)
-                goto end;
+#ifdef HAVE_CLOCK_GETTIME
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            TRACE("dispatched stream callback %p after %ld us\n", wrapper->callback,
+                  (long)((now.tv_sec - wrapper->queued.tv_sec) * 1000000 +
+                         (now.tv_nsec - wrapper->queued.tv_nsec) / 1000));
+#endif
+            TRACE("calling stream callback %p(%p, %d, %p)\n", wrapper->callback,
+                  wrapper->args.stream, wrapper->args.status, wrapper->args.userdata);
         }
+        wrapper->callback(wrapper->args.stream, wrapper->args.status, wrapper->args.userdata);
+        TRACE("stream callback %p returned\n", wrapper->callback);
 
-        pthread_cond_wait(&stream_callback_request, &stream_callback_mutex);
+        pthread_mutex_lock(&worker->mutex);
+        worker->entry = NULL;
+        pthread_cond_broadcast(&worker->cond);
     }
 
-end:
-    pthread_mutex_unlock(&stream_callback_mutex);
     return 0;
 }
 
+static struct stream_callback_worker *try_acquire_stream_callback_worker(void)
+{
+    LONG i, count = num_stream_callback_workers;
+
+    for (i = 0; i < count; i++)
+    {
+        if (!InterlockedCompareExchange(&stream_callback_workers[i].busy, 1, 0))
+            return &stream_callback_workers[i];
+    }
+    return NULL;
+}
+
+static struct stream_callback_worker *acquire_stream_callback_worker(void)
+{
+    struct stream_callback_worker *worker;
+
+    if ((worker = try_acquire_stream_callback_worker()))
+        return worker;
+
+    /* more streams are waiting for callbacks than there are workers */
+    pthread_mutex_lock(&stream_callback_mutex);
+    InterlockedIncrement(&num_stream_callback_waiters);
+    while (!(worker = try_acquire_stream_callback_worker()))
+        pthread_cond_wait(&stream_callback_idle, &stream_callback_mutex);
+    InterlockedDecrement(&num_stream_callback_waiters);
+    pthread_mutex_unlock(&stream_callback_mutex);
+    return worker;
+}
+
+static void release_stream_callback_worker(struct stream_callback_worker *worker)
+{
+    InterlockedExchange(&worker->busy, 0);
+    if (num_stream_callback_waiters)
+    {
+        pthread_mutex_lock(&stream_callback_mutex);
+        pthread_cond_broadcast(&stream_callback_idle);
+        pthread_mutex_unlock(&stream_callback_mutex);
+    }
+}
+
 static void stream_callback_wrapper(CUstream hStream, CUresult status, void *userData)
 {
     struct stream_callback_entry *wrapper = userData;
-    wrapper->status         = STREAM_CALLBACK_PENDING;
+    struct stream_callback_worker *worker;
+
     wrapper->args.stream    = hStream;
     wrapper->args.status    = status;
+#ifdef HAVE_CLOCK_GETTIME
+    clock_gettime(CLOCK_MONOTONIC, &wrapper->queued);
+#endif
+
+    worker = acquire_stream_callback_worker();
+
+    pthread_mutex_lock(&worker->mutex);
+    worker->entry = wrapper;
+    pthread_cond_broadcast(&worker->cond);
+    while (worker->entry)
+        pthread_cond_wait(&worker->cond, &worker->mutex);
+    pthread_mutex_unlock(&worker->mutex);
+
+    release_stream_callback_worker(worker);
+    InterlockedDecrement(&num_stream_callbacks);
+    free(wrapper);
+}
+
+/* makes sure there is a worker for each pending callback, up to the limit */
+static BOOL start_stream_callback_workers(LONG pending)
+{
+    struct stream_callback_worker *worker;
+    HANDLE thread;
+    BOOL ret = TRUE;
+
+    if (pending <= num_stream_callback_workers || num_stream_callback_workers >= MAX_STREAM_CALLBACK_WORKERS)
+        return TRUE;
+
     pthread_mutex_lock(&stream_callback_mutex);
+    while (pending > num_stream_callback_workers && num_stream_callback_workers < MAX_STREAM_CALLBACK_WORKERS)
+    {
+        worker = &stream_callback_workers[num_stream_callback_workers];
+        pthread_mutex_init(&worker->mutex, NULL);
+        pthread_cond_init(&worker->cond, NULL);
+        worker->entry = NULL;
+        worker->busy = 0;
 
-    list_add_tail(&stream_callbacks, &wrapper->entry);
-    pthread_cond_signal(&stream_callback_request);
-    while (wrapper->status == STREAM_CALLBACK_PENDING)
-        pthread_cond_wait(&stream_callback_reply, &stream_callback_mutex);
+        if (!(thread = CreateThread(NULL, 0, stream_callback_worker_thread, worker, 0, NULL)))
+        {
+            pthread_cond_destroy(&worker->cond);
+            pthread_mutex_destroy(&worker->mutex);
+            /* we can still make progress if there is at least one worker */
+            ret = num_stream_callback_workers > 0;
+            break;
+        }
+        CloseHandle(thread);
 
+        /* publish the worker only after it has been initialized */
+        InterlockedIncrement(&num_stream_callback_workers);
+        TRACE("started stream callback worker %d\n", num_stream_callback_workers);
+    }
     pthread_mutex_unlock(&stream_callback_mutex);
-    free(wrapper);
+
+    return ret;
 }
 
 static CUresult stream_add_callback(CUresult (*func)(CUstream, void *, void *, unsigned int),
@@ -2091,35 +2178,18 @@ static CUresult stream_add_callback(CUresult (*func)(CUstream, void *, void *, u
     wrapper->callback       = callback;
     wrapper->args.userdata  = userData;
 
-    /* spawn a new worker thread if necessary */
-    pthread_mutex_lock(&stream_callback_mutex);
-    if (!num_stream_callbacks++)
+    /* spawn new worker threads if necessary */
+    if (!start_stream_callback_workers(InterlockedIncrement(&num_stream_callbacks)))
     {
-        HANDLE thread = CreateThread(NULL, 0, stream_callback_worker_thread, NULL, 0, NULL);
-        if (!thread)
-        {
-            num_stream_callbacks--;
-            pthread_mutex_unlock(&stream_callback_mutex);
-            free(wrapper);
-            return CUDA_ERROR_OUT_OF_MEMORY; /* FIXME */
-        }
-        CloseHandle(thread);
+        InterlockedDecrement(&num_stream_callbacks);
+        free(wrapper);
+        return CUDA_ERROR_OUT_OF_MEMORY; /* FIXME */
     }
-    pthread_mutex_unlock(&stream_callback_mutex);
 
     ret = func(hStream, stream_callback_wrapper, wrapper, flags);
     if (ret)
     {
-        pthread_mutex_lock(&stream_callback_mutex);
-        if (num_stream_callbacks == 1)
-        {
-            wrapper->status = STREAM_CALLBACK_ABANDONED;
-            list_add_tail(&stream_callbacks, &wrapper->entry);
-            pthread_cond_signal(&stream_callback_request);
-            wrapper = NULL;
-        }
-        else num_stream_callbacks--;
-        pthread_mutex_unlock(&stream_callback_mutex);
+        InterlockedDecrement(&num_stream_callbacks);
         free(wrapper);
     }
 
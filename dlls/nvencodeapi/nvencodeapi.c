@@ -24,7 +24,9 @@
 #include "windef.h"
 #include "winbase.h"
 #include "wine/debug.h"
+#include "wine/heap.h"
 #include "wine/library.h"
+#include "wine/list.h"
 
 #include "nvencodeapi.h"
 
@@ -35,6 +37,240 @@ static LINUX_NV_ENCODE_API_FUNCTION_LIST origFunctions;
 
 static NVENCSTATUS (*pNvEncodeAPICreateInstance)(LINUX_NV_ENCODE_API_FUNCTION_LIST *functionList);
 
+/* The linux driver only supports synchronous encoding. Encoders initialized
+ * in async mode get a worker thread which runs the synchronous encode calls in
+ * submission order and signals the completion events afterwards. */
+
+#define MAX_QUEUED_FRAMES 16
+#define LATENCY_REPORT_INTERVAL 256
+
+struct encode_job
+{
+    struct list entry;
+    NV_ENC_PIC_PARAMS params;
+    LARGE_INTEGER submit_time;
+};
+
+struct async_encoder
+{
+    struct list entry;
+    void *encoder;
+    CRITICAL_SECTION cs;
+    CONDITION_VARIABLE work_cv;
+    CONDITION_VARIABLE done_cv;
+    struct list queue;          /* submitted, not yet encoded */
+    struct list waiting;        /* encoded, but the driver wants more input */
+    struct encode_job *current;
+    unsigned int queued;
+    NVENCSTATUS error;
+    BOOL shutdown;
+    HANDLE thread;
+    /* latency statistics */
+    LARGE_INTEGER frequency;
+    unsigned int frames;
+    ULONGLONG latency_total;
+    ULONGLONG latency_max;
+};
+
+static struct list async_encoders = LIST_INIT(async_encoders);
+
+static CRITICAL_SECTION async_encoders_cs;
+static CRITICAL_SECTION_DEBUG async_encoders_cs_debug =
+{
+    0, 0, &async_encoders_cs,
+    { &async_encoders_cs_debug.ProcessLocksList, &async_encoders_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": async_encoders_cs") }
+};
+static CRITICAL_SECTION async_encoders_cs = { &async_encoders_cs_debug, -1, 0, 0, 0, 0 };
+
+static struct async_encoder *get_async_encoder(void *encoder)
+{
+    struct async_encoder *async;
+
+    EnterCriticalSection(&async_encoders_cs);
+    LIST_FOR_EACH_ENTRY(async, &async_encoders, struct async_encoder, entry)
+    {
+        if (async->encoder != encoder) continue;
+        LeaveCriticalSection(&async_encoders_cs);
+        return async;
+    }
+    LeaveCriticalSection(&async_encoders_cs);
+    return NULL;
+}
+
+static void update_latency(struct async_encoder *async, struct encode_job *job, const LARGE_INTEGER *now)
+{
+    ULONGLONG latency = (now->QuadPart - job->submit_time.QuadPart) * 1000000 / async->frequency.QuadPart;
+
+    async->latency_total += latency;
+    if (latency > async->latency_max) async->latency_max = latency;
+
+    if (++async->frames < LATENCY_REPORT_INTERVAL) return;
+
+    TRACE("encoder %p: %u frames, average latency %s us, max %s us\n", async->encoder, async->frames,
+          wine_dbgstr_longlong(async->latency_total / async->frames), wine_dbgstr_longlong(async->latency_max));
+    async->frames = 0;
+    async->latency_total = 0;
+    async->latency_max = 0;
+}
+
+/* called with the encoder lock held */
+static void complete_job(struct async_encoder *async, struct encode_job *job, const LARGE_INTEGER *now)
+{
+    update_latency(async, job, now);
+    if (job->params.completionEvent)
+        SetEvent(job->params.completionEvent);
+    heap_free(job);
+}
+
+static DWORD CALLBACK async_encode_thread(void *arg)
+{
+    struct async_encoder *async = arg;
+    struct encode_job *job, *pending, *next;
+    NVENCSTATUS status;
+    LARGE_INTEGER now;
+
+    TRACE("starting worker for encoder %p\n", async->encoder);
+
+    EnterCriticalSection(&async->cs);
+    for (;;)
+    {
+        while (list_empty(&async->queue) && !async->shutdown)
+            SleepConditionVariableCS(&async->work_cv, &async->cs, INFINITE);
+        if (list_empty(&async->queue)) break;
+
+        job = LIST_ENTRY(list_head(&async->queue), struct encode_job, entry);
+        list_remove(&job->entry);
+        async->current = job;
+        async->queued--;
+        WakeAllConditionVariable(&async->done_cv);
+        LeaveCriticalSection(&async->cs);
+
+        status = origFunctions.nvEncEncodePicture(async->encoder, &job->params);
+        QueryPerformanceCounter(&now);
+
+        EnterCriticalSection(&async->cs);
+        async->current = NULL;
+
+        if (status == NV_ENC_ERR_NEED_MORE_INPUT)
+        {
+            /* the output is produced by a later frame, e.g. with B-frames */
+            list_add_tail(&async->waiting, &job->entry);
+        }
+        else
+        {
+            if (status != NV_ENC_SUCCESS)
+            {
+                WARN("encoding frame %u failed with status %d\n", job->params.frameIdx, status);
+                if (async->error == NV_ENC_SUCCESS) async->error = status;
+            }
+            /* also signal the events on failure, applications would wait forever otherwise */
+            LIST_FOR_EACH_ENTRY_SAFE(pending, next, &async->waiting, struct encode_job, entry)
+            {
+                list_remove(&pending->entry);
+                complete_job(async, pending, &now);
+            }
+            complete_job(async, job, &now);
+        }
+        WakeAllConditionVariable(&async->done_cv);
+    }
+
+    LIST_FOR_EACH_ENTRY_SAFE(job, next, &async->waiting, struct encode_job, entry)
+    {
+        list_remove(&job->entry);
+        heap_free(job);
+    }
+    LeaveCriticalSection(&async->cs);
+
+    TRACE("stopping worker for encoder %p\n", async->encoder);
+    return 0;
+}
+
+static BOOL job_uses_buffer(const struct encode_job *job, void *buffer)
+{
+    return job->params.inputBuffer == buffer || job->params.outputBitstream == buffer;
+}
+
+/* called with the encoder lock held */
+static BOOL is_buffer_busy(struct async_encoder *async, void *buffer)
+{
+    struct encode_job *job;
+
+    if (async->current && job_uses_buffer(async->current, buffer)) return TRUE;
+    LIST_FOR_EACH_ENTRY(job, &async->queue, struct encode_job, entry)
+        if (job_uses_buffer(job, buffer)) return TRUE;
+    LIST_FOR_EACH_ENTRY(job, &async->waiting, struct encode_job, entry)
+        if (job_uses_buffer(job, buffer)) return TRUE;
+    return FALSE;
+}
+
+static void wait_for_buffer(struct async_encoder *async, void *buffer)
+{
+    EnterCriticalSection(&async->cs);
+    while (is_buffer_busy(async, buffer))
+        SleepConditionVariableCS(&async->done_cv, &async->cs, INFINITE);
+    LeaveCriticalSection(&async->cs);
+}
+
+/* waits until all submitted frames have been passed to the driver */
+static void flush_async_encoder(struct async_encoder *async)
+{
+    EnterCriticalSection(&async->cs);
+    while (!list_empty(&async->queue) || async->current)
+        SleepConditionVariableCS(&async->done_cv, &async->cs, INFINITE);
+    LeaveCriticalSection(&async->cs);
+}
+
+static struct async_encoder *create_async_encoder(void *encoder)
+{
+    struct async_encoder *async;
+
+    if (!(async = heap_alloc_zero(sizeof(*async))))
+        return NULL;
+
+    async->encoder = encoder;
+    InitializeCriticalSection(&async->cs);
+    async->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": async_encoder.cs");
+    InitializeConditionVariable(&async->work_cv);
+    InitializeConditionVariable(&async->done_cv);
+    list_init(&async->queue);
+    list_init(&async->waiting);
+    QueryPerformanceFrequency(&async->frequency);
+
+    if (!(async->thread = CreateThread(NULL, 0, async_encode_thread, async, 0, NULL)))
+    {
+        ERR("failed to create worker thread, error %u\n", GetLastError());
+        async->cs.DebugInfo->Spare[0] = 0;
+        DeleteCriticalSection(&async->cs);
+        heap_free(async);
+        return NULL;
+    }
+
+    EnterCriticalSection(&async_encoders_cs);
+    list_add_tail(&async_encoders, &async->entry);
+    LeaveCriticalSection(&async_encoders_cs);
+    return async;
+}
+
+static void destroy_async_encoder(struct async_encoder *async)
+{
+    EnterCriticalSection(&async_encoders_cs);
+    list_remove(&async->entry);
+    LeaveCriticalSection(&async_encoders_cs);
+
+    EnterCriticalSection(&async->cs);
+    async->shutdown = TRUE;
+    WakeAllConditionVariable(&async->work_cv);
+    LeaveCriticalSection(&async->cs);
+
+    WaitForSingleObject(async->thread, INFINITE);
+    CloseHandle(async->thread);
+
+    async->cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection(&async->cs);
+    heap_free(async);
+}
+
 static NVENCSTATUS WINAPI NvEncOpenEncodeSession(void *device, uint32_t deviceType, void **encoder)
 {
     TRACE("(%p, %u, %p)\n", device, deviceType, encoder);
@@ -107,24 +343,30 @@ static NVENCSTATUS WINAPI NvEncGetEncodePresetConfig(void *encoder, GUID encodeG
 static NVENCSTATUS WINAPI NvEncInitializeEncoder(void *encoder, NV_ENC_INITIALIZE_PARAMS *createEncodeParams)
 {
     NV_ENC_INITIALIZE_PARAMS linux_encode_params;
+    NVENCSTATUS status;
 
     TRACE("(%p, %p)\n", encoder, createEncodeParams);
 
     if (!createEncodeParams)
         return NV_ENC_ERR_INVALID_PTR;
 
-    if (createEncodeParams->enableEncodeAsync)
-    {
-        FIXME("Async encoding is not supported by the linux NVIDIA driver.\n");
-        FIXME("Trying to emulate async mode, but this might not work for all applications.\n");
+    if (!createEncodeParams->enableEncodeAsync)
+        return origFunctions.nvEncInitializeEncoder(encoder, createEncodeParams);
 
-        /* Forward modified information to the linux library. */
-        linux_encode_params = *createEncodeParams;
-        createEncodeParams = &linux_encode_params;
-        linux_encode_params.enableEncodeAsync = 0;
-    }
+    FIXME("Async encoding is not supported by the linux NVIDIA driver, emulating it.\n");
+
+    /* Forward modified information to the linux library. */
+    linux_encode_params = *createEncodeParams;
+    linux_encode_params.enableEncodeAsync = 0;
 
-    return origFunctions.nvEncInitializeEncoder(encoder, createEncodeParams);
+    status = origFunctions.nvEncInitializeEncoder(encoder, &linux_encode_params);
+    if (status != NV_ENC_SUCCESS)
+        return status;
+
+    if (!get_async_encoder(encoder) && !create_async_encoder(encoder))
+        WARN("Falling back to synchronous encoding.\n");
+
+    return NV_ENC_SUCCESS;
 }
 
 static NVENCSTATUS WINAPI NvEncCreateInputBuffer(void *encoder, NV_ENC_CREATE_INPUT_BUFFER *createInputBufferParams)
@@ -135,7 +377,12 @@ static NVENCSTATUS WINAPI NvEncCreateInputBuffer(void *encoder, NV_ENC_CREATE_IN
 
 static NVENCSTATUS WINAPI NvEncDestroyInputBuffer(void *encoder, NV_ENC_INPUT_PTR inputBuffer)
 {
+    struct async_encoder *async;
+
     TRACE("(%p, %p)\n", encoder, inputBuffer);
+
+    if ((async = get_async_encoder(encoder)))
+        wait_for_buffer(async, inputBuffer);
     return origFunctions.nvEncDestroyInputBuffer(encoder, inputBuffer);
 }
 
@@ -147,15 +394,57 @@ static NVENCSTATUS WINAPI NvEncCreateBitstreamBuffer(void *encoder, NV_ENC_CREAT
 
 static NVENCSTATUS WINAPI NvEncDestroyBitstreamBuffer(void *encoder, NV_ENC_OUTPUT_PTR bitstreamBuffer)
 {
+    struct async_encoder *async;
+
     TRACE("(%p, %p)\n", encoder, bitstreamBuffer);
+
+    if ((async = get_async_encoder(encoder)))
+        wait_for_buffer(async, bitstreamBuffer);
     return origFunctions.nvEncDestroyBitstreamBuffer(encoder, bitstreamBuffer);
 }
 
 static NVENCSTATUS WINAPI NvEncEncodePicture(void *encoder, NV_ENC_PIC_PARAMS *encodePicParams)
 {
+    struct async_encoder *async;
+    struct encode_job *job;
     NVENCSTATUS result;
+
     TRACE("(%p, %p)\n", encoder, encodePicParams);
 
+    if (!encodePicParams)
+        return NV_ENC_ERR_INVALID_PTR;
+
+    if ((async = get_async_encoder(encoder)))
+    {
+        /* encoding synchronously here would race with the worker thread */
+        if (!(job = heap_alloc(sizeof(*job))))
+            return NV_ENC_ERR_OUT_OF_MEMORY;
+
+        /* Only the parameters themselves are copied, data referenced by them
+         * (e.g. SEI payloads) has to stay valid until the frame completes. */
+        job->params = *encodePicParams;
+        QueryPerformanceCounter(&job->submit_time);
+
+        EnterCriticalSection(&async->cs);
+        while (async->queued >= MAX_QUEUED_FRAMES && async->error == NV_ENC_SUCCESS)
+            SleepConditionVariableCS(&async->done_cv, &async->cs, INFINITE);
+
+        /* report errors of previously submitted frames */
+        if ((result = async->error) != NV_ENC_SUCCESS)
+        {
+            async->error = NV_ENC_SUCCESS;
+            LeaveCriticalSection(&async->cs);
+            heap_free(job);
+            return result;
+        }
+
+        list_add_tail(&async->queue, &job->entry);
+        async->queued++;
+        WakeConditionVariable(&async->work_cv);
+        LeaveCriticalSection(&async->cs);
+        return NV_ENC_SUCCESS;
+    }
+
     result = origFunctions.nvEncEncodePicture(encoder, encodePicParams);
 
     if (encodePicParams->completionEvent)
@@ -166,7 +455,25 @@ static NVENCSTATUS WINAPI NvEncEncodePicture(void *encoder, NV_ENC_PIC_PARAMS *e
 
 static NVENCSTATUS WINAPI NvEncLockBitstream(void *encoder, NV_ENC_LOCK_BITSTREAM *lockBitstreamBufferParams)
 {
+    struct async_encoder *async;
+
     TRACE("(%p, %p)\n", encoder, lockBitstreamBufferParams);
+
+    if (lockBitstreamBufferParams && (async = get_async_encoder(encoder)))
+    {
+        /* in async mode locking blocks until the output is available */
+        if (lockBitstreamBufferParams->doNotWait)
+        {
+            BOOL busy;
+
+            EnterCriticalSection(&async->cs);
+            busy = is_buffer_busy(async, lockBitstreamBufferParams->outputBitstream);
+            LeaveCriticalSection(&async->cs);
+            if (busy) return NV_ENC_ERR_LOCK_BUSY;
+        }
+        else
+            wait_for_buffer(async, lockBitstreamBufferParams->outputBitstream);
+    }
     return origFunctions.nvEncLockBitstream(encoder, lockBitstreamBufferParams);
 }
 
@@ -203,7 +510,8 @@ static NVENCSTATUS WINAPI NvEncGetSequenceParams(void *encoder, NV_ENC_SEQUENCE_
 static NVENCSTATUS WINAPI NvEncRegisterAsyncEvent(void *encoder, NV_ENC_EVENT_PARAMS *eventParams)
 {
     TRACE("(%p, %p)\n", encoder, eventParams);
-    /* This function will always fail as the linux NVIDIA driver doesn't support async mode */
+    /* This function will always fail as the linux NVIDIA driver doesn't support async mode,
+     * completion events are signalled by the async worker instead. */
     /* return origFunctions.nvEncRegisterAsyncEvent(encoder, eventParams); */
     return NV_ENC_SUCCESS;
 }
@@ -230,13 +538,23 @@ static NVENCSTATUS WINAPI NvEncUnmapInputResource(void *encoder, NV_ENC_INPUT_PT
 
 static NVENCSTATUS WINAPI NvEncDestroyEncoder(void *encoder)
 {
+    struct async_encoder *async;
+
     TRACE("(%p)\n", encoder);
+
+    if ((async = get_async_encoder(encoder)))
+        destroy_async_encoder(async);
     return origFunctions.nvEncDestroyEncoder(encoder);
 }
 
 static NVENCSTATUS WINAPI NvEncInvalidateRefFrames(void *encoder, uint64_t invalidRefFrameTimeStamp)
 {
+    struct async_encoder *async;
+
     TRACE("(%p, %s)\n", encoder, wine_dbgstr_longlong(invalidRefFrameTimeStamp));
+
+    if ((async = get_async_encoder(encoder)))
+        flush_async_encoder(async);
     return origFunctions.nvEncInvalidateRefFrames(encoder, invalidRefFrameTimeStamp);
 }
 
@@ -260,7 +578,12 @@ static NVENCSTATUS WINAPI NvEncUnregisterResource(void *encoder, NV_ENC_REGISTER
 
 static NVENCSTATUS WINAPI NvEncReconfigureEncoder(void *encoder, NV_ENC_RECONFIGURE_PARAMS *reInitEncodeParams)
 {
+    struct async_encoder *async;
+
     TRACE("(%p, %p)\n", encoder, reInitEncodeParams);
+
+    if ((async = get_async_encoder(encoder)))
+        flush_async_encoder(async);
     return origFunctions.nvEncReconfigureEncoder(encoder, reInitEncodeParams);
 }
 
@@ -5499,6 +5499,109 @@ static void test_SetFuncAndParamNames(void)
     DeleteFileA(filenameA);
 }
 
+static void test_GetIDsOfNames(void)
+{
+    WCHAR filenameW[MAX_PATH], nameW[16];
+    OLECHAR *names[1];
+    ICreateTypeLib2 *ctl;
+    ICreateTypeInfo *cti;
+    ITypeInfo *ti;
+    FUNCDESC funcdesc;
+    VARDESC vardesc;
+    MEMBERID memid;
+    HRESULT hr;
+    int i;
+
+    GetTempFileNameW(L".", L"tlb", 0, filenameW);
+
+    hr = CreateTypeLib2(SYS_WIN32, filenameW, &ctl);
+    ok(hr == S_OK, "got %08x\n", hr);
+
+    hr = ICreateTypeLib2_CreateTypeInfo(ctl, (OLECHAR *)L"disp", TKIND_DISPATCH, &cti);
+    ok(hr == S_OK, "got %08x\n", hr);
+
+    memset(&funcdesc, 0, sizeof(funcdesc));
+    funcdesc.funckind = FUNC_DISPATCH;
+    funcdesc.invkind = INVOKE_FUNC;
+    funcdesc.callconv = CC_STDCALL;
+    funcdesc.elemdescFunc.tdesc.vt = VT_VOID;
+
+    /* enough members to be looked up through a hash table */
+    for (i = 0; i < 20; i++)
+    {
+        funcdesc.memid = 0x100 + i;
+        hr = ICreateTypeInfo_AddFuncDesc(cti, i, &funcdesc);
+        ok(hr == S_OK, "got 0x%08x\n", hr);
+
+        wsprintfW(nameW, L"func%d", i);
+        names[0] = nameW;
+        hr = ICreateTypeInfo_SetFuncAndParamNames(cti, i, names, 1);
+        ok(hr == S_OK, "got 0x%08x\n", hr);
+    }
+
+    memset(&vardesc, 0, sizeof(vardesc));
+    vardesc.memid = 0x200;
+    vardesc.varkind = VAR_DISPATCH;
+    vardesc.elemdescVar.tdesc.vt = VT_INT;
+    hr = ICreateTypeInfo_AddVarDesc(cti, 0, &vardesc);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+    hr = ICreateTypeInfo_SetVarName(cti, 0, (OLECHAR *)L"var0");
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+
+    hr = ICreateTypeInfo_QueryInterface(cti, &IID_ITypeInfo, (void **)&ti);
+    ok(hr == S_OK, "got %08x\n", hr);
+
+    names[0] = (OLECHAR *)L"FUNC7";
+    hr = ITypeInfo_GetIDsOfNames(ti, names, 1, &memid);
+    ok(hr == S_OK, "got %08x\n", hr);
+    ok(memid == 0x107, "got memid %x\n", memid);
+
+    names[0] = (OLECHAR *)L"Var0";
+    hr = ITypeInfo_GetIDsOfNames(ti, names, 1, &memid);
+    ok(hr == S_OK, "got %08x\n", hr);
+    ok(memid == 0x200, "got memid %x\n", memid);
+
+    names[0] = (OLECHAR *)L"func20";
+    hr = ITypeInfo_GetIDsOfNames(ti, names, 1, &memid);
+    ok(hr == DISP_E_UNKNOWNNAME, "got %08x\n", hr);
+    ok(memid == MEMBERID_NIL, "got memid %x\n", memid);
+
+    /* changes made afterwards are visible */
+    names[0] = (OLECHAR *)L"renamed";
+    hr = ICreateTypeInfo_SetFuncAndParamNames(cti, 3, names, 1);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+
+    names[0] = (OLECHAR *)L"RENAMED";
+    hr = ITypeInfo_GetIDsOfNames(ti, names, 1, &memid);
+    ok(hr == S_OK, "got %08x\n", hr);
+    ok(memid == 0x103, "got memid %x\n", memid);
+
+    names[0] = (OLECHAR *)L"func3";
+    hr = ITypeInfo_GetIDsOfNames(ti, names, 1, &memid);
+    ok(hr == DISP_E_UNKNOWNNAME, "got %08x\n", hr);
+
+    funcdesc.memid = 0x300;
+    hr = ICreateTypeInfo_AddFuncDesc(cti, 0, &funcdesc);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+    names[0] = (OLECHAR *)L"first";
+    hr = ICreateTypeInfo_SetFuncAndParamNames(cti, 0, names, 1);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+
+    hr = ITypeInfo_GetIDsOfNames(ti, names, 1, &memid);
+    ok(hr == S_OK, "got %08x\n", hr);
+    ok(memid == 0x300, "got memid %x\n", memid);
+
+    names[0] = (OLECHAR *)L"func7";
+    hr = ITypeInfo_GetIDsOfNames(ti, names, 1, &memid);
+    ok(hr == S_OK, "got %08x\n", hr);
+    ok(memid == 0x107, "got memid %x\n", memid);
+
+    ITypeInfo_Release(ti);
+    ICreateTypeInfo_Release(cti);
+    ICreateTypeLib2_Release(ctl);
+    DeleteFileW(filenameW);
+}
+
 static void test_SetDocString(void)
 {
     static OLECHAR nameW[] = {'n','a','m','e',0};
@@ -6668,6 +6771,7 @@ START_TEST(typelib)
     test_inheritance();
     test_SetVarHelpContext();
     test_SetFuncAndParamNames();
+    test_GetIDsOfNames();
     test_SetDocString();
     test_FindName();
 
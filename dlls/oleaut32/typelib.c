@@ -1245,6 +1245,16 @@ typedef struct tagTLBImplType
     struct list custdata_list;
 } TLBImplType;
 
+/* member name lookup table, see TLB_lookup_name */
+typedef struct tagTLBNameHash
+{
+    UINT size;              /* power of two, 0 if some name can't be hashed */
+    struct {
+        UINT hash;
+        int index;          /* funcdescs index + 1, -(vardescs index + 1), 0 if free */
+    } entries[1];
+} TLBNameHash;
+
 /* internal TypeInfo data */
 typedef struct tagITypeInfoImpl
 {
@@ -1281,6 +1291,9 @@ typedef struct tagITypeInfoImpl
     /* Implemented Interfaces  */
     TLBImplType *impltypes;
 
+    /* built on first use by GetIDsOfNames */
+    TLBNameHash *name_hash;
+
     struct list *pcustdata_list;
     struct list custdata_list;
 } ITypeInfoImpl;
@@ -1737,6 +1750,145 @@ static inline TLBVarDesc *TLB_get_vardesc_by_name(ITypeInfoImpl *typeinfo, const
     return NULL;
 }
 
+static inline TLBFuncDesc *TLB_get_funcdesc_by_name(ITypeInfoImpl *typeinfo, const OLECHAR *name)
+{
+    int i;
+
+    for (i = 0; i < typeinfo->typeattr.cFuncs; ++i)
+    {
+        if (!lstrcmpiW(TLB_get_bstr(typeinfo->funcdescs[i].Name), name))
+            return &typeinfo->funcdescs[i];
+    }
+
+    return NULL;
+}
+
+/* Typeinfos with fewer members are searched linearly. */
+#define TLB_NAME_HASH_MIN_MEMBERS 16
+
+/* Only identifier characters are hashed, for which lstrcmpiW equality is plain
+ * ASCII case folding. Names with anything else are left to lstrcmpiW. */
+static BOOL TLB_name_hash(const OLECHAR *name, UINT *ret)
+{
+    UINT hash = 0;
+    WCHAR c;
+
+    if (!name)
+        return FALSE;
+
+    for (; *name; name++)
+    {
+        c = *name;
+        if (c >= 'a' && c <= 'z')
+            c -= 'a' - 'A';
+        else if (!(c >= 'A' && c <= 'Z') && !(c >= '0' && c <= '9') && c != '_')
+            return FALSE;
+        hash = hash * 31 + c;
+    }
+
+    *ret = hash;
+    return TRUE;
+}
+
+static const TLBString *TLB_name_hash_name(ITypeInfoImpl *typeinfo, int index)
+{
+    return index > 0 ? typeinfo->funcdescs[index - 1].Name : typeinfo->vardescs[-index - 1].Name;
+}
+
+static TLBNameHash *TLB_build_name_hash(ITypeInfoImpl *typeinfo)
+{
+    UINT count = typeinfo->typeattr.cFuncs + typeinfo->typeattr.cVars, size = 16, i, pos, hash;
+    const TLBString *name;
+    TLBNameHash *table;
+    int index;
+
+    while (size < count * 2)
+        size <<= 1;
+
+    table = heap_alloc_zero(FIELD_OFFSET(TLBNameHash, entries[size]));
+    if (!table)
+        return NULL;
+
+    /* functions come first and the first member with a given name wins, like in the linear search */
+    for (i = 0; i < count; i++)
+    {
+        index = i < typeinfo->typeattr.cFuncs ? i + 1 : -(int)(i - typeinfo->typeattr.cFuncs + 1);
+        if (!(name = TLB_name_hash_name(typeinfo, index)))
+            continue;
+        if (!TLB_name_hash(name->str, &hash))
+        {
+            TRACE("can't hash %s\n", debugstr_w(name->str));
+            heap_free(table);
+            return heap_alloc_zero(sizeof(*table));
+        }
+
+        pos = hash & (size - 1);
+        while (table->entries[pos].index)
+        {
+            if (table->entries[pos].hash == hash &&
+                    !lstrcmpiW(TLB_name_hash_name(typeinfo, table->entries[pos].index)->str, name->str))
+                break;
+            pos = (pos + 1) & (size - 1);
+        }
+        if (!table->entries[pos].index)
+        {
+            table->entries[pos].hash = hash;
+            table->entries[pos].index = index;
+        }
+    }
+
+    table->size = size;
+    return table;
+}
+
+static void TLB_free_name_hash(ITypeInfoImpl *typeinfo)
+{
+    heap_free(typeinfo->name_hash);
+    typeinfo->name_hash = NULL;
+}
+
+/* Looks up a member name in the typeinfo's hash table, which is built on first use.
+ * Returns FALSE if the caller has to search linearly. */
+static BOOL TLB_lookup_name(ITypeInfoImpl *typeinfo, const OLECHAR *name,
+        TLBFuncDesc **func, TLBVarDesc **var)
+{
+    TLBNameHash *table;
+    UINT hash, pos;
+    int index;
+
+    if (typeinfo->typeattr.cFuncs + typeinfo->typeattr.cVars < TLB_NAME_HASH_MIN_MEMBERS)
+        return FALSE;
+
+    if (!(table = typeinfo->name_hash))
+    {
+        if (!(table = TLB_build_name_hash(typeinfo)))
+            return FALSE;
+        if (InterlockedCompareExchangePointer((void **)&typeinfo->name_hash, table, NULL))
+        {
+            heap_free(table);
+            table = typeinfo->name_hash;
+        }
+    }
+
+    if (!table->size || !TLB_name_hash(name, &hash))
+        return FALSE;
+
+    *func = NULL;
+    *var = NULL;
+    for (pos = hash & (table->size - 1); (index = table->entries[pos].index); pos = (pos + 1) & (table->size - 1))
+    {
+        if (table->entries[pos].hash == hash && !lstrcmpiW(TLB_name_hash_name(typeinfo, index)->str, name))
+        {
+            if (index > 0)
+                *func = &typeinfo->funcdescs[index - 1];
+            else
+                *var = &typeinfo->vardescs[-index - 1];
+            break;
+        }
+    }
+    return TRUE;
+}
+
 static inline TLBCustData *TLB_get_custdata_by_guid(const struct list *custdata_list, REFGUID guid)
 {
     TLBCustData *cust_data;
@@ -5738,6 +5890,7 @@ static void ITypeInfoImpl_Destroy(ITypeInfoImpl *This)
 
     TLB_FreeCustData(&This->custdata_list);
 
+    TLB_free_name_hash(This);
     heap_free(This);
 }
 
@@ -5755,7 +5908,10 @@ static ULONG WINAPI ITypeInfo_fnRelease(ITypeInfo2 *iface)
         BOOL not_attached_to_typelib = This->not_attached_to_typelib;
         ITypeLib2_Release(&This->pTypeLib->ITypeLib2_iface);
         if (not_attached_to_typelib)
+        {
+            TLB_free_name_hash(This);
             heap_free(This);
+        }
         /* otherwise This will be freed when typelib is freed */
     }
 
@@ -6358,9 +6514,10 @@ static HRESULT WINAPI ITypeInfo_fnGetIDsOfNames( ITypeInfo2 *iface,
         LPOLESTR  *rgszNames, UINT cNames, MEMBERID  *pMemId)
 {
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
-    const TLBVarDesc *pVDesc;
+    TLBVarDesc *pVDesc;
+    TLBFuncDesc *pFDesc;
     HRESULT ret=S_OK;
-    UINT i, fdc;
+    UINT i;
 
     TRACE("(%p) Name %s cNames %d\n", This, debugstr_w(*rgszNames),
             cNames);
@@ -6369,25 +6526,26 @@ static HRESULT WINAPI ITypeInfo_fnGetIDsOfNames( ITypeInfo2 *iface,
     for (i = 0; i < cNames; i++)
         pMemId[i] = MEMBERID_NIL;
 
-    for (fdc = 0; fdc < This->typeattr.cFuncs; ++fdc) {
+    if (!TLB_lookup_name(This, *rgszNames, &pFDesc, &pVDesc)) {
+        pFDesc = TLB_get_funcdesc_by_name(This, *rgszNames);
+        pVDesc = pFDesc ? NULL : TLB_get_vardesc_by_name(This, *rgszNames);
+    }
+
+    if (pFDesc) {
         int j;
-        const TLBFuncDesc *pFDesc = &This->funcdescs[fdc];
-        if(!lstrcmpiW(*rgszNames, TLB_get_bstr(pFDesc->Name))) {
-            if(cNames) *pMemId=pFDesc->funcdesc.memid;
-            for(i=1; i < cNames; i++){
-                for(j=0; j<pFDesc->funcdesc.cParams; j++)
-                    if(!lstrcmpiW(rgszNames[i],TLB_get_bstr(pFDesc->pParamDesc[j].Name)))
-                            break;
-                if( j<pFDesc->funcdesc.cParams)
-                    pMemId[i]=j;
-                else
-                   ret=DISP_E_UNKNOWNNAME;
-            };
-            TRACE("-- 0x%08x\n", ret);
-            return ret;
-        }
+        if(cNames) *pMemId=pFDesc->funcdesc.memid;
+        for(i=1; i < cNames; i++){
+            for(j=0; j<pFDesc->funcdesc.cParams; j++)
+                if(!lstrcmpiW(rgszNames[i],TLB_get_bstr(pFDesc->pParamDesc[j].Name)))
+                        break;
+            if( j<pFDesc->funcdesc.cParams)
+                pMemId[i]=j;
+            else
+               ret=DISP_E_UNKNOWNNAME;
+        };
+        TRACE("-- 0x%08x\n", ret);
+        return ret;
     }
-    pVDesc = TLB_get_vardesc_by_name(This, *rgszNames);
     if(pVDesc){
         if(cNames)
             *pMemId = pVDesc->vardesc.memid;
@@ -8032,6 +8190,7 @@ static HRESULT WINAPI ITypeInfo_fnGetRefTypeInfo(
 
         *pTypeInfoImpl = *This;
         pTypeInfoImpl->ref = 0;
+        pTypeInfoImpl->name_hash = NULL;
         list_init(&pTypeInfoImpl->custdata_list);
 
         if (This->typeattr.typekind == TKIND_INTERFACE)
@@ -10971,6 +11130,7 @@ static HRESULT WINAPI ICreateTypeInfo2_fnAddFuncDesc(ICreateTypeInfo2 *iface,
     list_init(&func_desc->custdata_list);
 
     ++This->typeattr.cFuncs;
+    TLB_free_name_hash(This);
 
     This->needs_layout = TRUE;
 
@@ -11127,6 +11287,7 @@ static HRESULT WINAPI ICreateTypeInfo2_fnAddVarDesc(ICreateTypeInfo2 *iface,
     var_desc->vardesc = *var_desc->vardesc_create;
 
     ++This->typeattr.cVars;
+    TLB_free_name_hash(This);
 
     This->needs_layout = TRUE;
 
@@ -11167,6 +11328,7 @@ static HRESULT WINAPI ICreateTypeInfo2_fnSetFuncAndParamNames(ICreateTypeInfo2 *
     }
 
     func_desc->Name = TLB_append_str(&This->pTypeLib->name_list, *names);
+    TLB_free_name_hash(This);
 
     for (i = 1; i < numNames; ++i) {
         TLBParDesc *par_desc = func_desc->pParamDesc + i - 1;
@@ -11190,6 +11352,7 @@ static HRESULT WINAPI ICreateTypeInfo2_fnSetVarName(ICreateTypeInfo2 *iface,
         return TYPE_E_ELEMENTNOTFOUND;
 
     This->vardescs[index].Name = TLB_append_str(&This->pTypeLib->name_list, name);
+    TLB_free_name_hash(This);
     return S_OK;
 }
 
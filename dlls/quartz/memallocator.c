@@ -55,6 +55,8 @@ typedef struct BaseMemAllocator
     HRESULT (* fnBufferPrepare)(IMemAllocator *, StdMediaSample2 *, DWORD flags);
     HRESULT (* fnBufferReleased)(IMemAllocator *, StdMediaSample2 *);
     void (* fnDestroyed)(IMemAllocator *);
+    /* Only signaled when a buffer is returned while somebody is waiting for
+     * one, so that GetBuffer and ReleaseBuffer stay in user mode otherwise. */
     HANDLE hSemWaiting;
     BOOL bDecommitQueued;
     BOOL bCommitted;
@@ -62,6 +64,8 @@ typedef struct BaseMemAllocator
     struct list free_list;
     struct list used_list;
     CRITICAL_SECTION *pCritSect;
+    unsigned int samples_delivered;
+    unsigned int samples_waited;
 } BaseMemAllocator;
 
 static inline BaseMemAllocator *impl_from_IMemAllocator(IMemAllocator *iface)
@@ -103,6 +107,8 @@ static HRESULT BaseMemAllocator_Init(HRESULT (* fnAlloc)(IMemAllocator *),
     pMemAlloc->hSemWaiting = NULL;
     pMemAlloc->lWaiting = 0;
     pMemAlloc->pCritSect = pCritSect;
+    pMemAlloc->samples_delivered = 0;
+    pMemAlloc->samples_waited = 0;
 
     return S_OK;
 }
@@ -234,7 +240,7 @@ static HRESULT WINAPI BaseMemAllocator_Commit(IMemAllocator * iface)
             hr = S_OK;
         else
         {
-            if (!(This->hSemWaiting = CreateSemaphoreW(NULL, This->props.cBuffers, This->props.cBuffers, NULL)))
+            if (!This->hSemWaiting && !(This->hSemWaiting = CreateSemaphoreW(NULL, 0, MAXLONG, NULL)))
             {
                 ERR("Couldn't create semaphore (error was %u)\n", GetLastError());
                 hr = HRESULT_FROM_WIN32(GetLastError());
@@ -271,8 +277,10 @@ static HRESULT WINAPI BaseMemAllocator_Decommit(IMemAllocator * iface)
             {
                 This->bDecommitQueued = TRUE;
                 /* notify ALL waiting threads that they cannot be allocated a buffer any more */
-                ReleaseSemaphore(This->hSemWaiting, This->lWaiting, NULL);
-                
+                if (This->lWaiting)
+                    ReleaseSemaphore(This->hSemWaiting, This->lWaiting, NULL);
+                This->lWaiting = 0;
+
                 hr = S_OK;
             }
             else
@@ -281,8 +289,10 @@ static HRESULT WINAPI BaseMemAllocator_Decommit(IMemAllocator * iface)
                     ERR("Waiting: %d\n", This->lWaiting);
 
                 This->bCommitted = FALSE;
-                CloseHandle(This->hSemWaiting);
-                This->hSemWaiting = NULL;
+
+                TRACE("%u samples delivered, %u had to wait for a free buffer.\n",
+                        This->samples_delivered, This->samples_waited);
+                This->samples_delivered = This->samples_waited = 0;
 
                 hr = This->fnFree(iface);
                 if (FAILED(hr))
@@ -298,6 +308,8 @@ static HRESULT WINAPI BaseMemAllocator_Decommit(IMemAllocator * iface)
 static HRESULT WINAPI BaseMemAllocator_GetBuffer(IMemAllocator * iface, IMediaSample ** pSample, REFERENCE_TIME *pStartTime, REFERENCE_TIME *pEndTime, DWORD dwFlags)
 {
     BaseMemAllocator *This = impl_from_IMemAllocator(iface);
+    BOOL waited = FALSE;
+    struct list *free;
     HRESULT hr = S_OK;
 
     /* NOTE: The pStartTime and pEndTime parameters are not applied to the sample. 
@@ -308,37 +320,24 @@ static HRESULT WINAPI BaseMemAllocator_GetBuffer(IMemAllocator * iface, IMediaSa
     *pSample = NULL;
 
     EnterCriticalSection(This->pCritSect);
-    if (!This->bCommitted || This->bDecommitQueued)
+    for (;;)
     {
-        WARN("Not committed\n");
-        hr = VFW_E_NOT_COMMITTED;
-    }
-    else
-        ++This->lWaiting;
-    LeaveCriticalSection(This->pCritSect);
-    if (FAILED(hr))
-        return hr;
-
-    if (WaitForSingleObject(This->hSemWaiting, (dwFlags & AM_GBF_NOWAIT) ? 0 : INFINITE) != WAIT_OBJECT_0)
-    {
-        EnterCriticalSection(This->pCritSect);
-        --This->lWaiting;
-        LeaveCriticalSection(This->pCritSect);
-        WARN("Timed out\n");
-        return VFW_E_TIMEOUT;
-    }
-
-    EnterCriticalSection(This->pCritSect);
-    {
-        --This->lWaiting;
-        if (!This->bCommitted)
+        if (!This->bCommitted || (This->bDecommitQueued && !waited))
+        {
+            WARN("Not committed\n");
             hr = VFW_E_NOT_COMMITTED;
-        else if (This->bDecommitQueued)
+            break;
+        }
+        if (This->bDecommitQueued)
+        {
             hr = VFW_E_TIMEOUT;
-        else
+            break;
+        }
+
+        if ((free = list_head(&This->free_list)))
         {
             StdMediaSample2 *ms;
-            struct list * free = list_head(&This->free_list);
+
             list_remove(free);
             list_add_head(&This->used_list, free);
 
@@ -346,7 +345,26 @@ static HRESULT WINAPI BaseMemAllocator_GetBuffer(IMemAllocator * iface, IMediaSa
             assert(ms->ref == 0);
             *pSample = (IMediaSample *)&ms->IMediaSample2_iface;
             IMediaSample_AddRef(*pSample);
+
+            ++This->samples_delivered;
+            if (waited)
+                ++This->samples_waited;
+            break;
         }
+
+        if (dwFlags & AM_GBF_NOWAIT)
+        {
+            WARN("Timed out\n");
+            hr = VFW_E_TIMEOUT;
+            break;
+        }
+
+        /* The releasing thread decrements lWaiting when it wakes us up. */
+        ++This->lWaiting;
+        waited = TRUE;
+        LeaveCriticalSection(This->pCritSect);
+        WaitForSingleObject(This->hSemWaiting, INFINITE);
+        EnterCriticalSection(This->pCritSect);
     }
     LeaveCriticalSection(This->pCritSect);
 
@@ -387,22 +405,26 @@ static HRESULT WINAPI BaseMemAllocator_ReleaseBuffer(IMemAllocator * iface, IMed
             This->bCommitted = FALSE;
             This->bDecommitQueued = FALSE;
 
-            CloseHandle(This->hSemWaiting);
-            This->hSemWaiting = NULL;
-            
+            TRACE("%u samples delivered, %u had to wait for a free buffer.\n",
+                    This->samples_delivered, This->samples_waited);
+            This->samples_delivered = This->samples_waited = 0;
+
             if (FAILED(hrfree = This->fnFree(iface)))
                 ERR("fnFree failed with error 0x%x\n", hrfree);
         }
+        else if (This->lWaiting)
+        {
+            /* notify a waiting thread that there is now a free buffer */
+            --This->lWaiting;
+            if (!ReleaseSemaphore(This->hSemWaiting, 1, NULL))
+            {
+                ERR("ReleaseSemaphore failed with error %u\n", GetLastError());
+                hr = HRESULT_FROM_WIN32(GetLastError());
+            }
+        }
     }
     LeaveCriticalSection(This->pCritSect);
 
-    /* notify a waiting thread that there is now a free buffer */
-    if (This->hSemWaiting && !ReleaseSemaphore(This->hSemWaiting, 1, NULL))
-    {
-        ERR("ReleaseSemaphore failed with error %u\n", GetLastError());
-        hr = HRESULT_FROM_WIN32(GetLastError());
-    }
-
     return hr;
 }
 
@@ -825,8 +847,98 @@ typedef struct StdMemAllocator
     BaseMemAllocator base;
     CRITICAL_SECTION csState;
     LPVOID pMemory;
+    SIZE_T cbMemory;
 } StdMemAllocator;
 
+/* Buffers are aligned at least this much, whatever alignment was asked for. */
+#define MIN_BUFFER_ALIGN 16
+
+/* Graphs commit and decommit their allocators on every state change, and
+ * several pins usually ask for the same buffer sizes. Released blocks are
+ * shared between all allocators of the process and reused for the next
+ * commit of the same size. */
+#define MAX_CACHED_BLOCKS 8
+#define MAX_CACHED_SIZE   (64 * 1024 * 1024)
+
+struct cached_block
+{
+    struct list entry;
+    void *memory;
+    SIZE_T size;
+};
+
+static struct list cached_blocks = LIST_INIT(cached_blocks);
+static unsigned int cached_count;
+static SIZE_T cached_size;
+
+static CRITICAL_SECTION block_cache_cs;
+static CRITICAL_SECTION_DEBUG block_cache_cs_debug =
+{
+    0, 0, &block_cache_cs,
+    { &block_cache_cs_debug.ProcessLocksList, &block_cache_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": block_cache_cs") }
+};
+static CRITICAL_SECTION block_cache_cs = { &block_cache_cs_debug, -1, 0, 0, 0, 0 };
+
+static void *alloc_block(SIZE_T size)
+{
+    struct cached_block *block;
+    void *memory;
+
+    EnterCriticalSection(&block_cache_cs);
+    LIST_FOR_EACH_ENTRY(block, &cached_blocks, struct cached_block, entry)
+    {
+        if (block->size != size)
+            continue;
+
+        list_remove(&block->entry);
+        --cached_count;
+        cached_size -= size;
+        LeaveCriticalSection(&block_cache_cs);
+
+        TRACE("Reusing block %p, size %lu.\n", block->memory, size);
+        memory = block->memory;
+        heap_free(block);
+        return memory;
+    }
+    LeaveCriticalSection(&block_cache_cs);
+
+    return VirtualAlloc(NULL, size, MEM_COMMIT, PAGE_READWRITE);
+}
+
+static BOOL free_block(void *memory, SIZE_T size)
+{
+    struct cached_block *block;
+
+    if (size > MAX_CACHED_SIZE / 4 || !(block = heap_alloc(sizeof(*block))))
+        return VirtualFree(memory, 0, MEM_RELEASE);
+
+    block->memory = memory;
+    block->size = size;
+
+    EnterCriticalSection(&block_cache_cs);
+    list_add_head(&cached_blocks, &block->entry);
+    ++cached_count;
+    cached_size += size;
+    while (cached_count > MAX_CACHED_BLOCKS || cached_size > MAX_CACHED_SIZE)
+    {
+        block = LIST_ENTRY(list_tail(&cached_blocks), struct cached_block, entry);
+        list_remove(&block->entry);
+        --cached_count;
+        cached_size -= block->size;
+        VirtualFree(block->memory, 0, MEM_RELEASE);
+        heap_free(block);
+    }
+    LeaveCriticalSection(&block_cache_cs);
+
+    return TRUE;
+}
+
+static inline SIZE_T align_size(SIZE_T size, SIZE_T align)
+{
+    return (size + align - 1) / align * align;
+}
+
 static inline StdMemAllocator *StdMemAllocator_from_IMemAllocator(IMemAllocator * iface)
 {
     return CONTAINING_RECORD(iface, StdMemAllocator, base.IMemAllocator_iface);
@@ -836,6 +948,7 @@ static HRESULT StdMemAllocator_Alloc(IMemAllocator * iface)
 {
     StdMemAllocator *This = StdMemAllocator_from_IMemAllocator(iface);
     StdMediaSample2 * pSample = NULL;
+    SIZE_T align, offset, stride;
     SYSTEM_INFO si;
     LONG i;
 
@@ -848,19 +961,23 @@ static HRESULT StdMemAllocator_Alloc(IMemAllocator * iface)
     if ((si.dwPageSize % This->base.props.cbAlign) != 0)
         return VFW_E_BADALIGN;
 
-    /* FIXME: each sample has to have its buffer start on the right alignment.
-     * We don't do this at the moment */
+    /* Each buffer starts on the requested alignment, with its prefix right
+     * before it. The memory itself is page aligned. */
+    align = max(This->base.props.cbAlign, MIN_BUFFER_ALIGN);
+    offset = align_size(This->base.props.cbPrefix, align);
+    stride = align_size(This->base.props.cbPrefix + This->base.props.cbBuffer, align);
 
     /* allocate memory */
-    This->pMemory = VirtualAlloc(NULL, (This->base.props.cbBuffer + This->base.props.cbPrefix) * This->base.props.cBuffers, MEM_COMMIT, PAGE_READWRITE);
+    This->cbMemory = offset + stride * This->base.props.cBuffers;
+    This->pMemory = alloc_block(This->cbMemory);
 
     if (!This->pMemory)
         return E_OUTOFMEMORY;
 
     for (i = This->base.props.cBuffers - 1; i >= 0; i--)
     {
-        /* pbBuffer does not start at the base address, it starts at base + cbPrefix */
-        BYTE * pbBuffer = (BYTE *)This->pMemory + i * (This->base.props.cbBuffer + This->base.props.cbPrefix) + This->base.props.cbPrefix;
+        /* pbBuffer does not start at the base address, it follows the prefix */
+        BYTE * pbBuffer = (BYTE *)This->pMemory + offset + i * stride;
         
         StdMediaSample2_Construct(pbBuffer, This->base.props.cbBuffer, iface, &pSample);
 
@@ -894,7 +1011,7 @@ static HRESULT StdMemAllocator_Free(IMemAllocator * iface)
     }
     
     /* free memory */
-    if (!VirtualFree(This->pMemory, 0, MEM_RELEASE))
+    if (!free_block(This->pMemory, This->cbMemory))
     {
         ERR("Couldn't free memory. Error: %u\n", GetLastError());
         return HRESULT_FROM_WIN32(GetLastError());
@@ -930,6 +1047,7 @@ HRESULT mem_allocator_create(IUnknown *lpUnkOuter, IUnknown **out)
     pMemAlloc->csState.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": StdMemAllocator.csState");
 
     pMemAlloc->pMemory = NULL;
+    pMemAlloc->cbMemory = 0;
 
     if (SUCCEEDED(hr = BaseMemAllocator_Init(StdMemAllocator_Alloc, StdMemAllocator_Free, NULL, NULL, NULL, StdMemAllocator_Destroy, &pMemAlloc->csState, &pMemAlloc->base)))
         *out = (IUnknown *)&pMemAlloc->base.IMemAllocator_iface;
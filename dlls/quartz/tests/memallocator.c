@@ -171,6 +171,47 @@ static void test_commit(void)
     IMemAllocator_Release(allocator);
 }
 
+static void test_buffer_alignment(void)
+{
+    ALLOCATOR_PROPERTIES req_props = {2, 100, 16, 0}, ret_props;
+    IMemAllocator *allocator = create_allocator();
+    IMediaSample *sample, *sample2, *sample3;
+    BYTE *data, *data2;
+    HRESULT hr;
+
+    hr = IMemAllocator_SetProperties(allocator, &req_props, &ret_props);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+    hr = IMemAllocator_Commit(allocator);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+
+    hr = IMemAllocator_GetBuffer(allocator, &sample, NULL, NULL, 0);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+    hr = IMemAllocator_GetBuffer(allocator, &sample2, NULL, NULL, 0);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+
+    hr = IMediaSample_GetPointer(sample, &data);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+    ok(!((DWORD_PTR)data % 16), "Got unaligned pointer %p.\n", data);
+    hr = IMediaSample_GetPointer(sample2, &data2);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+    ok(!((DWORD_PTR)data2 % 16), "Got unaligned pointer %p.\n", data2);
+    ok(data2 >= data + 100 || data >= data2 + 100, "Buffers %p and %p overlap.\n", data, data2);
+
+    hr = IMemAllocator_GetBuffer(allocator, &sample3, NULL, NULL, AM_GBF_NOWAIT);
+    ok(hr == VFW_E_TIMEOUT, "Got hr %#x.\n", hr);
+
+    IMediaSample_Release(sample);
+    hr = IMemAllocator_GetBuffer(allocator, &sample3, NULL, NULL, AM_GBF_NOWAIT);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+    ok(sample3 == sample, "Expected the released sample.\n");
+
+    IMediaSample_Release(sample3);
+    IMediaSample_Release(sample2);
+    hr = IMemAllocator_Decommit(allocator);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+    IMemAllocator_Release(allocator);
+}
+
 static void test_sample_time(void)
 {
     ALLOCATOR_PROPERTIES req_props = {1, 65536, 1, 0}, ret_props;
@@ -656,6 +697,7 @@ START_TEST(memallocator)
 
     test_properties();
     test_commit();
+    test_buffer_alignment();
     test_sample_time();
     test_media_time();
     test_sample_properties();
@@ -122,9 +122,12 @@ enum system_queue_index
 
 struct work_item
 {
+    SLIST_ENTRY slist_entry;
     IUnknown IUnknown_iface;
     LONG refcount;
     struct list entry;
+    struct list lane_entry;
+    LONGLONG submit_time;
     IRtwqAsyncResult *result;
     IRtwqAsyncResult *reply_result;
     struct queue *queue;
@@ -177,6 +180,16 @@ struct queue
     CRITICAL_SECTION cs;
     struct list pending_items;
     DWORD id;
+    /* Data used for pool queues only. Items are pushed to per-priority lists
+       without locking, and moved to the lanes by the worker threads. */
+    TP_WORK *work;
+    SLIST_HEADER incoming[ARRAY_SIZE(priorities)];
+    struct list lanes[ARRAY_SIZE(priorities)];
+    LONG active_workers;
+    LONG max_workers;
+    LONGLONG stats_start;
+    LONGLONG stats_latency;
+    unsigned int stats_items;
     /* Data used for serial queues only. */
     PTP_SIMPLE_CALLBACK finalization_callback;
     DWORD target_queue;
@@ -308,6 +321,8 @@ static void CALLBACK standard_queue_cleanup_callback(void *object_data, void *gr
 {
 }
 
+static void CALLBACK pool_queue_worker(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work);
+
 static HRESULT pool_queue_init(const struct queue_desc *desc, struct queue *queue)
 {
     TP_CALLBACK_ENVIRON_V3 env;
@@ -326,6 +341,8 @@ static HRESULT pool_queue_init(const struct queue_desc *desc, struct queue *queu
     {
         queue->envs[i] = env;
         queue->envs[i].CallbackPriority = priorities[i];
+        InitializeSListHead(&queue->incoming[i]);
+        list_init(&queue->lanes[i]);
     }
     list_init(&queue->pending_items);
     InitializeCriticalSection(&queue->cs);
@@ -335,61 +352,224 @@ static HRESULT pool_queue_init(const struct queue_desc *desc, struct queue *queu
     SetThreadpoolThreadMinimum(queue->pool, 1);
     SetThreadpoolThreadMaximum(queue->pool, max_thread);
 
+    queue->max_workers = max_thread;
+    if (!(queue->work = CreateThreadpoolWork(pool_queue_worker, queue,
+            (TP_CALLBACK_ENVIRON *)&queue->envs[TP_CALLBACK_PRIORITY_NORMAL])))
+    {
+        WARN("Failed to create work object, error %u.\n", GetLastError());
+        DeleteCriticalSection(&queue->cs);
+        CloseThreadpoolCleanupGroup(env.CleanupGroup);
+        CloseThreadpool(queue->pool);
+        queue->pool = NULL;
+        return E_OUTOFMEMORY;
+    }
+
     if (desc->queue_type == RTWQ_WINDOW_WORKQUEUE)
         FIXME("RTWQ_WINDOW_WORKQUEUE is not supported.\n");
 
     return S_OK;
 }
 
+static void release_queued_item(struct work_item *item)
+{
+    /* Finalization reference, see pool_queue_submit(). */
+    if (item->finalization_callback)
+        IUnknown_Release(&item->IUnknown_iface);
+    IUnknown_Release(&item->IUnknown_iface);
+}
+
 static BOOL pool_queue_shutdown(struct queue *queue)
 {
+    struct work_item *item, *next;
+    SLIST_ENTRY *entry;
+    unsigned int i;
+
     if (!queue->pool)
         return FALSE;
 
     CloseThreadpoolCleanupGroupMembers(queue->envs[0].CleanupGroup, TRUE, NULL);
     CloseThreadpool(queue->pool);
     queue->pool = NULL;
+    queue->work = NULL;
+
+    for (i = 0; i < ARRAY_SIZE(queue->lanes); ++i)
+    {
+        LIST_FOR_EACH_ENTRY_SAFE(item, next, &queue->lanes[i], struct work_item, lane_entry)
+        {
+            list_remove(&item->lane_entry);
+            release_queued_item(item);
+        }
+
+        entry = InterlockedFlushSList(&queue->incoming[i]);
+        while (entry)
+        {
+            item = CONTAINING_RECORD(entry, struct work_item, slist_entry);
+            entry = entry->Next;
+            release_queued_item(item);
+        }
+    }
 
     return TRUE;
 }
 
-static void CALLBACK standard_queue_worker(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work)
+static unsigned int get_item_lane(const struct work_item *item)
 {
-    struct work_item *item = context;
-    RTWQASYNCRESULT *result = (RTWQASYNCRESULT *)item->result;
+    if (item->priority > 0)
+        return TP_CALLBACK_PRIORITY_HIGH;
+    if (item->priority < 0)
+        return TP_CALLBACK_PRIORITY_LOW;
+    return TP_CALLBACK_PRIORITY_NORMAL;
+}
+
+/* Called with queue lock held. */
+static void pool_queue_update_stats(struct queue *queue, const struct work_item *item)
+{
+    LARGE_INTEGER now, frequency;
+    LONGLONG elapsed;
 
-    TRACE("result object %p.\n", result);
+    if (!item->submit_time)
+        return;
 
-    /* Submitting from serial queue in reply mode, use different result object acting as receipt token.
-       It's submitted to user callback still, but when invoked, special serial queue callback will be used
-       to ensure correct destination queue. */
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
 
-    IRtwqAsyncCallback_Invoke(result->pCallback, item->reply_result ? item->reply_result : item->result);
+    queue->stats_latency += now.QuadPart - item->submit_time;
+    queue->stats_items++;
 
-    IUnknown_Release(&item->IUnknown_iface);
+    if (!queue->stats_start)
+        queue->stats_start = now.QuadPart;
+    else if ((elapsed = now.QuadPart - queue->stats_start) >= frequency.QuadPart)
+    {
+        TRACE("queue %p: %s items/s, average dispatch latency %s us.\n", queue,
+                wine_dbgstr_longlong(queue->stats_items * frequency.QuadPart / elapsed),
+                wine_dbgstr_longlong(queue->stats_latency * 1000000 / frequency.QuadPart / queue->stats_items));
+        queue->stats_start = now.QuadPart;
+        queue->stats_latency = 0;
+        queue->stats_items = 0;
+    }
 }
 
-static void pool_queue_submit(struct queue *queue, struct work_item *item)
+/* Returns the oldest item of the highest priority lane. */
+static struct work_item *pool_queue_get_next(struct queue *queue)
 {
-    TP_CALLBACK_PRIORITY callback_priority;
-    TP_CALLBACK_ENVIRON_V3 env;
-    TP_WORK *work_object;
+    struct work_item *item = NULL;
+    SLIST_ENTRY *entry;
+    unsigned int i;
 
-    if (item->priority == 0)
-        callback_priority = TP_CALLBACK_PRIORITY_NORMAL;
-    else if (item->priority < 0)
-        callback_priority = TP_CALLBACK_PRIORITY_LOW;
-    else
-        callback_priority = TP_CALLBACK_PRIORITY_HIGH;
+    EnterCriticalSection(&queue->cs);
+
+    for (i = 0; i < ARRAY_SIZE(queue->lanes) && !item; ++i)
+    {
+        if (list_empty(&queue->lanes[i]))
+        {
+            /* Pushed items are in reverse order. */
+            entry = InterlockedFlushSList(&queue->incoming[i]);
+            while (entry)
+            {
+                list_add_head(&queue->lanes[i], &CONTAINING_RECORD(entry, struct work_item, slist_entry)->lane_entry);
+                entry = entry->Next;
+            }
+        }
+
+        if (!list_empty(&queue->lanes[i]))
+        {
+            item = LIST_ENTRY(list_head(&queue->lanes[i]), struct work_item, lane_entry);
+            list_remove(&item->lane_entry);
+        }
+    }
+
+    if (item && TRACE_ON(mfplat))
+        pool_queue_update_stats(queue, item);
+
+    LeaveCriticalSection(&queue->cs);
+
+    return item;
+}
 
-    env = queue->envs[callback_priority];
-    env.FinalizationCallback = item->finalization_callback;
-    /* Worker pool callback will release one reference. Grab one more to keep object alive when
+static BOOL pool_queue_has_items(struct queue *queue)
+{
+    BOOL ret = FALSE;
+    unsigned int i;
+
+    EnterCriticalSection(&queue->cs);
+    for (i = 0; i < ARRAY_SIZE(queue->lanes) && !ret; ++i)
+        ret = !list_empty(&queue->lanes[i]) || QueryDepthSList(&queue->incoming[i]);
+    LeaveCriticalSection(&queue->cs);
+
+    return ret;
+}
+
+static BOOL pool_queue_grab_worker(struct queue *queue)
+{
+    LONG count;
+
+    do
+    {
+        if ((count = queue->active_workers) >= queue->max_workers)
+            return FALSE;
+    } while (InterlockedCompareExchange(&queue->active_workers, count + 1, count) != count);
+
+    return TRUE;
+}
+
+static void CALLBACK pool_queue_worker(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work)
+{
+    struct queue *queue = context;
+    RTWQASYNCRESULT *result;
+    struct work_item *item;
+
+    if (queue->envs[TP_CALLBACK_PRIORITY_NORMAL].u.s.LongFunction)
+        CallbackMayRunLong(instance);
+
+    for (;;)
+    {
+        /* Keep running while there is work, this way items submitted by callbacks, e.g. the next
+           item of a serial queue, don't have to go through the thread pool again. */
+        while ((item = pool_queue_get_next(queue)))
+        {
+            result = (RTWQASYNCRESULT *)item->result;
+
+            TRACE("result object %p.\n", result);
+
+            /* Submitting from serial queue in reply mode, use different result object acting as receipt token.
+               It's submitted to user callback still, but when invoked, special serial queue callback will be used
+               to ensure correct destination queue. */
+
+            IRtwqAsyncCallback_Invoke(result->pCallback, item->reply_result ? item->reply_result : item->result);
+
+            if (item->finalization_callback)
+                item->finalization_callback(instance, item);
+
+            IUnknown_Release(&item->IUnknown_iface);
+        }
+
+        InterlockedDecrement(&queue->active_workers);
+
+        /* Submitters don't schedule another worker while this one is still counted as active. */
+        if (!pool_queue_has_items(queue) || !pool_queue_grab_worker(queue))
+            break;
+    }
+}
+
+static void pool_queue_submit(struct queue *queue, struct work_item *item)
+{
+    /* Worker will release one reference. Grab one more to keep object alive when
        we need finalization callback. */
     if (item->finalization_callback)
         IUnknown_AddRef(&item->IUnknown_iface);
-    work_object = CreateThreadpoolWork(standard_queue_worker, item, (TP_CALLBACK_ENVIRON *)&env);
-    SubmitThreadpoolWork(work_object);
+
+    if (TRACE_ON(mfplat))
+    {
+        LARGE_INTEGER now;
+
+        QueryPerformanceCounter(&now);
+        item->submit_time = now.QuadPart;
+    }
+
+    InterlockedPushEntrySList(&queue->incoming[get_item_lane(item)], &item->slist_entry);
+
+    if (pool_queue_grab_worker(queue))
+        SubmitThreadpoolWork(queue->work);
 
     TRACE("dispatched %p.\n", item->result);
 }
@@ -580,6 +760,7 @@ static struct work_item * alloc_work_item(struct queue *queue, LONG priority, IR
     item->refcount = 1;
     item->queue = queue;
     list_init(&item->entry);
+    list_init(&item->lane_entry);
     item->priority = priority;
 
     if (SUCCEEDED(IRtwqAsyncCallback_GetParameters(async_result->pCallback, &flags, &queue_id)))
@@ -588,16 +769,20 @@ static struct work_item * alloc_work_item(struct queue *queue, LONG priority, IR
     return item;
 }
 
-static void init_work_queue(const struct queue_desc *desc, struct queue *queue)
+static HRESULT init_work_queue(const struct queue_desc *desc, struct queue *queue)
 {
+    HRESULT hr;
+
     assert(desc->ops != NULL);
 
     queue->ops = desc->ops;
-    if (SUCCEEDED(queue->ops->init(desc, queue)))
+    if (SUCCEEDED(hr = queue->ops->init(desc, queue)))
     {
         list_init(&queue->pending_items);
         InitializeCriticalSection(&queue->cs);
     }
+
+    return hr;
 }
 
 static HRESULT grab_queue(DWORD queue_id, struct queue **ret)
@@ -619,6 +804,7 @@ static HRESULT grab_queue(DWORD queue_id, struct queue **ret)
     else if (queue)
     {
         struct queue_desc desc;
+        HRESULT hr;
 
         EnterCriticalSection(&queues_section);
         switch (queue_id)
@@ -635,8 +821,10 @@ static HRESULT grab_queue(DWORD queue_id, struct queue **ret)
         desc.queue_type = queue_type;
         desc.ops = &pool_queue_ops;
         desc.target_queue = 0;
-        init_work_queue(&desc, queue);
+        hr = init_work_queue(&desc, queue);
         LeaveCriticalSection(&queues_section);
+        if (FAILED(hr))
+            return hr;
         *ret = queue;
         return S_OK;
     }
@@ -890,6 +1078,7 @@ static HRESULT alloc_user_queue(const struct queue_desc *desc, DWORD *queue_id)
     struct queue_handle *entry;
     struct queue *queue;
     unsigned int idx;
+    HRESULT hr;
 
     *queue_id = RTWQ_CALLBACK_QUEUE_UNDEFINED;
 
@@ -900,7 +1089,11 @@ static HRESULT alloc_user_queue(const struct queue_desc *desc, DWORD *queue_id)
     if (!queue)
         return E_OUTOFMEMORY;
 
-    init_work_queue(desc, queue);
+    if (FAILED(hr = init_work_queue(desc, queue)))
+    {
+        heap_free(queue);
+        return hr;
+    }
 
     EnterCriticalSection(&queues_section);
 
@@ -41,6 +41,7 @@ static DWORD   vcomp_context_tls = TLS_OUT_OF_INDEXES;
 static HMODULE vcomp_module;
 static int     vcomp_max_threads;
 static int     vcomp_num_threads;
+static int     vcomp_num_procs;
 static BOOL    vcomp_nested_fork = FALSE;
 
 static RTL_CRITICAL_SECTION vcomp_section;
@@ -57,6 +58,9 @@ static RTL_CRITICAL_SECTION vcomp_section = { &critsect_debug, -1, 0, 0, 0, 0 };
 #define VCOMP_DYNAMIC_FLAGS_GUIDED      0x03
 #define VCOMP_DYNAMIC_FLAGS_INCREMENT   0x40
 
+/* Number of polls before a waiting thread goes to sleep. */
+#define VCOMP_SPIN_COUNT                20000
+
 struct vcomp_thread_data
 {
     struct vcomp_team_data  *team;
@@ -74,12 +78,18 @@ struct vcomp_thread_data
 
     /* section */
     unsigned int            section;
+    int                     num_sections;
 
     /* dynamic */
     unsigned int            dynamic;
     unsigned int            dynamic_type;
     unsigned int            dynamic_begin;
     unsigned int            dynamic_end;
+    unsigned int            dynamic_first;
+    unsigned int            dynamic_last;
+    unsigned int            dynamic_iterations;
+    int                     dynamic_step;
+    unsigned int            dynamic_chunksize;
 };
 
 struct vcomp_team_data
@@ -94,10 +104,17 @@ struct vcomp_team_data
     __ms_va_list            valist;
 
     /* barrier */
-    unsigned int            barrier;
-    int                     barrier_count;
+    LONG                    barrier;
+    LONG                    barrier_count;
+    LONG                    barrier_waiters;
 };
 
+/* The state of sections and dynamic loops is a 64-bit value holding the
+ * generation in the high part and the next section, or the number of
+ * remaining iterations, in the low part, so that threads can claim work with
+ * a single compare-and-swap. The parameters are written by the thread that
+ * claims the generation before it publishes the state, and every thread
+ * keeps its own copy of them. */
 struct vcomp_task_data
 {
     /* single */
@@ -106,7 +123,7 @@ struct vcomp_task_data
     /* section */
     unsigned int            section;
     int                     num_sections;
-    int                     section_index;
+    LONG64                  section_state;
 
     /* dynamic */
     unsigned int            dynamic;
@@ -115,6 +132,7 @@ struct vcomp_task_data
     unsigned int            dynamic_iterations;
     int                     dynamic_step;
     unsigned int            dynamic_chunksize;
+    LONG64                  dynamic_state;
 };
 
 #if defined(__i386__)
@@ -366,6 +384,75 @@ static short interlocked_xchg_add16(short *dest, short incr)
 
 #endif  /* __GNUC__ */
 
+static inline void small_pause(void)
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __asm__ __volatile__( "rep;nop" : : : "memory" );
+#elif defined(__GNUC__)
+    __asm__ __volatile__( "" : : : "memory" );
+#endif
+}
+
+static inline LONG64 vcomp_read_state(LONG64 *state)
+{
+#ifdef _WIN64
+    return *(volatile LONG64 *)state;
+#else
+    return InterlockedCompareExchange64(state, 0, 0);
+#endif
+}
+
+static inline void vcomp_write_state(LONG64 *state, LONG64 value)
+{
+    LONG64 prev;
+    do prev = vcomp_read_state(state);
+    while (InterlockedCompareExchange64(state, value, prev) != prev);
+}
+
+static inline unsigned int vcomp_state_generation(LONG64 state)
+{
+    return (ULONG64)state >> 32;
+}
+
+static inline LONG64 vcomp_make_state(unsigned int generation, unsigned int value)
+{
+    return (LONG64)(((ULONG64)generation << 32) | value);
+}
+
+/* Claims a new generation of a worksharing construct for the calling thread.
+ * Returns FALSE if another thread of the team already did. */
+static BOOL vcomp_claim_generation(unsigned int *task_generation, unsigned int generation)
+{
+    unsigned int prev;
+
+    for (;;)
+    {
+        prev = *(volatile unsigned int *)task_generation;
+        if ((int)(generation - prev) <= 0)
+            return FALSE;
+        if (InterlockedCompareExchange((LONG *)task_generation, generation, prev) == prev)
+            return TRUE;
+    }
+}
+
+/* Waits until the claiming thread has published the given generation. */
+static void vcomp_wait_generation(LONG64 *state, unsigned int generation)
+{
+    unsigned int i = 0;
+
+    while ((int)(vcomp_state_generation(vcomp_read_state(state)) - generation) < 0)
+    {
+        if (++i % 64) small_pause();
+        else SwitchToThread();
+    }
+}
+
+/* Spinning only pays off if every thread of the team has a processor. */
+static inline BOOL vcomp_can_spin(int num_threads)
+{
+    return num_threads <= vcomp_num_procs;
+}
+
 static inline struct vcomp_thread_data *vcomp_get_thread_data(void)
 {
     return (struct vcomp_thread_data *)TlsGetValue(vcomp_context_tls);
@@ -394,7 +481,9 @@ static struct vcomp_thread_data *vcomp_init_thread_data(void)
 
     data->task.single           = 0;
     data->task.section          = 0;
+    data->task.section_state    = 0;
     data->task.dynamic          = 0;
+    data->task.dynamic_state    = 0;
 
     thread_data = &data->thread;
     thread_data->team           = NULL;
@@ -1041,25 +1130,45 @@ void CDECL _vcomp_flush(void)
 void CDECL _vcomp_barrier(void)
 {
     struct vcomp_team_data *team_data = vcomp_init_thread_data()->team;
+    LONG barrier;
+    int i;
 
     TRACE("()\n");
 
     if (!team_data)
         return;
 
-    EnterCriticalSection(&vcomp_section);
-    if (++team_data->barrier_count >= team_data->num_threads)
+    /* The last thread to arrive moves the team to the next barrier
+     * generation, the others spin for a while and then sleep until it does. */
+    barrier = team_data->barrier;
+    if (InterlockedIncrement(&team_data->barrier_count) >= team_data->num_threads)
     {
-        team_data->barrier++;
         team_data->barrier_count = 0;
-        WakeAllConditionVariable(&team_data->cond);
+        InterlockedIncrement(&team_data->barrier);
+        if (team_data->barrier_waiters)
+        {
+            EnterCriticalSection(&vcomp_section);
+            WakeAllConditionVariable(&team_data->cond);
+            LeaveCriticalSection(&vcomp_section);
+        }
+        return;
     }
-    else
+
+    if (vcomp_can_spin(team_data->num_threads))
     {
-        unsigned int barrier = team_data->barrier;
-        while (team_data->barrier == barrier)
-            SleepConditionVariableCS(&team_data->cond, &vcomp_section, INFINITE);
+        for (i = 0; i < VCOMP_SPIN_COUNT; i++)
+        {
+            if (*(volatile LONG *)&team_data->barrier != barrier)
+                return;
+            small_pause();
+        }
     }
+
+    EnterCriticalSection(&vcomp_section);
+    InterlockedIncrement(&team_data->barrier_waiters);
+    while (*(volatile LONG *)&team_data->barrier == barrier)
+        SleepConditionVariableCS(&team_data->cond, &vcomp_section, INFINITE);
+    InterlockedDecrement(&team_data->barrier_waiters);
     LeaveCriticalSection(&vcomp_section);
 }
 
@@ -1086,20 +1195,10 @@ int CDECL _vcomp_single_begin(int flags)
 {
     struct vcomp_thread_data *thread_data = vcomp_init_thread_data();
     struct vcomp_task_data *task_data = thread_data->task;
-    int ret = FALSE;
 
     TRACE("(%x): semi-stub\n", flags);
 
-    EnterCriticalSection(&vcomp_section);
-    thread_data->single++;
-    if ((int)(thread_data->single - task_data->single) > 0)
-    {
-        task_data->single = thread_data->single;
-        ret = TRUE;
-    }
-    LeaveCriticalSection(&vcomp_section);
-
-    return ret;
+    return vcomp_claim_generation(&task_data->single, ++thread_data->single);
 }
 
 void CDECL _vcomp_single_end(void)
@@ -1115,32 +1214,35 @@ void CDECL _vcomp_sections_init(int n)
 
     TRACE("(%d)\n", n);
 
-    EnterCriticalSection(&vcomp_section);
     thread_data->section++;
-    if ((int)(thread_data->section - task_data->section) > 0)
+    if (vcomp_claim_generation(&task_data->section, thread_data->section))
     {
-        task_data->section       = thread_data->section;
-        task_data->num_sections  = n;
-        task_data->section_index = 0;
+        task_data->num_sections = n;
+        vcomp_write_state(&task_data->section_state, vcomp_make_state(thread_data->section, 0));
     }
-    LeaveCriticalSection(&vcomp_section);
+    vcomp_wait_generation(&task_data->section_state, thread_data->section);
+    thread_data->num_sections = task_data->num_sections;
 }
 
 int CDECL _vcomp_sections_next(void)
 {
     struct vcomp_thread_data *thread_data = vcomp_init_thread_data();
     struct vcomp_task_data *task_data = thread_data->task;
-    int i = -1;
+    LONG64 state;
+    int i;
 
     TRACE("()\n");
 
-    EnterCriticalSection(&vcomp_section);
-    if (thread_data->section == task_data->section &&
-        task_data->section_index != task_data->num_sections)
+    do
     {
-        i = task_data->section_index++;
+        state = vcomp_read_state(&task_data->section_state);
+        if (vcomp_state_generation(state) != thread_data->section)
+            return -1;
+        if ((i = (unsigned int)state) == thread_data->num_sections)
+            return -1;
     }
-    LeaveCriticalSection(&vcomp_section);
+    while (InterlockedCompareExchange64(&task_data->section_state, state + 1, state) != state);
+
     return i;
 }
 
@@ -1326,19 +1428,27 @@ void CDECL _vcomp_for_dynamic_init(unsigned int flags, unsigned int first, unsig
             type = VCOMP_DYNAMIC_FLAGS_GUIDED;
         }
 
-        EnterCriticalSection(&vcomp_section);
         thread_data->dynamic++;
         thread_data->dynamic_type = type;
-        if ((int)(thread_data->dynamic - task_data->dynamic) > 0)
+        if (vcomp_claim_generation(&task_data->dynamic, thread_data->dynamic))
         {
-            task_data->dynamic              = thread_data->dynamic;
             task_data->dynamic_first        = first;
             task_data->dynamic_last         = last;
             task_data->dynamic_iterations   = iterations;
             task_data->dynamic_step         = step;
             task_data->dynamic_chunksize    = chunksize;
+            vcomp_write_state(&task_data->dynamic_state,
+                              vcomp_make_state(thread_data->dynamic, iterations));
         }
-        LeaveCriticalSection(&vcomp_section);
+        vcomp_wait_generation(&task_data->dynamic_state, thread_data->dynamic);
+
+        /* If the team already moved on to a later loop, the copy is garbage,
+         * but _vcomp_for_dynamic_next() won't hand out anything either. */
+        thread_data->dynamic_first      = task_data->dynamic_first;
+        thread_data->dynamic_last       = task_data->dynamic_last;
+        thread_data->dynamic_iterations = task_data->dynamic_iterations;
+        thread_data->dynamic_step       = task_data->dynamic_step;
+        thread_data->dynamic_chunksize  = task_data->dynamic_chunksize;
     }
 }
 
@@ -1361,26 +1471,34 @@ int CDECL _vcomp_for_dynamic_next(unsigned int *begin, unsigned int *end)
     else if (thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_CHUNKED ||
              thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_GUIDED)
     {
-        unsigned int iterations = 0;
-        EnterCriticalSection(&vcomp_section);
-        if (thread_data->dynamic == task_data->dynamic &&
-            task_data->dynamic_iterations != 0)
+        unsigned int iterations, remaining;
+        LONG64 state;
+
+        do
         {
-            iterations = min(task_data->dynamic_iterations, task_data->dynamic_chunksize);
+            state = vcomp_read_state(&task_data->dynamic_state);
+            if (vcomp_state_generation(state) != thread_data->dynamic)
+                return 0;
+            if (!(remaining = (unsigned int)state))
+                return 0;
+
+            iterations = min(remaining, thread_data->dynamic_chunksize);
             if (thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_GUIDED &&
-                task_data->dynamic_iterations > num_threads * task_data->dynamic_chunksize)
+                remaining > num_threads * thread_data->dynamic_chunksize)
             {
-                iterations = (task_data->dynamic_iterations + num_threads - 1) / num_threads;
+                iterations = (remaining + num_threads - 1) / num_threads;
             }
-            *begin = task_data->dynamic_first;
-            *end   = task_data->dynamic_first + (iterations - 1) * task_data->dynamic_step;
-            task_data->dynamic_iterations -= iterations;
-            task_data->dynamic_first      += iterations * task_data->dynamic_step;
-            if (!task_data->dynamic_iterations)
-                *end = task_data->dynamic_last;
+            if (!iterations)
+                return 0;
         }
-        LeaveCriticalSection(&vcomp_section);
-        return iterations != 0;
+        while (InterlockedCompareExchange64(&task_data->dynamic_state, state - iterations, state) != state);
+
+        *begin = thread_data->dynamic_first +
+                 (thread_data->dynamic_iterations - remaining) * thread_data->dynamic_step;
+        *end   = *begin + (iterations - 1) * thread_data->dynamic_step;
+        if (iterations == remaining)
+            *end = thread_data->dynamic_last;
+        return 1;
     }
 
     return 0;
@@ -1414,6 +1532,23 @@ static DWORD WINAPI _vcomp_fork_worker(void *param)
             list_add_tail(&vcomp_idle_threads, &thread_data->entry);
             if (++team->finished_threads >= team->num_threads)
                 WakeAllConditionVariable(&team->cond);
+
+            /* stay hot for a while, programs often run parallel regions back to back */
+            if (vcomp_can_spin(team->num_threads))
+            {
+                int i;
+
+                LeaveCriticalSection(&vcomp_section);
+                for (i = 0; i < VCOMP_SPIN_COUNT; i++)
+                {
+                    if (*(struct vcomp_team_data * volatile *)&thread_data->team)
+                        break;
+                    small_pause();
+                }
+                EnterCriticalSection(&vcomp_section);
+                if (thread_data->team)
+                    continue;
+            }
         }
 
         if (!SleepConditionVariableCS(&thread_data->cond, &vcomp_section, 5000) &&
@@ -1461,10 +1596,13 @@ void WINAPIV _vcomp_fork(BOOL ifval, int nargs, void *wrapper, ...)
     __ms_va_start(team_data.valist, wrapper);
     team_data.barrier           = 0;
     team_data.barrier_count     = 0;
+    team_data.barrier_waiters   = 0;
 
     task_data.single            = 0;
     task_data.section           = 0;
+    task_data.section_state     = 0;
     task_data.dynamic           = 0;
+    task_data.dynamic_state     = 0;
 
     thread_data.team            = &team_data;
     thread_data.task            = &task_data;
@@ -1546,6 +1684,18 @@ void WINAPIV _vcomp_fork(BOOL ifval, int nargs, void *wrapper, ...)
 
     if (team_data.num_threads > 1)
     {
+        int i;
+
+        if (vcomp_can_spin(team_data.num_threads))
+        {
+            for (i = 0; i < VCOMP_SPIN_COUNT; i++)
+            {
+                if (*(volatile int *)&team_data.finished_threads >= team_data.num_threads - 1)
+                    break;
+                small_pause();
+            }
+        }
+
         EnterCriticalSection(&vcomp_section);
 
         team_data.finished_threads++;
@@ -1680,6 +1830,7 @@ BOOL WINAPI DllMain(HINSTANCE instance, DWORD reason, LPVOID reserved)
             vcomp_module      = instance;
             vcomp_max_threads = sysinfo.dwNumberOfProcessors;
             vcomp_num_threads = sysinfo.dwNumberOfProcessors;
+            vcomp_num_procs   = sysinfo.dwNumberOfProcessors;
             break;
         }
 
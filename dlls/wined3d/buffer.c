@@ -28,6 +28,7 @@
 #include "wined3d_private.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 
 #define WINED3D_BUFFER_HASDESC      0x01    /* A vertex description has been found. */
 #define WINED3D_BUFFER_USE_BO       0x02    /* Use a buffer object for this buffer. */
@@ -759,6 +760,19 @@ static void wined3d_buffer_destroy_object(void *object)
 
 void wined3d_buffer_cleanup(struct wined3d_buffer *buffer)
 {
+    struct wined3d_device *device = buffer->resource.device;
+    unsigned int serial;
+
+    /* A streaming ring allocation that is still mapped would keep every
+     * later allocation from being reused; retire it without an upload. */
+    if (buffer->stream_data)
+    {
+        TRACE("Releasing streaming ring memory of mapped buffer %p.\n", buffer);
+        serial = wined3d_streaming_ring_submit(&device->streaming_ring, buffer->stream_entry);
+        wined3d_cs_emit_stream_buffer(device->cs, NULL, NULL, serial);
+        buffer->stream_data = NULL;
+    }
+
     wined3d_cs_destroy_object(buffer->resource.device->cs, wined3d_buffer_destroy_object, buffer);
     resource_cleanup(&buffer->resource);
 }
@@ -983,6 +997,211 @@ struct wined3d_resource * CDECL wined3d_buffer_get_resource(struct wined3d_buffe
     return &buffer->resource;
 }
 
+static void wined3d_streaming_ring_update_tail(struct wined3d_streaming_ring *ring)
+{
+    unsigned int completed = *(volatile LONG *)&ring->completed_serial;
+    struct wined3d_streaming_ring_entry *entry;
+
+    while (ring->entry_tail != ring->entry_head)
+    {
+        entry = &ring->entries[ring->entry_tail % WINED3D_STREAMING_RING_ENTRY_COUNT];
+        if (!entry->serial || (int)(entry->serial - completed) > 0)
+            break;
+        ring->tail = entry->end;
+        ++ring->entry_tail;
+    }
+}
+
+static BYTE *wined3d_streaming_ring_alloc(struct wined3d_streaming_ring *ring,
+        unsigned int size, unsigned int *entry_idx)
+{
+    const struct wined3d_streaming_ring_entry *first;
+    struct wined3d_streaming_ring_entry *entry;
+    unsigned int offset, pad;
+    BOOL stalled = FALSE;
+
+    if (!ring->data)
+    {
+        if (!(ring->memory = heap_alloc(WINED3D_STREAMING_RING_SIZE + RESOURCE_ALIGNMENT - 1)))
+        {
+            ERR("Failed to allocate streaming ring memory.\n");
+            return NULL;
+        }
+        ring->data = (BYTE *)(((ULONG_PTR)ring->memory + RESOURCE_ALIGNMENT - 1) & ~(RESOURCE_ALIGNMENT - 1));
+    }
+
+    size = (size + RESOURCE_ALIGNMENT - 1) & ~(RESOURCE_ALIGNMENT - 1);
+
+    for (;;)
+    {
+        wined3d_streaming_ring_update_tail(ring);
+
+        offset = ring->head & (WINED3D_STREAMING_RING_SIZE - 1);
+        pad = offset + size > WINED3D_STREAMING_RING_SIZE ? WINED3D_STREAMING_RING_SIZE - offset : 0;
+        if (ring->head - ring->tail + pad + size <= WINED3D_STREAMING_RING_SIZE
+                && ring->entry_head - ring->entry_tail < WINED3D_STREAMING_RING_ENTRY_COUNT)
+            break;
+
+        /* The oldest allocation is still mapped by the application; waiting
+         * for it would never finish. */
+        first = &ring->entries[ring->entry_tail % WINED3D_STREAMING_RING_ENTRY_COUNT];
+        if (ring->entry_tail == ring->entry_head || !first->serial)
+        {
+            TRACE("Streaming ring is full.\n");
+            return NULL;
+        }
+
+        if (!stalled)
+        {
+            WARN_(d3d_perf)("Waiting for the command stream to release streaming ring memory.\n");
+            ++ring->stall_count;
+            stalled = TRUE;
+        }
+        wined3d_pause();
+    }
+
+    *entry_idx = ring->entry_head;
+    entry = &ring->entries[ring->entry_head++ % WINED3D_STREAMING_RING_ENTRY_COUNT];
+    entry->end = ring->head + pad + size;
+    entry->serial = 0;
+    ring->head = entry->end;
+    ring->streamed_bytes += size;
+
+    return ring->data + ((offset + pad) & (WINED3D_STREAMING_RING_SIZE - 1));
+}
+
+unsigned int wined3d_streaming_ring_submit(struct wined3d_streaming_ring *ring, unsigned int entry_idx)
+{
+    struct wined3d_streaming_ring_entry *entry = &ring->entries[entry_idx % WINED3D_STREAMING_RING_ENTRY_COUNT];
+
+    /* Serial 0 marks allocations that are still mapped. */
+    if (!++ring->submit_serial)
+        ++ring->submit_serial;
+    entry->serial = ring->submit_serial;
+
+    return entry->serial;
+}
+
+void wined3d_streaming_ring_end_frame(struct wined3d_streaming_ring *ring)
+{
+    DWORD time;
+
+    if (!TRACE_ON(d3d_perf))
+        return;
+
+    time = GetTickCount();
+    ++ring->frames;
+
+    /* every 1.5 seconds */
+    if (time - ring->prev_time > 1500)
+    {
+        TRACE_(d3d_perf)("Streamed approx %s bytes/frame, %u streaming ring stall(s).\n",
+                wine_dbgstr_longlong(ring->streamed_bytes / ring->frames), ring->stall_count);
+        ring->prev_time = time;
+        ring->frames = 0;
+        ring->streamed_bytes = 0;
+        ring->stall_count = 0;
+    }
+}
+
+void wined3d_streaming_ring_cleanup(struct wined3d_streaming_ring *ring)
+{
+    heap_free(ring->memory);
+    ring->memory = NULL;
+    ring->data = NULL;
+}
+
+/* DISCARD maps of dynamic buffers don't need to wait for the command stream
+ * to become idle. The application writes into streaming ring memory, which
+ * is uploaded in order with the rest of the command stream on unmap. */
+BOOL wined3d_buffer_map_streaming(struct wined3d_buffer *buffer, struct wined3d_map_desc *map_desc,
+        const struct wined3d_box *box, uint32_t flags)
+{
+    struct wined3d_resource *resource = &buffer->resource;
+    struct wined3d_device *device = resource->device;
+
+    if (!buffer->stream_data)
+    {
+        if (!device->cs->thread || device->cs->thread_id == GetCurrentThreadId())
+            return FALSE;
+        if ((flags & (WINED3D_MAP_READ | WINED3D_MAP_DISCARD)) != WINED3D_MAP_DISCARD)
+            return FALSE;
+        /* Pinned buffers retain their contents in DISCARD maps. */
+        if (resource->map_count || buffer->flags & WINED3D_BUFFER_PIN_SYSMEM
+                || resource->size > WINED3D_STREAMING_MAX_BUFFER_SIZE)
+            return FALSE;
+
+        if (!(buffer->stream_data = wined3d_streaming_ring_alloc(&device->streaming_ring,
+                resource->size, &buffer->stream_entry)))
+            return FALSE;
+    }
+
+    TRACE("Mapping buffer %p through the streaming ring.\n", buffer);
+
+    ++buffer->stream_map_count;
+    map_desc->row_pitch = map_desc->slice_pitch = resource->size;
+    map_desc->data = buffer->stream_data + (box ? box->left : 0);
+
+    return TRUE;
+}
+
+BOOL wined3d_buffer_unmap_streaming(struct wined3d_buffer *buffer)
+{
+    struct wined3d_device *device = buffer->resource.device;
+    unsigned int serial;
+
+    if (!buffer->stream_data)
+        return FALSE;
+
+    if (--buffer->stream_map_count)
+    {
+        TRACE("Ignoring unmap.\n");
+        return TRUE;
+    }
+
+    serial = wined3d_streaming_ring_submit(&device->streaming_ring, buffer->stream_entry);
+    wined3d_cs_emit_stream_buffer(device->cs, buffer, buffer->stream_data, serial);
+    buffer->stream_data = NULL;
+
+    return TRUE;
+}
+
+/* Context activation is done by the caller. */
+void wined3d_buffer_upload_streamed_data(struct wined3d_buffer *buffer,
+        struct wined3d_context *context, const void *data)
+{
+    struct wined3d_resource *resource = &buffer->resource;
+    DWORD location = WINED3D_LOCATION_BUFFER;
+    struct wined3d_range range;
+
+    TRACE("buffer %p, context %p, data %p.\n", buffer, context, data);
+
+    if (!(buffer->flags & WINED3D_BUFFER_USE_BO) || buffer->flags & WINED3D_BUFFER_PIN_SYSMEM
+            || buffer->conversion_map || !wined3d_buffer_prepare_location(buffer, context, location))
+        location = WINED3D_LOCATION_SYSMEM;
+
+    if (location == WINED3D_LOCATION_SYSMEM)
+    {
+        if (!wined3d_buffer_prepare_location(buffer, context, location))
+        {
+            ERR("Failed to prepare location %s.\n", wined3d_debug_location(location));
+            return;
+        }
+        memcpy(resource->heap_memory, data, resource->size);
+    }
+    else
+    {
+        range.offset = 0;
+        range.size = resource->size;
+        buffer->buffer_ops->buffer_upload_ranges(buffer, context, data, 0, 1, &range);
+    }
+
+    wined3d_buffer_validate_location(buffer, location);
+    wined3d_buffer_invalidate_location(buffer, ~location);
+    if (location == WINED3D_LOCATION_BUFFER && resource->heap_memory)
+        wined3d_buffer_evict_sysmem(buffer);
+}
+
 static HRESULT buffer_resource_sub_resource_map(struct wined3d_resource *resource, unsigned int sub_resource_idx,
         struct wined3d_map_desc *map_desc, const struct wined3d_box *box, uint32_t flags)
 {
@@ -70,6 +70,7 @@ enum wined3d_cs_op
     WINED3D_CS_OP_UNMAP,
     WINED3D_CS_OP_BLT_SUB_RESOURCE,
     WINED3D_CS_OP_UPDATE_SUB_RESOURCE,
+    WINED3D_CS_OP_STREAM_BUFFER,
     WINED3D_CS_OP_ADD_DIRTY_TEXTURE_REGION,
     WINED3D_CS_OP_CLEAR_UNORDERED_ACCESS_VIEW,
     WINED3D_CS_OP_COPY_UAV_COUNTER,
@@ -413,6 +414,14 @@ struct wined3d_cs_update_sub_resource
     BYTE copy_data[1];
 };
 
+struct wined3d_cs_stream_buffer
+{
+    enum wined3d_cs_op opcode;
+    struct wined3d_buffer *buffer;
+    const void *data;
+    unsigned int serial;
+};
+
 struct wined3d_cs_add_dirty_texture_region
 {
     enum wined3d_cs_op opcode;
@@ -505,6 +514,7 @@ static const char *debug_cs_op(enum wined3d_cs_op op)
         WINED3D_TO_STR(WINED3D_CS_OP_UNMAP);
         WINED3D_TO_STR(WINED3D_CS_OP_BLT_SUB_RESOURCE);
         WINED3D_TO_STR(WINED3D_CS_OP_UPDATE_SUB_RESOURCE);
+        WINED3D_TO_STR(WINED3D_CS_OP_STREAM_BUFFER);
         WINED3D_TO_STR(WINED3D_CS_OP_ADD_DIRTY_TEXTURE_REGION);
         WINED3D_TO_STR(WINED3D_CS_OP_CLEAR_UNORDERED_ACCESS_VIEW);
         WINED3D_TO_STR(WINED3D_CS_OP_COPY_UAV_COUNTER);
@@ -569,6 +579,7 @@ static void wined3d_cs_exec_present(struct wined3d_cs *cs, const void *data)
     }
 
     swapchain->swapchain_ops->swapchain_present(swapchain, &op->src_rect, &op->dst_rect, op->swap_interval, op->flags);
+    wined3d_swapchain_present_completed(swapchain);
 
     /* Discard buffers if the swap effect allows it. */
     back_buffer = swapchain->back_buffers[desc->backbuffer_count - 1];
@@ -626,6 +637,8 @@ void wined3d_cs_emit_present(struct wined3d_cs *cs, struct wined3d_swapchain *sw
 
     pending = InterlockedIncrement(&cs->pending_presents);
 
+    wined3d_streaming_ring_end_frame(&cs->device->streaming_ring);
+
     wined3d_resource_acquire(&swapchain->front_buffer->resource);
     for (i = 0; i < swapchain->state.desc.backbuffer_count; ++i)
     {
@@ -2500,6 +2513,42 @@ no_async:
     wined3d_cs_finish(cs, WINED3D_CS_QUEUE_MAP);
 }
 
+static void wined3d_cs_exec_stream_buffer(struct wined3d_cs *cs, const void *data)
+{
+    const struct wined3d_cs_stream_buffer *op = data;
+    struct wined3d_buffer *buffer = op->buffer;
+    struct wined3d_context *context;
+
+    /* Allocations of destroyed buffers are only retired. */
+    if (buffer)
+    {
+        context = context_acquire(cs->device, NULL, 0);
+        wined3d_buffer_upload_streamed_data(buffer, context, op->data);
+        context_release(context);
+    }
+
+    wined3d_streaming_ring_retire(&cs->device->streaming_ring, op->serial);
+    if (buffer)
+        wined3d_resource_release(&buffer->resource);
+}
+
+void wined3d_cs_emit_stream_buffer(struct wined3d_cs *cs, struct wined3d_buffer *buffer,
+        const void *data, unsigned int serial)
+{
+    struct wined3d_cs_stream_buffer *op;
+
+    op = wined3d_cs_require_space(cs, sizeof(*op), WINED3D_CS_QUEUE_DEFAULT);
+    op->opcode = WINED3D_CS_OP_STREAM_BUFFER;
+    op->buffer = buffer;
+    op->data = data;
+    op->serial = serial;
+
+    if (buffer)
+        wined3d_resource_acquire(&buffer->resource);
+
+    wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
+}
+
 static void wined3d_cs_exec_add_dirty_texture_region(struct wined3d_cs *cs, const void *data)
 {
     const struct wined3d_cs_add_dirty_texture_region *op = data;
@@ -2671,6 +2720,7 @@ static void (* const wined3d_cs_op_handlers[])(struct wined3d_cs *cs, const void
     /* WINED3D_CS_OP_UNMAP                       */ wined3d_cs_exec_unmap,
     /* WINED3D_CS_OP_BLT_SUB_RESOURCE            */ wined3d_cs_exec_blt_sub_resource,
     /* WINED3D_CS_OP_UPDATE_SUB_RESOURCE         */ wined3d_cs_exec_update_sub_resource,
+    /* WINED3D_CS_OP_STREAM_BUFFER               */ wined3d_cs_exec_stream_buffer,
     /* WINED3D_CS_OP_ADD_DIRTY_TEXTURE_REGION    */ wined3d_cs_exec_add_dirty_texture_region,
     /* WINED3D_CS_OP_CLEAR_UNORDERED_ACCESS_VIEW */ wined3d_cs_exec_clear_unordered_access_view,
     /* WINED3D_CS_OP_COPY_UAV_COUNTER            */ wined3d_cs_exec_copy_uav_counter,
@@ -205,6 +205,7 @@ void wined3d_device_cleanup(struct wined3d_device *device)
         wined3d_device_uninit_3d(device);
 
     wined3d_cs_destroy(device->cs);
+    wined3d_streaming_ring_cleanup(&device->streaming_ring);
 
     for (i = 0; i < ARRAY_SIZE(device->multistate_funcs); ++i)
     {
@@ -321,6 +321,61 @@ HRESULT CDECL wined3d_swapchain_get_raster_status(const struct wined3d_swapchain
     return wined3d_output_get_raster_status(output, raster_status);
 }
 
+/* Called from the CS thread once the presentation engine has been handed
+ * the frame. */
+void wined3d_swapchain_present_completed(struct wined3d_swapchain *swapchain)
+{
+    LARGE_INTEGER time;
+    LONGLONG old;
+
+    QueryPerformanceCounter(&time);
+    do
+    {
+        old = swapchain->present_time;
+    } while (InterlockedCompareExchange64(&swapchain->present_time, time.QuadPart, old) != old);
+    InterlockedIncrement(&swapchain->present_count);
+
+    if (swapchain->present_semaphore)
+        ReleaseSemaphore(swapchain->present_semaphore, 1, NULL);
+}
+
+HRESULT CDECL wined3d_swapchain_get_frame_statistics(const struct wined3d_swapchain *swapchain,
+        struct wined3d_frame_statistics *stats)
+{
+    struct wined3d_display_mode mode;
+    LARGE_INTEGER freq;
+    LONGLONG elapsed;
+
+    TRACE("swapchain %p, stats %p.\n", swapchain, stats);
+
+    if (!(stats->present_count = *(volatile LONG *)&swapchain->present_count))
+        return WINED3DERR_INVALIDCALL;
+    stats->sync_qpc_time.QuadPart = InterlockedCompareExchange64((LONGLONG *)&swapchain->present_time, 0, 0);
+
+    /* We don't get vblank counters from the presentation engine; derive the
+     * refresh count from the time elapsed since the swapchain was created. */
+    if (FAILED(wined3d_swapchain_get_display_mode(swapchain, &mode, NULL)) || !mode.refresh_rate)
+        mode.refresh_rate = 60;
+    QueryPerformanceFrequency(&freq);
+    elapsed = stats->sync_qpc_time.QuadPart - swapchain->creation_time.QuadPart;
+    stats->sync_refresh_count = elapsed * mode.refresh_rate / freq.QuadPart;
+
+    TRACE("Present count %u, sync refresh count %u, sync time %s.\n", stats->present_count,
+            stats->sync_refresh_count, wine_dbgstr_longlong(stats->sync_qpc_time.QuadPart));
+
+    return WINED3D_OK;
+}
+
+/* The semaphore is released once for every completed present. It is owned by
+ * the caller and has to stay valid until the swapchain is destroyed. */
+void CDECL wined3d_swapchain_set_present_semaphore(struct wined3d_swapchain *swapchain, HANDLE semaphore)
+{
+    TRACE("swapchain %p, semaphore %p.\n", swapchain, semaphore);
+
+    wined3d_cs_finish(swapchain->device->cs, WINED3D_CS_QUEUE_DEFAULT);
+    swapchain->present_semaphore = semaphore;
+}
+
 struct wined3d_swapchain_state * CDECL wined3d_swapchain_get_state(struct wined3d_swapchain *swapchain)
 {
     return &swapchain->state;
@@ -1363,6 +1418,7 @@ static HRESULT wined3d_swapchain_init(struct wined3d_swapchain *swapchain, struc
     swapchain->win_handle = window;
     swapchain->swap_interval = WINED3D_SWAP_INTERVAL_DEFAULT;
     swapchain_set_max_frame_latency(swapchain, device);
+    QueryPerformanceCounter(&swapchain->creation_time);
 
     GetClientRect(window, &client_rect);
     if (desc->windowed)
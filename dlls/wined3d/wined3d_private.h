@@ -3632,6 +3632,48 @@ struct wined3d_dummy_textures
 
 #define WINED3D_UNMAPPED_STAGE ~0u
 
+#define WINED3D_STREAMING_RING_SIZE         0x800000u
+#define WINED3D_STREAMING_RING_ENTRY_COUNT  1024u
+#define WINED3D_STREAMING_MAX_BUFFER_SIZE   (WINED3D_STREAMING_RING_SIZE / 4)
+
+struct wined3d_streaming_ring_entry
+{
+    unsigned int end;
+    /* 0 while the allocation is still mapped by the application. */
+    unsigned int serial;
+};
+
+/* Upload ring for WINED3D_MAP_DISCARD maps of dynamic buffers. Allocations
+ * are made by the application thread and retired in submission order once
+ * the command stream has consumed them. Everything except completed_serial
+ * is only accessed from the application thread. */
+struct wined3d_streaming_ring
+{
+    void *memory;
+    BYTE *data;
+    unsigned int head, tail;
+
+    struct wined3d_streaming_ring_entry entries[WINED3D_STREAMING_RING_ENTRY_COUNT];
+    unsigned int entry_head, entry_tail;
+    unsigned int submit_serial;
+    LONG completed_serial;
+
+    DWORD prev_time;
+    unsigned int frames;
+    ULONG64 streamed_bytes;
+    unsigned int stall_count;
+};
+
+void wined3d_streaming_ring_cleanup(struct wined3d_streaming_ring *ring) DECLSPEC_HIDDEN;
+void wined3d_streaming_ring_end_frame(struct wined3d_streaming_ring *ring) DECLSPEC_HIDDEN;
+unsigned int wined3d_streaming_ring_submit(struct wined3d_streaming_ring *ring,
+        unsigned int entry_idx) DECLSPEC_HIDDEN;
+
+static inline void wined3d_streaming_ring_retire(struct wined3d_streaming_ring *ring, unsigned int serial)
+{
+    InterlockedExchange(&ring->completed_serial, serial);
+}
+
 /* Multithreaded flag. Removed from the public header to signal that
  * wined3d_device_create() ignores it. */
 #define WINED3DCREATE_MULTITHREADED 0x00000004
@@ -3707,6 +3749,8 @@ struct wined3d_device
     /* Context management */
     struct wined3d_context **contexts;
     UINT context_count;
+
+    struct wined3d_streaming_ring streaming_ring;
 };
 
 void wined3d_device_cleanup(struct wined3d_device *device) DECLSPEC_HIDDEN;
@@ -4674,6 +4718,8 @@ void wined3d_cs_emit_set_unordered_access_view(struct wined3d_cs *cs, enum wined
 void wined3d_cs_emit_set_vertex_declaration(struct wined3d_cs *cs,
         struct wined3d_vertex_declaration *declaration) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_set_viewports(struct wined3d_cs *cs, unsigned int viewport_count, const struct wined3d_viewport *viewports) DECLSPEC_HIDDEN;
+void wined3d_cs_emit_stream_buffer(struct wined3d_cs *cs, struct wined3d_buffer *buffer,
+        const void *data, unsigned int serial) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_unload_resource(struct wined3d_cs *cs, struct wined3d_resource *resource) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_update_sub_resource(struct wined3d_cs *cs, struct wined3d_resource *resource,
         unsigned int sub_resource_idx, const struct wined3d_box *box, const void *data, unsigned int row_pitch,
@@ -4743,6 +4789,11 @@ struct wined3d_buffer
     SIZE_T maps_size, modified_areas;
     struct wined3d_fence *fence;
 
+    /* WINED3D_MAP_DISCARD maps served from the device streaming ring. */
+    BYTE *stream_data;
+    unsigned int stream_entry;
+    unsigned int stream_map_count;
+
     /* conversion stuff */
     UINT decl_change_count, full_conversion_count;
     UINT draw_count;
@@ -4767,10 +4818,15 @@ void wined3d_buffer_load(struct wined3d_buffer *buffer, struct wined3d_context *
 BOOL wined3d_buffer_load_location(struct wined3d_buffer *buffer,
         struct wined3d_context *context, DWORD location) DECLSPEC_HIDDEN;
 BYTE *wined3d_buffer_load_sysmem(struct wined3d_buffer *buffer, struct wined3d_context *context) DECLSPEC_HIDDEN;
+BOOL wined3d_buffer_map_streaming(struct wined3d_buffer *buffer, struct wined3d_map_desc *map_desc,
+        const struct wined3d_box *box, uint32_t flags) DECLSPEC_HIDDEN;
 BOOL wined3d_buffer_prepare_location(struct wined3d_buffer *buffer,
         struct wined3d_context *context, unsigned int location) DECLSPEC_HIDDEN;
+BOOL wined3d_buffer_unmap_streaming(struct wined3d_buffer *buffer) DECLSPEC_HIDDEN;
 void wined3d_buffer_upload_data(struct wined3d_buffer *buffer, struct wined3d_context *context,
         const struct wined3d_box *box, const void *data) DECLSPEC_HIDDEN;
+void wined3d_buffer_upload_streamed_data(struct wined3d_buffer *buffer,
+        struct wined3d_context *context, const void *data) DECLSPEC_HIDDEN;
 
 HRESULT wined3d_buffer_no3d_init(struct wined3d_buffer *buffer_no3d, struct wined3d_device *device,
         const struct wined3d_buffer_desc *desc, const struct wined3d_sub_resource_data *data,
@@ -5070,6 +5126,12 @@ struct wined3d_swapchain
 
     LONG prev_time, frames;   /* Performance tracking */
 
+    /* Updated by the CS thread when a present completes. */
+    LONG present_count;
+    LONGLONG present_time;
+    LARGE_INTEGER creation_time;
+    HANDLE present_semaphore;
+
     struct wined3d_swapchain_state state;
     HWND win_handle;
 };
@@ -5077,6 +5139,7 @@ struct wined3d_swapchain
 void wined3d_swapchain_activate(struct wined3d_swapchain *swapchain, BOOL activate) DECLSPEC_HIDDEN;
 void wined3d_swapchain_cleanup(struct wined3d_swapchain *swapchain) DECLSPEC_HIDDEN;
 struct wined3d_output * wined3d_swapchain_get_output(const struct wined3d_swapchain *swapchain) DECLSPEC_HIDDEN;
+void wined3d_swapchain_present_completed(struct wined3d_swapchain *swapchain) DECLSPEC_HIDDEN;
 void swapchain_update_draw_bindings(struct wined3d_swapchain *swapchain) DECLSPEC_HIDDEN;
 void swapchain_set_max_frame_latency(struct wined3d_swapchain *swapchain,
         const struct wined3d_device *device) DECLSPEC_HIDDEN;
@@ -86,6 +86,140 @@ void start_dispatch_thread(void)
     CloseHandle(CreateThread(NULL, 0, &dispatch_thread, NULL, 0, NULL));
 }
 
+/* GStreamer lets applications provide the threads streaming tasks run on. We
+ * start them with CreateThread(), so that callbacks from the data path can be
+ * executed directly instead of being dispatched to another thread. Tasks
+ * started from threads Wine didn't create still use the default pool. */
+
+typedef struct
+{
+    GstTaskPool parent;
+} WineTaskPool;
+
+typedef struct
+{
+    GstTaskPoolClass parent_class;
+} WineTaskPoolClass;
+
+G_DEFINE_TYPE(WineTaskPool, wine_task_pool, GST_TYPE_TASK_POOL);
+
+struct wine_task
+{
+    GstTaskPoolFunction func;
+    gpointer user_data;
+    gpointer parent_id;
+    BOOL wine_thread;
+    int finished;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+};
+
+static DWORD WINAPI wine_task_thread(void *arg)
+{
+    struct wine_task *task = arg;
+
+    mark_wine_thread();
+    CoInitializeEx(NULL, COINIT_MULTITHREADED);
+
+    task->func(task->user_data);
+
+    CoUninitialize();
+
+    pthread_mutex_lock(&task->lock);
+    task->finished = 1;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return 0;
+}
+
+static gpointer wine_task_pool_push(GstTaskPool *pool, GstTaskPoolFunction func, gpointer user_data, GError **error)
+{
+    struct wine_task *task;
+    HANDLE thread;
+
+    if (!(task = g_try_new0(struct wine_task, 1)))
+    {
+        g_set_error(error, G_THREAD_ERROR, G_THREAD_ERROR_AGAIN, "Out of memory");
+        return NULL;
+    }
+    task->func = func;
+    task->user_data = user_data;
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->cond, NULL);
+
+    if (is_wine_thread() && (thread = CreateThread(NULL, 0, wine_task_thread, task, 0, NULL)))
+    {
+        CloseHandle(thread);
+        task->wine_thread = TRUE;
+        return task;
+    }
+
+    task->parent_id = GST_TASK_POOL_CLASS(wine_task_pool_parent_class)->push(pool, func, user_data, error);
+    if (error && *error)
+    {
+        pthread_cond_destroy(&task->cond);
+        pthread_mutex_destroy(&task->lock);
+        g_free(task);
+        return NULL;
+    }
+    return task;
+}
+
+static void wine_task_pool_join(GstTaskPool *pool, gpointer id)
+{
+    struct wine_task *task = id;
+
+    if (task->wine_thread)
+    {
+        pthread_mutex_lock(&task->lock);
+        while (!task->finished)
+            pthread_cond_wait(&task->cond, &task->lock);
+        pthread_mutex_unlock(&task->lock);
+    }
+    else
+        GST_TASK_POOL_CLASS(wine_task_pool_parent_class)->join(pool, task->parent_id);
+
+    pthread_cond_destroy(&task->cond);
+    pthread_mutex_destroy(&task->lock);
+    g_free(task);
+}
+
+static void wine_task_pool_class_init(WineTaskPoolClass *klass)
+{
+    GstTaskPoolClass *pool_class = GST_TASK_POOL_CLASS(klass);
+
+    pool_class->push = wine_task_pool_push;
+    pool_class->join = wine_task_pool_join;
+}
+
+static void wine_task_pool_init(WineTaskPool *pool)
+{
+}
+
+static GstTaskPool *wine_task_pool;
+
+static void init_wine_task_pool(void)
+{
+    GError *error = NULL;
+
+    wine_task_pool = g_object_new(wine_task_pool_get_type(), NULL);
+    gst_task_pool_prepare(wine_task_pool, &error);
+    if (error)
+    {
+        g_error_free(error);
+        gst_object_unref(wine_task_pool);
+        wine_task_pool = NULL;
+    }
+}
+
+static GstTaskPool *get_wine_task_pool(void)
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+    pthread_once(&once, init_wine_task_pool);
+    return wine_task_pool;
+}
+
 /* gstreamer calls our callbacks from threads that Wine did not create. Some
  * callbacks execute code which requires Wine to have created the thread
  * (critical sections, debug logging, dshow client code). Since gstreamer can't
@@ -138,6 +272,22 @@ GstBusSyncReply watch_bus_wrapper(GstBus *bus, GstMessage *msg, gpointer user)
 {
     struct cb_data cbdata = { WATCH_BUS };
 
+    /* This doesn't need a Wine thread, and has to be done before the task
+     * is started. */
+    if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_STREAM_STATUS)
+    {
+        GstStreamStatusType type;
+        const GValue *value;
+        GstElement *owner;
+        GstTaskPool *pool;
+
+        gst_message_parse_stream_status(msg, &type, &owner);
+        value = gst_message_get_stream_status_object(msg);
+        if (type == GST_STREAM_STATUS_TYPE_CREATE && value && G_VALUE_HOLDS(value, GST_TYPE_TASK)
+                && (pool = get_wine_task_pool()))
+            gst_task_set_pool(g_value_get_object(value), pool);
+    }
+
     cbdata.u.watch_bus_data.bus = bus;
     cbdata.u.watch_bus_data.msg = msg;
     cbdata.u.watch_bus_data.user = user;
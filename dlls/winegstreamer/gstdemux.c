@@ -82,6 +82,10 @@ struct gstdemux_source
     HANDLE caps_event;
     GstSegment *segment;
     SourceSeeking seek;
+
+    /* throughput statistics */
+    DWORD stats_time;
+    unsigned int stats_buffers;
 };
 
 static inline struct gstdemux *impl_from_strmbase_filter(struct strmbase_filter *iface)
@@ -801,6 +805,539 @@ static DWORD CALLBACK push_data(LPVOID iface)
     return 0;
 }
 
+/* Zero-copy delivery: if the downstream pin accepts a read-only allocator,
+ * samples wrap the mapped GstBuffers instead of copying them. */
+
+struct gst_sample
+{
+    IMediaSample IMediaSample_iface;
+    LONG refcount;
+
+    IMemAllocator *allocator;
+    GstBuffer *buffer;
+    GstMapInfo map;
+    LONG length;
+
+    REFERENCE_TIME start, stop;
+    REFERENCE_TIME media_start, media_stop;
+    BOOL time_valid, stop_valid, media_time_valid;
+    BOOL sync_point, preroll, discontinuity;
+    AM_MEDIA_TYPE *mt;
+};
+
+struct gst_allocator
+{
+    IMemAllocator IMemAllocator_iface;
+    LONG refcount;
+
+    ALLOCATOR_PROPERTIES props;
+    BOOL committed;
+};
+
+static const IMediaSampleVtbl gst_sample_vtbl;
+static const IMemAllocatorVtbl gst_allocator_vtbl;
+
+static inline struct gst_sample *impl_from_IMediaSample(IMediaSample *iface)
+{
+    return CONTAINING_RECORD(iface, struct gst_sample, IMediaSample_iface);
+}
+
+static inline struct gst_allocator *impl_from_IMemAllocator(IMemAllocator *iface)
+{
+    return CONTAINING_RECORD(iface, struct gst_allocator, IMemAllocator_iface);
+}
+
+static HRESULT WINAPI gst_sample_QueryInterface(IMediaSample *iface, REFIID iid, void **out)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p, iid %s, out %p.\n", sample, debugstr_guid(iid), out);
+
+    if (IsEqualGUID(iid, &IID_IUnknown) || IsEqualGUID(iid, &IID_IMediaSample))
+    {
+        IMediaSample_AddRef(*out = iface);
+        return S_OK;
+    }
+
+    WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(iid));
+    *out = NULL;
+    return E_NOINTERFACE;
+}
+
+static ULONG WINAPI gst_sample_AddRef(IMediaSample *iface)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+    ULONG refcount = InterlockedIncrement(&sample->refcount);
+
+    TRACE("%p increasing refcount to %u.\n", sample, refcount);
+    return refcount;
+}
+
+static ULONG WINAPI gst_sample_Release(IMediaSample *iface)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+    ULONG refcount = InterlockedDecrement(&sample->refcount);
+
+    TRACE("%p decreasing refcount to %u.\n", sample, refcount);
+
+    if (!refcount)
+    {
+        mark_wine_thread();
+        gst_buffer_unmap(sample->buffer, &sample->map);
+        gst_buffer_unref(sample->buffer);
+        if (sample->mt)
+            DeleteMediaType(sample->mt);
+        IMemAllocator_ReleaseBuffer(sample->allocator, iface);
+        IMemAllocator_Release(sample->allocator);
+        heap_free(sample);
+    }
+    return refcount;
+}
+
+static HRESULT WINAPI gst_sample_GetPointer(IMediaSample *iface, BYTE **data)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p, data %p.\n", sample, data);
+
+    *data = sample->map.data;
+    return S_OK;
+}
+
+static LONG WINAPI gst_sample_GetSize(IMediaSample *iface)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p.\n", sample);
+
+    return sample->map.size;
+}
+
+static HRESULT WINAPI gst_sample_GetTime(IMediaSample *iface, REFERENCE_TIME *start, REFERENCE_TIME *stop)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p, start %p, stop %p.\n", sample, start, stop);
+
+    if (!sample->time_valid)
+        return VFW_E_SAMPLE_TIME_NOT_SET;
+
+    *start = sample->start;
+    if (!sample->stop_valid)
+    {
+        *stop = sample->start + 1;
+        return VFW_S_NO_STOP_TIME;
+    }
+    *stop = sample->stop;
+    return S_OK;
+}
+
+static HRESULT WINAPI gst_sample_SetTime(IMediaSample *iface, REFERENCE_TIME *start, REFERENCE_TIME *stop)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p, start %p, stop %p.\n", sample, start, stop);
+
+    sample->time_valid = !!start;
+    sample->stop_valid = start && stop;
+    if (start)
+        sample->start = *start;
+    if (start && stop)
+        sample->stop = *stop;
+    return S_OK;
+}
+
+static HRESULT WINAPI gst_sample_IsSyncPoint(IMediaSample *iface)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p.\n", sample);
+
+    return sample->sync_point ? S_OK : S_FALSE;
+}
+
+static HRESULT WINAPI gst_sample_SetSyncPoint(IMediaSample *iface, BOOL sync_point)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p, sync_point %d.\n", sample, sync_point);
+
+    sample->sync_point = sync_point;
+    return S_OK;
+}
+
+static HRESULT WINAPI gst_sample_IsPreroll(IMediaSample *iface)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p.\n", sample);
+
+    return sample->preroll ? S_OK : S_FALSE;
+}
+
+static HRESULT WINAPI gst_sample_SetPreroll(IMediaSample *iface, BOOL preroll)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p, preroll %d.\n", sample, preroll);
+
+    sample->preroll = preroll;
+    return S_OK;
+}
+
+static LONG WINAPI gst_sample_GetActualDataLength(IMediaSample *iface)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p.\n", sample);
+
+    return sample->length;
+}
+
+static HRESULT WINAPI gst_sample_SetActualDataLength(IMediaSample *iface, LONG length)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p, length %d.\n", sample, length);
+
+    if (length < 0 || length > sample->map.size)
+        return VFW_E_BUFFER_OVERFLOW;
+
+    sample->length = length;
+    return S_OK;
+}
+
+static HRESULT WINAPI gst_sample_GetMediaType(IMediaSample *iface, AM_MEDIA_TYPE **mt)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p, mt %p.\n", sample, mt);
+
+    if (!sample->mt)
+    {
+        *mt = NULL;
+        return S_FALSE;
+    }
+
+    if (!(*mt = CreateMediaType(sample->mt)))
+        return E_OUTOFMEMORY;
+    return S_OK;
+}
+
+static HRESULT WINAPI gst_sample_SetMediaType(IMediaSample *iface, AM_MEDIA_TYPE *mt)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p, mt %p.\n", sample, mt);
+
+    if (sample->mt)
+        DeleteMediaType(sample->mt);
+    sample->mt = NULL;
+
+    if (mt && !(sample->mt = CreateMediaType(mt)))
+        return E_OUTOFMEMORY;
+    return S_OK;
+}
+
+static HRESULT WINAPI gst_sample_IsDiscontinuity(IMediaSample *iface)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p.\n", sample);
+
+    return sample->discontinuity ? S_OK : S_FALSE;
+}
+
+static HRESULT WINAPI gst_sample_SetDiscontinuity(IMediaSample *iface, BOOL discontinuity)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p, discontinuity %d.\n", sample, discontinuity);
+
+    sample->discontinuity = discontinuity;
+    return S_OK;
+}
+
+static HRESULT WINAPI gst_sample_GetMediaTime(IMediaSample *iface, LONGLONG *start, LONGLONG *stop)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p, start %p, stop %p.\n", sample, start, stop);
+
+    if (!sample->media_time_valid)
+        return VFW_E_MEDIA_TIME_NOT_SET;
+
+    *start = sample->media_start;
+    *stop = sample->media_stop;
+    return S_OK;
+}
+
+static HRESULT WINAPI gst_sample_SetMediaTime(IMediaSample *iface, LONGLONG *start, LONGLONG *stop)
+{
+    struct gst_sample *sample = impl_from_IMediaSample(iface);
+
+    TRACE("sample %p, start %p, stop %p.\n", sample, start, stop);
+
+    sample->media_time_valid = start && stop;
+    if (start && stop)
+    {
+        sample->media_start = *start;
+        sample->media_stop = *stop;
+    }
+    return S_OK;
+}
+
+static const IMediaSampleVtbl gst_sample_vtbl =
+{
+    gst_sample_QueryInterface,
+    gst_sample_AddRef,
+    gst_sample_Release,
+    gst_sample_GetPointer,
+    gst_sample_GetSize,
+    gst_sample_GetTime,
+    gst_sample_SetTime,
+    gst_sample_IsSyncPoint,
+    gst_sample_SetSyncPoint,
+    gst_sample_IsPreroll,
+    gst_sample_SetPreroll,
+    gst_sample_GetActualDataLength,
+    gst_sample_SetActualDataLength,
+    gst_sample_GetMediaType,
+    gst_sample_SetMediaType,
+    gst_sample_IsDiscontinuity,
+    gst_sample_SetDiscontinuity,
+    gst_sample_GetMediaTime,
+    gst_sample_SetMediaTime,
+};
+
+/* Takes a reference to the buffer. */
+static HRESULT create_gst_sample(struct gst_allocator *allocator, GstBuffer *buffer,
+        GstMapFlags flags, IMediaSample **out)
+{
+    struct gst_sample *object;
+
+    if (!(object = heap_alloc_zero(sizeof(*object))))
+        return E_OUTOFMEMORY;
+
+    if (!gst_buffer_map(buffer, &object->map, flags))
+    {
+        ERR("Failed to map buffer %p.\n", buffer);
+        heap_free(object);
+        return E_FAIL;
+    }
+
+    object->IMediaSample_iface.lpVtbl = &gst_sample_vtbl;
+    object->refcount = 1;
+    object->buffer = gst_buffer_ref(buffer);
+    object->length = object->map.size;
+    object->allocator = &allocator->IMemAllocator_iface;
+    IMemAllocator_AddRef(object->allocator);
+
+    TRACE("Created sample %p wrapping buffer %p.\n", object, buffer);
+    *out = &object->IMediaSample_iface;
+    return S_OK;
+}
+
+static HRESULT WINAPI gst_allocator_QueryInterface(IMemAllocator *iface, REFIID iid, void **out)
+{
+    struct gst_allocator *allocator = impl_from_IMemAllocator(iface);
+
+    TRACE("allocator %p, iid %s, out %p.\n", allocator, debugstr_guid(iid), out);
+
+    if (IsEqualGUID(iid, &IID_IUnknown) || IsEqualGUID(iid, &IID_IMemAllocator))
+    {
+        IMemAllocator_AddRef(*out = iface);
+        return S_OK;
+    }
+
+    WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(iid));
+    *out = NULL;
+    return E_NOINTERFACE;
+}
+
+static ULONG WINAPI gst_allocator_AddRef(IMemAllocator *iface)
+{
+    struct gst_allocator *allocator = impl_from_IMemAllocator(iface);
+    ULONG refcount = InterlockedIncrement(&allocator->refcount);
+
+    TRACE("%p increasing refcount to %u.\n", allocator, refcount);
+    return refcount;
+}
+
+static ULONG WINAPI gst_allocator_Release(IMemAllocator *iface)
+{
+    struct gst_allocator *allocator = impl_from_IMemAllocator(iface);
+    ULONG refcount = InterlockedDecrement(&allocator->refcount);
+
+    TRACE("%p decreasing refcount to %u.\n", allocator, refcount);
+
+    if (!refcount)
+        heap_free(allocator);
+    return refcount;
+}
+
+static HRESULT WINAPI gst_allocator_SetProperties(IMemAllocator *iface,
+        ALLOCATOR_PROPERTIES *req_props, ALLOCATOR_PROPERTIES *ret_props)
+{
+    struct gst_allocator *allocator = impl_from_IMemAllocator(iface);
+
+    TRACE("allocator %p, req_props %p, ret_props %p.\n", allocator, req_props, ret_props);
+
+    if (allocator->committed)
+        return VFW_E_ALREADY_COMMITTED;
+
+    /* GStreamer buffers have no room in front of the data. */
+    if (req_props->cbPrefix)
+        return E_INVALIDARG;
+
+    if (!req_props->cbAlign || (req_props->cbAlign & (req_props->cbAlign - 1)))
+        return VFW_E_BADALIGN;
+
+    allocator->props = *req_props;
+    *ret_props = allocator->props;
+    return S_OK;
+}
+
+static HRESULT WINAPI gst_allocator_GetProperties(IMemAllocator *iface, ALLOCATOR_PROPERTIES *props)
+{
+    struct gst_allocator *allocator = impl_from_IMemAllocator(iface);
+
+    TRACE("allocator %p, props %p.\n", allocator, props);
+
+    *props = allocator->props;
+    return S_OK;
+}
+
+static HRESULT WINAPI gst_allocator_Commit(IMemAllocator *iface)
+{
+    struct gst_allocator *allocator = impl_from_IMemAllocator(iface);
+
+    TRACE("allocator %p.\n", allocator);
+
+    if (!allocator->props.cbBuffer)
+        return VFW_E_SIZENOTSET;
+
+    allocator->committed = TRUE;
+    return S_OK;
+}
+
+static HRESULT WINAPI gst_allocator_Decommit(IMemAllocator *iface)
+{
+    struct gst_allocator *allocator = impl_from_IMemAllocator(iface);
+
+    TRACE("allocator %p.\n", allocator);
+
+    /* Outstanding samples keep their buffers alive until they are released. */
+    allocator->committed = FALSE;
+    return S_OK;
+}
+
+static HRESULT WINAPI gst_allocator_GetBuffer(IMemAllocator *iface, IMediaSample **sample,
+        REFERENCE_TIME *start, REFERENCE_TIME *stop, DWORD flags)
+{
+    struct gst_allocator *allocator = impl_from_IMemAllocator(iface);
+    GstAllocationParams params;
+    GstBuffer *buffer;
+    HRESULT hr;
+
+    TRACE("allocator %p, sample %p, start %p, stop %p, flags %#x.\n", allocator, sample, start, stop, flags);
+
+    *sample = NULL;
+
+    if (!allocator->committed)
+        return VFW_E_NOT_COMMITTED;
+
+    mark_wine_thread();
+
+    gst_allocation_params_init(&params);
+    params.align = allocator->props.cbAlign - 1;
+    if (!(buffer = gst_buffer_new_allocate(NULL, allocator->props.cbBuffer, &params)))
+        return E_OUTOFMEMORY;
+
+    hr = create_gst_sample(allocator, buffer, GST_MAP_READWRITE, sample);
+    gst_buffer_unref(buffer);
+    return hr;
+}
+
+static HRESULT WINAPI gst_allocator_ReleaseBuffer(IMemAllocator *iface, IMediaSample *sample)
+{
+    TRACE("allocator %p, sample %p.\n", impl_from_IMemAllocator(iface), sample);
+    return S_OK;
+}
+
+static const IMemAllocatorVtbl gst_allocator_vtbl =
+{
+    gst_allocator_QueryInterface,
+    gst_allocator_AddRef,
+    gst_allocator_Release,
+    gst_allocator_SetProperties,
+    gst_allocator_GetProperties,
+    gst_allocator_Commit,
+    gst_allocator_Decommit,
+    gst_allocator_GetBuffer,
+    gst_allocator_ReleaseBuffer,
+};
+
+static HRESULT create_gst_allocator(IMemAllocator **out)
+{
+    struct gst_allocator *object;
+
+    if (!(object = heap_alloc_zero(sizeof(*object))))
+        return E_OUTOFMEMORY;
+
+    object->IMemAllocator_iface.lpVtbl = &gst_allocator_vtbl;
+    object->refcount = 1;
+
+    TRACE("Created allocator %p.\n", object);
+    *out = &object->IMemAllocator_iface;
+    return S_OK;
+}
+
+/* Wraps the buffer in a sample without copying, unless the data isn't
+ * aligned as requested by the downstream filter. Returns S_FALSE if the
+ * sample doesn't come from our allocator. */
+static HRESULT get_gst_sample(struct gstdemux_source *pin, GstBuffer *buf, IMediaSample **sample)
+{
+    struct gst_allocator *allocator;
+    GstMapInfo info;
+    HRESULT hr;
+
+    if (!pin->pin.pAllocator || pin->pin.pAllocator->lpVtbl != &gst_allocator_vtbl)
+        return S_FALSE;
+    allocator = impl_from_IMemAllocator(pin->pin.pAllocator);
+
+    if (!allocator->committed)
+        return VFW_E_NOT_COMMITTED;
+
+    if (FAILED(hr = create_gst_sample(allocator, buf, GST_MAP_READ, sample)))
+        return hr;
+
+    if (!((UINT_PTR)impl_from_IMediaSample(*sample)->map.data & (allocator->props.cbAlign - 1)))
+    {
+        TRACE("Delivering %u bytes without copying.\n", (unsigned int)gst_buffer_get_size(buf));
+        return S_OK;
+    }
+
+    IMediaSample_Release(*sample);
+    *sample = NULL;
+
+    TRACE("Buffer %p is misaligned, copying.\n", buf);
+    if (FAILED(hr = IMemAllocator_GetBuffer(&allocator->IMemAllocator_iface, sample, NULL, NULL, 0)))
+        return hr;
+
+    gst_buffer_map(buf, &info, GST_MAP_READ);
+    if (SUCCEEDED(hr = IMediaSample_SetActualDataLength(*sample, info.size)))
+        memcpy(impl_from_IMediaSample(*sample)->map.data, info.data, info.size);
+    gst_buffer_unmap(buf, &info);
+
+    if (FAILED(hr))
+    {
+        IMediaSample_Release(*sample);
+        *sample = NULL;
+    }
+    return hr;
+}
+
 static GstFlowReturn got_data_sink(GstPad *pad, GstObject *parent, GstBuffer *buf)
 {
     struct gstdemux_source *pin = gst_pad_get_element_private(pad);
@@ -808,6 +1345,7 @@ static GstFlowReturn got_data_sink(GstPad *pad, GstObject *parent, GstBuffer *bu
     HRESULT hr;
     BYTE *ptr = NULL;
     IMediaSample *sample;
+    BOOL copy = FALSE;
     GstMapInfo info;
 
     TRACE("%p %p\n", pad, buf);
@@ -817,7 +1355,25 @@ static GstFlowReturn got_data_sink(GstPad *pad, GstObject *parent, GstBuffer *bu
         return GST_FLOW_OK;
     }
 
-    hr = BaseOutputPinImpl_GetDeliveryBuffer(&pin->pin, &sample, NULL, NULL, 0);
+    if (TRACE_ON(gstreamer))
+    {
+        DWORD time = GetTickCount();
+
+        ++pin->stats_buffers;
+        if (time - pin->stats_time >= 1000)
+        {
+            if (pin->stats_time)
+                TRACE("Pin %p: %u buffers in %u ms.\n", pin, pin->stats_buffers, time - pin->stats_time);
+            pin->stats_time = time;
+            pin->stats_buffers = 0;
+        }
+    }
+
+    if ((hr = get_gst_sample(pin, buf, &sample)) == S_FALSE)
+    {
+        hr = BaseOutputPinImpl_GetDeliveryBuffer(&pin->pin, &sample, NULL, NULL, 0);
+        copy = TRUE;
+    }
 
     if (hr == VFW_E_NOT_CONNECTED) {
         gst_buffer_unref(buf);
@@ -830,19 +1386,22 @@ static GstFlowReturn got_data_sink(GstPad *pad, GstObject *parent, GstBuffer *bu
         return GST_FLOW_FLUSHING;
     }
 
-    gst_buffer_map(buf, &info, GST_MAP_READ);
+    if (copy)
+    {
+        gst_buffer_map(buf, &info, GST_MAP_READ);
 
-    hr = IMediaSample_SetActualDataLength(sample, info.size);
-    if(FAILED(hr)){
-        WARN("SetActualDataLength failed: %08x\n", hr);
-        return GST_FLOW_FLUSHING;
-    }
+        hr = IMediaSample_SetActualDataLength(sample, info.size);
+        if(FAILED(hr)){
+            WARN("SetActualDataLength failed: %08x\n", hr);
+            return GST_FLOW_FLUSHING;
+        }
 
-    IMediaSample_GetPointer(sample, &ptr);
+        IMediaSample_GetPointer(sample, &ptr);
 
-    memcpy(ptr, info.data, info.size);
+        memcpy(ptr, info.data, info.size);
 
-    gst_buffer_unmap(buf, &info);
+        gst_buffer_unmap(buf, &info);
+    }
 
     if (GST_BUFFER_PTS_IS_VALID(buf)) {
         REFERENCE_TIME rtStart = gst_segment_to_running_time(pin->segment, GST_FORMAT_TIME, buf->pts);
@@ -2081,6 +2640,31 @@ static HRESULT WINAPI GSTOutPin_DecideBufferSize(struct strmbase_source *iface,
     return IMemAllocator_SetProperties(allocator, props, &ret_props);
 }
 
+static HRESULT WINAPI GSTOutPin_DecideAllocator(struct strmbase_source *iface,
+        IMemInputPin *peer, IMemAllocator **allocator)
+{
+    ALLOCATOR_PROPERTIES props;
+    HRESULT hr;
+
+    memset(&props, 0, sizeof(props));
+    IMemInputPin_GetAllocatorRequirements(peer, &props);
+
+    /* Offer our own read-only allocator first, so that decoded buffers can be
+     * delivered without copying them. */
+    if (!props.cbPrefix && SUCCEEDED(create_gst_allocator(allocator)))
+    {
+        if (SUCCEEDED(hr = GSTOutPin_DecideBufferSize(iface, *allocator, &props))
+                && SUCCEEDED(hr = IMemInputPin_NotifyAllocator(peer, *allocator, TRUE)))
+            return S_OK;
+
+        TRACE("Downstream pin rejected our allocator, hr %#x.\n", hr);
+        IMemAllocator_Release(*allocator);
+        *allocator = NULL;
+    }
+
+    return BaseOutputPinImpl_DecideAllocator(iface, peer, allocator);
+}
+
 static void free_source_pin(struct gstdemux_source *pin)
 {
     if (pin->pin.pin.peer)
@@ -2120,7 +2704,7 @@ static const struct strmbase_source_ops source_ops =
     .base.pin_query_accept = source_query_accept,
     .base.pin_get_media_type = source_get_media_type,
     .pfnAttemptConnection = BaseOutputPinImpl_AttemptConnection,
-    .pfnDecideAllocator = BaseOutputPinImpl_DecideAllocator,
+    .pfnDecideAllocator = GSTOutPin_DecideAllocator,
     .pfnDecideBufferSize = GSTOutPin_DecideBufferSize,
 };
 
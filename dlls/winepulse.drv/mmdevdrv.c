@@ -71,6 +71,8 @@ enum DriverPriority {
 
 static const REFERENCE_TIME MinimumPeriod = 30000;
 static const REFERENCE_TIME DefaultPeriod = 100000;
+static const REFERENCE_TIME LowLatencyMinimumPeriod = 10000;
+static const REFERENCE_TIME LowLatencyDefaultPeriod = 20000;
 
 static pa_context *pulse_ctx;
 static pa_mainloop *pulse_ml;
@@ -96,9 +98,16 @@ static struct list g_phys_sources = LIST_INIT(g_phys_sources);
 static WAVEFORMATEXTENSIBLE pulse_fmt[2];
 static REFERENCE_TIME pulse_min_period[2], pulse_def_period[2];
 
+/* Render streams use short periods and are fed from PulseAudio write requests */
+static BOOL pulse_low_latency;
+
+static const WCHAR drv_keyW[] = {'S','o','f','t','w','a','r','e','\\',
+    'W','i','n','e','\\','D','r','i','v','e','r','s','\\',
+    'w','i','n','e','p','u','l','s','e','.','d','r','v',0};
 static const WCHAR drv_key_devicesW[] = {'S','o','f','t','w','a','r','e','\\',
     'W','i','n','e','\\','D','r','i','v','e','r','s','\\',
     'w','i','n','e','p','u','l','s','e','.','d','r','v','\\','d','e','v','i','c','e','s',0};
+static const WCHAR low_latencyW[] = {'L','o','w','L','a','t','e','n','c','y',0};
 static const WCHAR guidW[] = {'g','u','i','d',0};
 
 static GUID pulse_render_guid =
@@ -214,6 +223,7 @@ struct ACImpl {
     pa_buffer_attr attr;
 
     INT64 clock_lastpos, clock_written;
+    UINT32 underflows, starved_writes;
 
     AudioSession *session;
     AudioSessionWrapper *session_wrapper;
@@ -542,11 +552,16 @@ static void pulse_probe_settings(pa_mainloop *ml, pa_context *ctx, int render, W
     if (length)
         pulse_def_period[!render] = pulse_min_period[!render] = pa_bytes_to_usec(10 * length, &ss);
 
-    if (pulse_min_period[!render] < MinimumPeriod)
-        pulse_min_period[!render] = MinimumPeriod;
+    if (pulse_low_latency) {
+        pulse_min_period[!render] = LowLatencyMinimumPeriod;
+        pulse_def_period[!render] = LowLatencyDefaultPeriod;
+    } else {
+        if (pulse_min_period[!render] < MinimumPeriod)
+            pulse_min_period[!render] = MinimumPeriod;
 
-    if (pulse_def_period[!render] < DefaultPeriod)
-        pulse_def_period[!render] = DefaultPeriod;
+        if (pulse_def_period[!render] < DefaultPeriod)
+            pulse_def_period[!render] = DefaultPeriod;
+    }
 
     wfx->wFormatTag = WAVE_FORMAT_EXTENSIBLE;
     wfx->cbSize = sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX);
@@ -901,6 +916,20 @@ static void pulse_phys_sources_cb(pa_context *c, const pa_source_info *i, int eo
     }
 }
 
+static BOOL get_low_latency_setting(void)
+{
+    DWORD value = 0, size = sizeof(value), type;
+    HKEY key;
+
+    if (RegOpenKeyExW(HKEY_CURRENT_USER, drv_keyW, 0, KEY_READ, &key) != ERROR_SUCCESS)
+        return FALSE;
+    if (RegQueryValueExW(key, low_latencyW, 0, &type, (BYTE *)&value, &size) != ERROR_SUCCESS ||
+            type != REG_DWORD)
+        value = 0;
+    RegCloseKey(key);
+    return value != 0;
+}
+
 /* some poorly-behaved applications call audio functions during DllMain, so we
  * have to do as much as possible without creating a new thread. this function
  * sets up a synchronous connection to verify the server is running and query
@@ -964,6 +993,9 @@ static HRESULT pulse_test_connect(void)
         pa_context_get_server(ctx),
         pa_context_get_server_protocol_version(ctx));
 
+    if ((pulse_low_latency = get_low_latency_setting()))
+        TRACE("Using low latency mode.\n");
+
     pulse_probe_settings(ml, ctx, 1, &pulse_fmt[0]);
     pulse_probe_settings(ml, ctx, 0, &pulse_fmt[1]);
 
@@ -1009,18 +1041,22 @@ static void silence_buffer(pa_sample_format_t format, BYTE *buffer, UINT32 bytes
     memset(buffer, format == PA_SAMPLE_U8 ? 0x80 : 0, bytes);
 }
 
-static int write_buffer(const ACImpl *This, BYTE *buffer, UINT32 bytes)
+static inline BOOL pulse_event_driven(const ACImpl *This)
+{
+    return pulse_low_latency && This->dataflow == eRender;
+}
+
+static void adjust_buffer_volume(const ACImpl *This, BYTE *buffer, UINT32 bytes)
 {
     float vol[PA_CHANNELS_MAX];
     BOOL adjust = FALSE;
     UINT32 i, channels;
     BYTE *end;
 
-    if (!bytes) return 0;
     if (This->session->mute)
     {
         silence_buffer(This->ss.format, buffer, bytes);
-        goto write;
+        return;
     }
 
     /* Adjust the buffer based on the volume for each channel */
@@ -1030,7 +1066,7 @@ static int write_buffer(const ACImpl *This, BYTE *buffer, UINT32 bytes)
         vol[i] = This->vol[i] * This->session->master_vol * This->session->channel_vols[i];
         adjust |= vol[i] != 1.0f;
     }
-    if (!adjust) goto write;
+    if (!adjust) return;
 
     end = buffer + bytes;
     switch (This->ss.format)
@@ -1142,8 +1178,12 @@ static int write_buffer(const ACImpl *This, BYTE *buffer, UINT32 bytes)
         TRACE("Unhandled format %i, not adjusting volume.\n", This->ss.format);
         break;
     }
+}
 
-write:
+static int write_buffer(const ACImpl *This, BYTE *buffer, UINT32 bytes)
+{
+    if (!bytes) return 0;
+    adjust_buffer_volume(This, buffer, bytes);
     return pa_stream_write(This->stream, buffer, bytes, NULL, 0, PA_SEEK_RELATIVE);
 }
 
@@ -1211,11 +1251,87 @@ static void pulse_write(ACImpl *This)
     This->pa_held_bytes -= to_write;
 }
 
+/* In low latency mode data handed to PulseAudio stays in held_bytes until the
+ * server's timing information says it has been played. */
+static void pulse_update_played(ACImpl *This)
+{
+    size_t frame_size = pa_frame_size(&This->ss);
+    UINT32 queued, held;
+    pa_usec_t usec;
+    int negative;
+
+    if (pa_stream_get_latency(This->stream, &usec, &negative) < 0)
+        return;
+
+    queued = negative ? 0 : pa_usec_to_bytes(usec, &This->ss);
+    queued -= queued % frame_size;
+    held = min(This->held_bytes, This->pa_held_bytes + queued);
+    This->lcl_offs_bytes = (This->lcl_offs_bytes + This->held_bytes - held) % This->real_bufsize_bytes;
+    This->held_bytes = held;
+}
+
+/* In low latency mode the data released by the application is copied straight
+ * into memory provided by PulseAudio. */
+static void pulse_write_direct(ACImpl *This, size_t bytes)
+{
+    size_t frame_size = pa_frame_size(&This->ss), chunk;
+    void *dst;
+
+    if (bytes == (size_t)-1)
+        return;
+    bytes = min(bytes, This->pa_held_bytes);
+    This->just_underran = FALSE;
+
+    while (bytes) {
+        chunk = min(bytes, This->real_bufsize_bytes - This->pa_offs_bytes);
+        if (pa_stream_begin_write(This->stream, &dst, &chunk) < 0 || !dst) {
+            WARN("pa_stream_begin_write failed: %i\n", pa_context_errno(pulse_ctx));
+            break;
+        }
+        chunk -= chunk % frame_size;
+        if (!chunk) {
+            pa_stream_cancel_write(This->stream);
+            break;
+        }
+
+        memcpy(dst, This->local_buffer + This->pa_offs_bytes, chunk);
+        adjust_buffer_volume(This, dst, chunk);
+        if (pa_stream_write(This->stream, dst, chunk, NULL, 0, PA_SEEK_RELATIVE) < 0) {
+            WARN("pa_stream_write failed: %i\n", pa_context_errno(pulse_ctx));
+            break;
+        }
+
+        This->pa_offs_bytes = (This->pa_offs_bytes + chunk) % This->real_bufsize_bytes;
+        This->pa_held_bytes -= chunk;
+        bytes -= chunk;
+    }
+
+    pulse_update_played(This);
+}
+
+static void pulse_write_callback(pa_stream *s, size_t nbytes, void *userdata)
+{
+    ACImpl *This = userdata;
+
+    TRACE("%p: %zu bytes requested, held: %u\n", This, nbytes, This->pa_held_bytes);
+
+    if (This->started && This->pa_held_bytes < nbytes)
+        This->starved_writes++;
+
+    pulse_write_direct(This, nbytes);
+
+    if (This->started && This->event)
+        SetEvent(This->event);
+}
+
 static void pulse_underflow_callback(pa_stream *s, void *userdata)
 {
     ACImpl *This = userdata;
     WARN("%p: Underflow\n", userdata);
+    This->underflows++;
     This->just_underran = TRUE;
+    if (pulse_event_driven(This))
+        pulse_update_played(This);
     /* re-sync */
     This->pa_offs_bytes = This->lcl_offs_bytes;
     This->pa_held_bytes = This->held_bytes;
@@ -1413,7 +1529,7 @@ static HRESULT pulse_stream_connect(ACImpl *This, UINT32 period_bytes) {
     char buffer[64];
     static LONG number;
     pa_buffer_attr attr;
-    int moving = 0;
+    int moving = 0, timing = 0;
 
     if (This->stream) {
         pa_stream_disconnect(This->stream);
@@ -1446,9 +1562,13 @@ static HRESULT pulse_stream_connect(ACImpl *This, UINT32 period_bytes) {
         moving = PA_STREAM_DONT_MOVE;
     }
 
+    /* Keep timing information current, GetStreamLatency reports the measured latency */
+    if (pulse_event_driven(This))
+        timing = PA_STREAM_AUTO_TIMING_UPDATE | PA_STREAM_INTERPOLATE_TIMING;
+
     if (This->dataflow == eRender)
         ret = pa_stream_connect_playback(This->stream, NULL, &attr,
-        PA_STREAM_START_CORKED|PA_STREAM_VARIABLE_RATE|PA_STREAM_START_UNMUTED|PA_STREAM_ADJUST_LATENCY|moving, NULL, NULL);
+        PA_STREAM_START_CORKED|PA_STREAM_VARIABLE_RATE|PA_STREAM_START_UNMUTED|PA_STREAM_ADJUST_LATENCY|moving|timing, NULL, NULL);
     else
         ret = pa_stream_connect_record(This->stream, NULL, &attr,
         PA_STREAM_START_CORKED|PA_STREAM_VARIABLE_RATE|PA_STREAM_START_UNMUTED|PA_STREAM_ADJUST_LATENCY|moving);
@@ -1464,6 +1584,8 @@ static HRESULT pulse_stream_connect(ACImpl *This, UINT32 period_bytes) {
     if (This->dataflow == eRender) {
         pa_stream_set_underflow_callback(This->stream, pulse_underflow_callback, This);
         pa_stream_set_started_callback(This->stream, pulse_started_callback, This);
+        if (pulse_event_driven(This))
+            pa_stream_set_write_callback(This->stream, pulse_write_callback, This);
     }
     return S_OK;
 }
@@ -2128,6 +2250,18 @@ static HRESULT WINAPI AudioClient_GetStreamLatency(IAudioClient *iface,
         pthread_mutex_unlock(&pulse_lock);
         return hr;
     }
+    if (pulse_event_driven(This)) {
+        pa_usec_t usec;
+        int negative;
+
+        if (!pa_stream_get_latency(This->stream, &usec, &negative) && !negative) {
+            *latency = (usec + This->mmdev_period_usec) * 10;
+            pthread_mutex_unlock(&pulse_lock);
+            TRACE("Measured latency: %u us, %u underflows, %u starved writes\n", (DWORD)usec,
+                    This->underflows, This->starved_writes);
+            return S_OK;
+        }
+    }
     attr = pa_stream_get_buffer_attr(This->stream);
     if (This->dataflow == eRender){
         lat = attr->minreq / pa_frame_size(&This->ss);
@@ -2144,6 +2278,8 @@ static HRESULT WINAPI AudioClient_GetStreamLatency(IAudioClient *iface,
 
 static void ACImpl_GetRenderPad(ACImpl *This, UINT32 *out)
 {
+    if (pulse_event_driven(This))
+        pulse_update_played(This);
     *out = This->held_bytes / pa_frame_size(&This->ss);
 }
 
@@ -2402,7 +2538,10 @@ static HRESULT WINAPI AudioClient_Start(IAudioClient *iface)
         return AUDCLNT_E_NOT_STOPPED;
     }
 
-    pulse_write(This);
+    if (pulse_event_driven(This))
+        pulse_write_direct(This, pa_stream_writable_size(This->stream));
+    else
+        pulse_write(This);
 
     if (pa_stream_is_corked(This->stream)) {
         o = pa_stream_cork(This->stream, 0, pulse_op_cb, &success);
@@ -2420,7 +2559,7 @@ static HRESULT WINAPI AudioClient_Start(IAudioClient *iface)
         This->started = TRUE;
         This->just_started = TRUE;
 
-        if(!This->timer)
+        if(!This->timer && !pulse_event_driven(This))
             This->timer = CreateThread(NULL, 0, pulse_timer_cb, This, 0, NULL);
     }
     pthread_mutex_unlock(&pulse_lock);
@@ -2462,6 +2601,8 @@ static HRESULT WINAPI AudioClient_Stop(IAudioClient *iface)
     if (SUCCEEDED(hr)) {
         This->started = FALSE;
     }
+    if (pulse_event_driven(This))
+        TRACE("%p: %u underflows, %u starved writes\n", This, This->underflows, This->starved_writes);
     pthread_mutex_unlock(&pulse_lock);
     return hr;
 }
@@ -2775,6 +2916,9 @@ static HRESULT WINAPI AudioRenderClient_ReleaseBuffer(
     This->clock_written += written_bytes;
     This->locked = 0;
 
+    if (pulse_event_driven(This))
+        pulse_write_direct(This, pa_stream_writable_size(This->stream));
+
     TRACE("Released %u, held %zu\n", written_frames, This->held_bytes / pa_frame_size(&This->ss));
 
     pthread_mutex_unlock(&pulse_lock);
@@ -3011,6 +3155,8 @@ static HRESULT WINAPI AudioClock_GetPosition(IAudioClock *iface, UINT64 *pos,
         return hr;
     }
 
+    if (pulse_event_driven(This))
+        pulse_update_played(This);
     *pos = This->clock_written - This->held_bytes;
 
     if (This->share == AUDCLNT_SHAREMODE_EXCLUSIVE)
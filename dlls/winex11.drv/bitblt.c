@@ -1558,13 +1558,42 @@ DWORD get_pixmap_image( Pixmap pixmap, int width, int height, const XVisualInfo
 }
 
 
+#define MAX_DAMAGE_RECTS 16
+#define FLUSH_PERIOD     50  /* time in ms since painting started for forcing a flush */
+
+#ifdef HAVE_LIBXXSHM
+#define SHM_BUFFERS      2
+
+/* a shared memory image that the X server may still be reading from */
+struct shm_buffer
+{
+    XImage               *image;
+    XShmSegmentInfo       shminfo;
+    unsigned long         serial;      /* last request reading from the segment */
+    BOOL                  busy;        /* serial hasn't been processed yet */
+    RECT                  dirty[MAX_DAMAGE_RECTS];  /* areas where the image is behind the surface bits */
+    UINT                  dirty_count;
+};
+
+static int shm_completion_event = -1;
+#endif
+
 struct x11drv_window_surface
 {
     struct window_surface header;
     Window                window;
     GC                    gc;
     XImage               *image;
-    RECT                  bounds;
+    RECT                  bounds;        /* painted during the current lock */
+    RECT                  damage[MAX_DAMAGE_RECTS];  /* areas painted since the last flush */
+    UINT                  damage_count;
+    DWORD                 damage_ticks;
+    UINT                  lock_count;
+    BOOL                  flushing;      /* a flush is uploading outside of the lock */
+    BOOL                  flush_pending; /* another flush was requested meanwhile */
+    ULONGLONG             put_bytes;     /* bytes sent to the X server since put_ticks */
+    ULONGLONG             copy_bytes;    /* bytes converted into a separate image buffer */
+    DWORD                 put_ticks;
     BOOL                  byteswap;
     BOOL                  is_argb;
     DWORD                 alpha_bits;
@@ -1572,7 +1601,8 @@ struct x11drv_window_surface
     HRGN                  region;
     void                 *bits;
 #ifdef HAVE_LIBXXSHM
-    XShmSegmentInfo       shminfo;
+    struct shm_buffer     shm[SHM_BUFFERS];
+    UINT                  shm_count;
 #endif
     CRITICAL_SECTION      crit;
     BITMAPINFO            info;   /* variable size, must be last */
@@ -1859,6 +1889,60 @@ failed:
 }
 #endif /* HAVE_LIBXXSHM */
 
+/***********************************************************************
+ *           add_damage_rect
+ *
+ * Add an area to a damage list, merging it with the areas it overlaps.
+ * Once the list is full the rect is merged with the entry that grows the least.
+ */
+static void add_damage_rect( RECT *list, UINT *count, const RECT *rect )
+{
+    RECT rc = *rect, tmp;
+    UINT i, best = 0;
+    LONGLONG area, best_area = -1;
+
+    if (IsRectEmpty( &rc )) return;
+
+    for (i = 0; i < *count; i++)
+    {
+        if (!IntersectRect( &tmp, &rc, &list[i] )) continue;
+        UnionRect( &rc, &rc, &list[i] );
+        list[i--] = list[--*count];
+    }
+
+    if (*count < MAX_DAMAGE_RECTS)
+    {
+        list[(*count)++] = rc;
+        return;
+    }
+
+    for (i = 0; i < *count; i++)
+    {
+        UnionRect( &tmp, &rc, &list[i] );
+        area = (LONGLONG)(tmp.right - tmp.left) * (tmp.bottom - tmp.top) -
+               (LONGLONG)(list[i].right - list[i].left) * (list[i].bottom - list[i].top);
+        if (best_area == -1 || area < best_area)
+        {
+            best_area = area;
+            best = i;
+        }
+    }
+    UnionRect( &list[best], &list[best], &rc );
+}
+
+/***********************************************************************
+ *           collect_bounds
+ *
+ * Move the bounds accumulated by the DIB driver to the damage list.
+ */
+static void collect_bounds( struct x11drv_window_surface *surface )
+{
+    if (IsRectEmpty( &surface->bounds )) return;
+    if (!surface->damage_count) surface->damage_ticks = GetTickCount();
+    add_damage_rect( surface->damage, &surface->damage_count, &surface->bounds );
+    reset_bounds( &surface->bounds );
+}
+
 /***********************************************************************
  *           x11drv_surface_lock
  */
@@ -1867,6 +1951,7 @@ static void x11drv_surface_lock( struct window_surface *window_surface )
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
 
     EnterCriticalSection( &surface->crit );
+    surface->lock_count++;
 }
 
 /***********************************************************************
@@ -1875,8 +1960,18 @@ static void x11drv_surface_lock( struct window_surface *window_surface )
 static void x11drv_surface_unlock( struct window_surface *window_surface )
 {
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
+    BOOL flush = FALSE;
 
+    /* the bounds are cleared here, so the DIB driver never sees pending
+     * damage and we have to force the periodic flush ourselves */
+    if (!--surface->lock_count)
+    {
+        collect_bounds( surface );
+        flush = surface->damage_count && GetTickCount() - surface->damage_ticks > FLUSH_PERIOD;
+    }
     LeaveCriticalSection( &surface->crit );
+
+    if (flush) window_surface->funcs->flush( window_surface );
 }
 
 /***********************************************************************
@@ -1932,69 +2027,237 @@ static void x11drv_surface_set_region( struct window_surface *window_surface, HR
 }
 
 /***********************************************************************
- *           x11drv_surface_flush
+ *           copy_surface_rect
+ *
+ * Update an image from the surface bits for the given rect.
  */
-static void x11drv_surface_flush( struct window_surface *window_surface )
+static UINT copy_surface_rect( struct x11drv_window_surface *surface, XImage *image,
+                               const RECT *rect, const int *mapping )
 {
-    struct x11drv_window_surface *surface = get_x11_surface( window_surface );
     unsigned char *src = surface->bits;
-    unsigned char *dst = (unsigned char *)surface->image->data;
-    struct bitblt_coords coords;
+    unsigned char *dst = (unsigned char *)image->data;
+    int width_bytes = image->bytes_per_line;
+    int bpp = image->bits_per_pixel;
+    int x, y;
 
-    window_surface->funcs->lock( window_surface );
-    coords.x = 0;
-    coords.y = 0;
-    coords.width  = surface->header.rect.right - surface->header.rect.left;
-    coords.height = surface->header.rect.bottom - surface->header.rect.top;
-    SetRect( &coords.visrect, 0, 0, coords.width, coords.height );
-    if (IntersectRect( &coords.visrect, &coords.visrect, &surface->bounds ))
-    {
-        TRACE( "flushing %p %dx%d bounds %s bits %p\n",
-               surface, coords.width, coords.height,
-               wine_dbgstr_rect( &surface->bounds ), surface->bits );
+    src += rect->top * width_bytes;
+    dst += rect->top * width_bytes;
 
-        if (surface->is_argb || surface->color_key != CLR_INVALID) update_surface_region( surface );
+    if (src != dst && (surface->byteswap || mapping || bpp < 8))
+    {
+        /* the conversion copies whole lines */
+        copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
+                             rect->bottom - rect->top, surface->byteswap, mapping, ~0u, surface->alpha_bits );
+        return (rect->bottom - rect->top) * width_bytes;
+    }
+    if (src != dst)
+    {
+        int offset = rect->left * bpp / 8, len = (rect->right - rect->left) * bpp / 8;
 
-        if (src != dst)
+        for (y = rect->top; y < rect->bottom; y++, src += width_bytes, dst += width_bytes)
         {
-            int map[256], *mapping = get_window_surface_mapping( surface->image->bits_per_pixel, map );
-            int width_bytes = surface->image->bytes_per_line;
-
-            src += coords.visrect.top * width_bytes;
-            dst += coords.visrect.top * width_bytes;
-            copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
-                                 coords.visrect.bottom - coords.visrect.top,
-                                 surface->byteswap, mapping, ~0u, surface->alpha_bits );
+            memcpy( dst + offset, src + offset, len );
+            if (surface->alpha_bits)
+                for (x = rect->left; x < rect->right; x++) ((ULONG *)dst)[x] |= surface->alpha_bits;
         }
-        else if (surface->alpha_bits)
-        {
-            int x, y, stride = surface->image->bytes_per_line / sizeof(ULONG);
-            ULONG *ptr = (ULONG *)dst + coords.visrect.top * stride;
+        return (rect->bottom - rect->top) * len;
+    }
+    if (surface->alpha_bits)
+    {
+        for (y = rect->top; y < rect->bottom; y++, dst += width_bytes)
+            for (x = rect->left; x < rect->right; x++) ((ULONG *)dst)[x] |= surface->alpha_bits;
+    }
+    return 0;
+}
 
-            for (y = coords.visrect.top; y < coords.visrect.bottom; y++, ptr += stride)
-                for (x = coords.visrect.left; x < coords.visrect.right; x++)
-                    ptr[x] |= surface->alpha_bits;
-        }
+/***********************************************************************
+ *           put_surface_rects
+ */
+static void put_surface_rects( struct x11drv_window_surface *surface, XImage *image,
+                               const RECT *rects, UINT count, BOOL shm )
+{
+    UINT i;
 
+    for (i = 0; i < count; i++)
+    {
 #ifdef HAVE_LIBXXSHM
-        if (surface->shminfo.shmid != -1)
-            XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                          coords.visrect.left, coords.visrect.top,
-                          surface->header.rect.left + coords.visrect.left,
-                          surface->header.rect.top + coords.visrect.top,
-                          coords.visrect.right - coords.visrect.left,
-                          coords.visrect.bottom - coords.visrect.top, False );
+        /* only ask for a completion event once, the serial covers the other requests */
+        if (shm)
+            XShmPutImage( gdi_display, surface->window, surface->gc, image,
+                          rects[i].left, rects[i].top,
+                          surface->header.rect.left + rects[i].left,
+                          surface->header.rect.top + rects[i].top,
+                          rects[i].right - rects[i].left, rects[i].bottom - rects[i].top,
+                          i == count - 1 );
         else
 #endif
-        XPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                   coords.visrect.left, coords.visrect.top,
-                   surface->header.rect.left + coords.visrect.left,
-                   surface->header.rect.top + coords.visrect.top,
-                   coords.visrect.right - coords.visrect.left,
-                   coords.visrect.bottom - coords.visrect.top );
-        XFlush( gdi_display );
+        XPutImage( gdi_display, surface->window, surface->gc, image,
+                   rects[i].left, rects[i].top,
+                   surface->header.rect.left + rects[i].left,
+                   surface->header.rect.top + rects[i].top,
+                   rects[i].right - rects[i].left, rects[i].bottom - rects[i].top );
+        surface->put_bytes += (ULONGLONG)(rects[i].bottom - rects[i].top) *
+                              ((rects[i].right - rects[i].left) * image->bits_per_pixel / 8);
+    }
+    XFlush( gdi_display );
+}
+
+#ifdef HAVE_LIBXXSHM
+/***********************************************************************
+ *           get_free_shm_buffer
+ *
+ * Find a shared memory image that the X server is done with. The
+ * completion events are only used to get the processed request serial
+ * updated; a put to a destroyed window returns an error instead of an
+ * event, so the serial is what we rely on.
+ */
+static struct shm_buffer *get_free_shm_buffer( struct x11drv_window_surface *surface )
+{
+    XEvent event;
+    UINT i;
+
+    while (XCheckTypedEvent( gdi_display, shm_completion_event, &event )) /* nothing */;
+
+    for (i = 0; i < surface->shm_count; i++)
+    {
+        struct shm_buffer *buffer = &surface->shm[i];
+
+        if (buffer->busy)
+            buffer->busy = (long)(buffer->serial - LastKnownRequestProcessed( gdi_display )) > 0;
+        if (!buffer->busy) return buffer;
+    }
+    return NULL;
+}
+
+/***********************************************************************
+ *           flush_shm_buffer
+ *
+ * Upload the damaged rects through one of the shared memory images.
+ * Called with the surface locked; the lock is dropped while waiting and uploading.
+ */
+static void flush_shm_buffer( struct x11drv_window_surface *surface, RECT *rects, UINT count,
+                              const int *mapping )
+{
+    struct shm_buffer *buffer;
+    UINT i, j;
+
+    if (!(buffer = get_free_shm_buffer( surface )))
+    {
+        /* the server is more than a frame behind, wait for it without blocking painting */
+        TRACE( "%p waiting for the X server\n", surface );
+        surface->header.funcs->unlock( &surface->header );
+        XSync( gdi_display, False );
+        surface->header.funcs->lock( &surface->header );
+        for (i = 0; i < surface->shm_count; i++) surface->shm[i].busy = FALSE;
+        buffer = &surface->shm[0];
+    }
+
+    /* the other images fall behind by the new damage */
+    for (i = 0; i < surface->shm_count; i++)
+        for (j = 0; j < count; j++)
+            add_damage_rect( surface->shm[i].dirty, &surface->shm[i].dirty_count, &rects[j] );
+
+    for (i = 0; i < buffer->dirty_count; i++)
+    {
+        TRACE( "%p copying %s to image %p\n", surface, wine_dbgstr_rect( &buffer->dirty[i] ), buffer->image );
+        surface->copy_bytes += copy_surface_rect( surface, buffer->image, &buffer->dirty[i], mapping );
+    }
+    buffer->dirty_count = 0;
+
+    surface->header.funcs->unlock( &surface->header );
+    put_surface_rects( surface, buffer->image, rects, count, TRUE );
+    buffer->serial = NextRequest( gdi_display ) - 1;
+    buffer->busy = TRUE;
+    surface->header.funcs->lock( &surface->header );
+}
+#endif /* HAVE_LIBXXSHM */
+
+/***********************************************************************
+ *           flush_damage
+ *
+ * Called with the surface locked and the flushing flag set.
+ */
+static void flush_damage( struct x11drv_window_surface *surface )
+{
+    RECT rects[MAX_DAMAGE_RECTS], surface_rect;
+    int map[256], *mapping = NULL;
+    UINT i, count = 0;
+
+    SetRect( &surface_rect, 0, 0, surface->header.rect.right - surface->header.rect.left,
+             surface->header.rect.bottom - surface->header.rect.top );
+    for (i = 0; i < surface->damage_count; i++)
+        if (IntersectRect( &rects[count], &surface->damage[i], &surface_rect )) count++;
+    surface->damage_count = 0;
+    if (!count) return;
+
+    TRACE( "flushing %p %u rects, first %s bits %p\n",
+           surface, count, wine_dbgstr_rect( &rects[0] ), surface->bits );
+
+    if (surface->is_argb || surface->color_key != CLR_INVALID) update_surface_region( surface );
+
+    if (surface->bits == surface->image->data)
+    {
+        /* the image is updated in place, so the upload has to happen under the lock */
+        for (i = 0; i < count; i++) copy_surface_rect( surface, surface->image, &rects[i], NULL );
+        put_surface_rects( surface, surface->image, rects, count, FALSE );
+        return;
+    }
+
+    mapping = get_window_surface_mapping( surface->image->bits_per_pixel, map );
+#ifdef HAVE_LIBXXSHM
+    if (surface->shm_count)
+    {
+        flush_shm_buffer( surface, rects, count, mapping );
+        return;
+    }
+#endif
+    for (i = 0; i < count; i++)
+        surface->copy_bytes += copy_surface_rect( surface, surface->image, &rects[i], mapping );
+    surface->header.funcs->unlock( &surface->header );
+    put_surface_rects( surface, surface->image, rects, count, FALSE );
+    surface->header.funcs->lock( &surface->header );
+}
+
+/***********************************************************************
+ *           x11drv_surface_flush
+ *
+ * Only the damaged rects are uploaded. Unless the image is updated in place,
+ * the upload happens outside of the surface lock, so painting can continue
+ * into the surface bits while the X server gets the previous frame.
+ */
+static void x11drv_surface_flush( struct window_surface *window_surface )
+{
+    struct x11drv_window_surface *surface = get_x11_surface( window_surface );
+    DWORD now;
+
+    window_surface->funcs->lock( window_surface );
+    collect_bounds( surface );
+    if (surface->flushing)
+    {
+        /* the flush in progress will pick up the new damage */
+        surface->flush_pending = TRUE;
+        window_surface->funcs->unlock( window_surface );
+        return;
+    }
+
+    surface->flushing = TRUE;
+    do
+    {
+        surface->flush_pending = FALSE;
+        flush_damage( surface );
+    } while (surface->flush_pending);
+    surface->flushing = FALSE;
+
+    now = GetTickCount();
+    if (now - surface->put_ticks >= 1000)
+    {
+        if (surface->put_bytes)
+            TRACE( "%p put %s bytes/s, copied %s bytes/s\n", surface,
+                   wine_dbgstr_longlong( surface->put_bytes * 1000 / (now - surface->put_ticks) ),
+                   wine_dbgstr_longlong( surface->copy_bytes * 1000 / (now - surface->put_ticks) ));
+        surface->put_bytes = surface->copy_bytes = 0;
+        surface->put_ticks = now;
     }
-    reset_bounds( &surface->bounds );
     window_surface->funcs->unlock( window_surface );
 }
 
@@ -2007,17 +2270,25 @@ static void x11drv_surface_destroy( struct window_surface *window_surface )
 
     TRACE( "freeing %p bits %p\n", surface, surface->bits );
     if (surface->gc) XFreeGC( gdi_display, surface->gc );
-    if (surface->image)
-    {
-        if (surface->image->data != surface->bits) HeapFree( GetProcessHeap(), 0, surface->bits );
+    if (surface->image && surface->image->data != surface->bits) HeapFree( GetProcessHeap(), 0, surface->bits );
 #ifdef HAVE_LIBXXSHM
-        if (surface->shminfo.shmid != -1)
+    if (surface->shm_count)
+    {
+        UINT i;
+
+        /* the server handles the detach after any put still reading from the segments */
+        for (i = 0; i < surface->shm_count; i++)
         {
-            XShmDetach( gdi_display, &surface->shminfo );
-            shmdt( surface->shminfo.shmaddr );
+            XShmDetach( gdi_display, &surface->shm[i].shminfo );
+            shmdt( surface->shm[i].shminfo.shmaddr );
+            surface->shm[i].image->data = NULL;
+            XDestroyImage( surface->shm[i].image );
         }
-        else
+        surface->image = NULL;
+    }
 #endif
+    if (surface->image)
+    {
         HeapFree( GetProcessHeap(), 0, surface->image->data );
         surface->image->data = NULL;
         XDestroyImage( surface->image );
@@ -2071,10 +2342,24 @@ struct window_surface *create_surface( Window window, const XVisualInfo *vis, co
     surface->is_argb = (use_alpha && vis->depth == 32 && surface->info.bmiHeader.biCompression == BI_RGB);
     set_color_key( surface, color_key );
     reset_bounds( &surface->bounds );
+    surface->put_ticks = GetTickCount();
 
 #ifdef HAVE_LIBXXSHM
-    surface->image = create_shm_image( vis, width, height, &surface->shminfo );
-    if (!surface->image)
+    /* double buffer shared memory images so that flushing doesn't wait for the X server */
+    while (surface->shm_count < SHM_BUFFERS)
+    {
+        struct shm_buffer *buffer = &surface->shm[surface->shm_count];
+
+        if (!(buffer->image = create_shm_image( vis, width, height, &buffer->shminfo ))) break;
+        surface->shm_count++;
+    }
+    if (surface->shm_count)
+    {
+        if (shm_completion_event == -1)
+            shm_completion_event = XShmGetEventBase( gdi_display ) + ShmCompletion;
+        surface->image = surface->shm[0].image;
+    }
+    else
 #endif
     {
         surface->image = XCreateImage( gdi_display, vis->visual, vis->depth, ZPixmap, 0, NULL,
@@ -2091,9 +2376,14 @@ struct window_surface *create_surface( Window window, const XVisualInfo *vis, co
     if (vis->depth == 32 && !surface->is_argb)
         surface->alpha_bits = ~(vis->red_mask | vis->green_mask | vis->blue_mask);
 
-    if (surface->byteswap || format->bits_per_pixel == 4 || format->bits_per_pixel == 8)
+    if (surface->byteswap || format->bits_per_pixel == 4 || format->bits_per_pixel == 8
+#ifdef HAVE_LIBXXSHM
+        || surface->shm_count
+#endif
+        )
     {
-        /* allocate separate surface bits if byte swapping or palette mapping is required */
+        /* allocate separate surface bits if byte swapping or palette mapping is required,
+         * or if the shared memory images may be read by the X server while we paint */
         if (!(surface->bits  = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY,
                                           surface->info.bmiHeader.biSizeImage )))
             goto failed;
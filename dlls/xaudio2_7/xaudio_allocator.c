@@ -25,17 +25,141 @@
 
 #include "ole2.h"
 
+#include "wine/debug.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(xaudio2);
+
+/* FAudio allocates and frees from its mixing thread, so going through the
+ * process heap there means contending with every other thread of the game
+ * for the heap lock. Small blocks are carved out of slabs instead and kept
+ * on lock-free per size free lists. The slabs are never given back: the
+ * pools simply grow to the high-water mark of the engine, and a popped entry
+ * always stays readable, which the lock-free pop relies on. */
+
+#define POOL_MIN_SHIFT  5    /* 32 bytes, header included */
+#define POOL_COUNT      13   /* up to 128 KiB */
+#define POOL_SLAB_SIZE  (64 * 1024)
+#define POOL_SLAB_MIN_BLOCKS 4
+
+#define LARGE_BLOCK     (~(size_t)0)
+
+struct block_header
+{
+    size_t pool;    /* index of the pool, or LARGE_BLOCK */
+    size_t size;    /* usable size of the block */
+};
+
+static SLIST_HEADER pools[POOL_COUNT];
+static LONG slab_allocs, large_allocs;
+
+static inline size_t pool_block_size(size_t pool)
+{
+    return (size_t)1 << (pool + POOL_MIN_SHIFT);
+}
+
+static inline size_t get_pool(size_t size)
+{
+    size_t pool = 0;
+
+    size += sizeof(struct block_header);
+    while (pool < POOL_COUNT && pool_block_size(pool) < size)
+        ++pool;
+    return pool;
+}
+
+/* Push a new slab of blocks to the pool. Threads racing here each add a
+ * slab, which is wasteful but harmless. */
+static BOOL grow_pool(size_t pool)
+{
+    size_t block_size = pool_block_size(pool);
+    size_t count = max(POOL_SLAB_SIZE / block_size, POOL_SLAB_MIN_BLOCKS), i;
+    struct block_header *header;
+    BYTE *slab;
+
+    if (!(slab = CoTaskMemAlloc(count * block_size)))
+        return FALSE;
+
+    for (i = 0; i < count; ++i)
+    {
+        header = (struct block_header *)(slab + i * block_size);
+        header->pool = pool;
+        header->size = block_size - sizeof(*header);
+        InterlockedPushEntrySList(&pools[pool], (SLIST_ENTRY *)(header + 1));
+    }
+
+    if (!(InterlockedIncrement(&slab_allocs) % 64))
+        TRACE("%u slabs, %u large blocks allocated so far.\n", slab_allocs, large_allocs);
+    return TRUE;
+}
+
 void* XAudio_Internal_Malloc(size_t size)
 {
-    return CoTaskMemAlloc(size);
+    struct block_header *header;
+    SLIST_ENTRY *entry;
+    size_t pool;
+
+    if ((pool = get_pool(size)) == POOL_COUNT)
+    {
+        if (!(header = CoTaskMemAlloc(sizeof(*header) + size)))
+            return NULL;
+        InterlockedIncrement(&large_allocs);
+        header->pool = LARGE_BLOCK;
+        header->size = size;
+        return header + 1;
+    }
+
+    while (!(entry = InterlockedPopEntrySList(&pools[pool])))
+    {
+        if (!grow_pool(pool))
+            return NULL;
+    }
+    return entry;
 }
 
 void XAudio_Internal_Free(void* ptr)
 {
-    return CoTaskMemFree(ptr);
+    struct block_header *header;
+
+    if (!ptr)
+        return;
+
+    header = (struct block_header *)ptr - 1;
+    if (header->pool == LARGE_BLOCK)
+        CoTaskMemFree(header);
+    else
+        InterlockedPushEntrySList(&pools[header->pool], ptr);
 }
 
 void* XAudio_Internal_Realloc(void* ptr, size_t size)
 {
-    return CoTaskMemRealloc(ptr, size);
+    struct block_header *header;
+    void *ret;
+
+    if (!ptr)
+        return XAudio_Internal_Malloc(size);
+    if (!size)
+    {
+        XAudio_Internal_Free(ptr);
+        return NULL;
+    }
+
+    header = (struct block_header *)ptr - 1;
+    if (size <= header->size && (header->pool == LARGE_BLOCK || header->pool == get_pool(size)))
+        return ptr;
+
+    if (!(ret = XAudio_Internal_Malloc(size)))
+        return NULL;
+    memcpy(ret, ptr, min(size, header->size));
+    XAudio_Internal_Free(ptr);
+    return ret;
+}
+
+/* Makes sure that blocks of the given size can be handed out without going
+ * to the heap, so that a voice's buffers are there before it starts playing. */
+void XAudio_Internal_Reserve(size_t size)
+{
+    size_t pool = get_pool(size);
+
+    if (pool < POOL_COUNT && !QueryDepthSList(&pools[pool]))
+        grow_pool(pool);
 }
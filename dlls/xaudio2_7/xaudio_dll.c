@@ -1599,6 +1599,12 @@ static HRESULT WINAPI IXAudio2Impl_CreateSourceVoice(IXAudio2 *iface,
         LeaveCriticalSection(&This->lock);
         return hr;
     }
+
+    /* Have the pool hold the voice's per-pass buffers before the mixing
+     * thread asks for them, assuming the default 10ms quantum. */
+    XAudio_Internal_Reserve(pSourceFormat->nChannels * sizeof(float) *
+            (size_t)((pSourceFormat->nSamplesPerSec / 100 + 1) * max(maxFrequencyRatio, 1.0f)));
+
     src->in_use = TRUE;
     src->cb = pCallback;
 
@@ -179,3 +179,4 @@ extern HRESULT make_xapo_factory(REFCLSID clsid, REFIID riid, void **ppv) DECLSP
 extern void* XAudio_Internal_Malloc(size_t size) DECLSPEC_HIDDEN;
 extern void XAudio_Internal_Free(void* ptr) DECLSPEC_HIDDEN;
 extern void* XAudio_Internal_Realloc(void* ptr, size_t size) DECLSPEC_HIDDEN;
+extern void XAudio_Internal_Reserve(size_t size) DECLSPEC_HIDDEN;
@@ -36,8 +36,11 @@
 #define NVENCSTATUS int
 #define NV_ENC_SUCCESS 0
 #define NV_ENC_ERR_INVALID_PTR 6
+#define NV_ENC_ERR_OUT_OF_MEMORY 10
 #define NV_ENC_ERR_UNSUPPORTED_PARAM 12
+#define NV_ENC_ERR_LOCK_BUSY 13
 #define NV_ENC_ERR_INVALID_VERSION 15
+#define NV_ENC_ERR_NEED_MORE_INPUT 17
 
 typedef void *NV_ENC_INPUT_PTR;
 typedef void *NV_ENC_OUTPUT_PTR;
@@ -198,6 +201,31 @@ typedef struct _NV_ENC_PIC_PARAMS
     void *reserved4[60];
 } NV_ENC_PIC_PARAMS;
 
+struct _NV_ENC_LOCK_BITSTREAM
+{
+    uint32_t version;
+    uint32_t doNotWait         : 1;
+    uint32_t ltrFrame          : 1;
+    uint32_t reservedBitFields : 30;
+    void *outputBitstream;
+    uint32_t *sliceOffsets;
+    uint32_t frameIdx;
+    uint32_t hwEncodeStatus;
+    uint32_t numSlices;
+    uint32_t bitstreamSizeInBytes;
+    uint64_t outputTimeStamp;
+    uint64_t outputDuration;
+    void *bitstreamBufferPtr;
+    int pictureType;
+    int pictureStruct;
+    uint32_t frameAvgQP;
+    uint32_t frameSatd;
+    uint32_t ltrFrameIdx;
+    uint32_t ltrFrameBitmap;
+    uint32_t reserved[236];
+    void *reserved2[64];
+};
+
 typedef struct __NV_ENCODE_API_FUNCTION_LIST
 {
     uint32_t version;
@@ -907,6 +907,7 @@ enum wined3d_shader_type
 #define WINED3D_SWAPCHAIN_GDI_COMPATIBLE                        0x00008000u
 #define WINED3D_SWAPCHAIN_IMPLICIT                              0x00010000u
 #define WINED3D_SWAPCHAIN_HOOK                                  0x00020000u
+#define WINED3D_SWAPCHAIN_FRAME_LATENCY_WAITABLE                0x00040000u
 
 #define WINED3DDP_MAXTEXCOORD                                   8
 
@@ -1846,6 +1847,13 @@ struct wined3d_raster_status
     UINT scan_line;
 };
 
+struct wined3d_frame_statistics
+{
+    unsigned int present_count;
+    unsigned int sync_refresh_count;
+    LARGE_INTEGER sync_qpc_time;
+};
+
 struct wined3d_map_desc
 {
     UINT row_pitch;
@@ -2763,6 +2771,8 @@ struct wined3d_texture * __cdecl wined3d_swapchain_get_back_buffer(const struct
 struct wined3d_device * __cdecl wined3d_swapchain_get_device(const struct wined3d_swapchain *swapchain);
 HRESULT __cdecl wined3d_swapchain_get_display_mode(const struct wined3d_swapchain *swapchain,
         struct wined3d_display_mode *mode, enum wined3d_display_rotation *rotation);
+HRESULT __cdecl wined3d_swapchain_get_frame_statistics(const struct wined3d_swapchain *swapchain,
+        struct wined3d_frame_statistics *stats);
 HRESULT __cdecl wined3d_swapchain_get_front_buffer_data(const struct wined3d_swapchain *swapchain,
         struct wined3d_texture *dst_texture, unsigned int sub_resource_idx);
 HRESULT __cdecl wined3d_swapchain_get_gamma_ramp(const struct wined3d_swapchain *swapchain,
@@ -2782,6 +2792,7 @@ HRESULT __cdecl wined3d_swapchain_resize_buffers(struct wined3d_swapchain *swapc
 HRESULT __cdecl wined3d_swapchain_set_gamma_ramp(const struct wined3d_swapchain *swapchain,
         DWORD flags, const struct wined3d_gamma_ramp *ramp);
 void __cdecl wined3d_swapchain_set_palette(struct wined3d_swapchain *swapchain, struct wined3d_palette *palette);
+void __cdecl wined3d_swapchain_set_present_semaphore(struct wined3d_swapchain *swapchain, HANDLE semaphore);
 void __cdecl wined3d_swapchain_set_window(struct wined3d_swapchain *swapchain, HWND window);
 
 HRESULT __cdecl wined3d_swapchain_state_create(const struct wined3d_swapchain_desc *desc,